@@ -0,0 +1,152 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// A standalone producer of synthetic body state. It publishes animated hands, eyes and face through the same memory
+// mapped file and event as Virtual Desktop, in order to exercise the runtime's body state transport without a headset
+// capable of body tracking.
+//
+// Usage: BodyStateProducer [rate]
+//
+// The rate is in updates per second (default 90). The producer must be started before the OpenXR application, since
+// the runtime only looks for the memory mapped file when it detects the headset.
+
+#include "pch.h"
+
+#include "BodyState.h"
+#include "synthetic_body_state.h"
+
+namespace {
+
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    std::atomic<bool> g_stop{false};
+
+    BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType) {
+        g_stop = true;
+        return TRUE;
+    }
+
+    // Sleep until the requested time, with better precision than the default timer resolution.
+    void sleepUntil(HANDLE timer, std::chrono::steady_clock::time_point time) {
+        std::chrono::steady_clock::time_point now;
+        while ((now = std::chrono::steady_clock::now()) < time) {
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -std::max(
+                (LONGLONG)std::chrono::duration_cast<std::chrono::nanoseconds>(time - now).count() / 100, 1LL);
+            if (timer && SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, false)) {
+                WaitForSingleObject(timer, INFINITE);
+            } else {
+                std::this_thread::sleep_until(time);
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const double rate = argc > 1 ? std::atof(argv[1]) : 90.0;
+    if (rate <= 0.0) {
+        std::cerr << "Usage: BodyStateProducer [rate]" << std::endl;
+        return 1;
+    }
+
+    wil::unique_handle file(CreateFileMapping(INVALID_HANDLE_VALUE,
+                                              nullptr,
+                                              PAGE_READWRITE,
+                                              0,
+                                              sizeof(BodyTracking::BodyStateV2),
+                                              L"VirtualDesktop.BodyState"));
+    if (!file) {
+        std::cerr << "Failed to create the file mapping: " << GetLastError() << std::endl;
+        return 1;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Do not write over the data from Virtual Desktop.
+        std::cerr << "The body state is already published by another process. Is Virtual Desktop streaming?"
+                  << std::endl;
+        return 1;
+    }
+
+    const auto state = reinterpret_cast<BodyTracking::BodyStateV2*>(
+        MapViewOfFile(file.get(), FILE_MAP_WRITE, 0, 0, sizeof(BodyTracking::BodyStateV2)));
+    if (!state) {
+        std::cerr << "Failed to map the file: " << GetLastError() << std::endl;
+        return 1;
+    }
+    auto unmap = MakeScopeGuard([&] { UnmapViewOfFile(state); });
+
+    wil::unique_handle event(CreateEvent(nullptr, false, false, L"VirtualDesktop.BodyStateEvent2"));
+    if (!event) {
+        std::cerr << "Failed to create the event: " << GetLastError() << std::endl;
+        return 1;
+    }
+
+    const wil::unique_handle timer(
+        CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+    SetConsoleCtrlHandler(ConsoleCtrlHandler, true);
+
+    std::cout << "Publishing body state at " << rate << " Hz, press Ctrl+C to stop" << std::endl;
+
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rate));
+    const auto startTime = std::chrono::steady_clock::now();
+    auto nextUpdateTime = startTime;
+    auto nextReportTime = startTime + 1s;
+    uint64_t updateCount = 0;
+    std::chrono::steady_clock::duration maxLateness{};
+
+    BodyTracking::BodyStateV2 update{};
+    while (!g_stop) {
+        sleepUntil(timer.get(), nextUpdateTime);
+        const auto now = std::chrono::steady_clock::now();
+        maxLateness = std::max(maxLateness, now - nextUpdateTime);
+
+        // Animate a private copy, then publish it in one go to keep the window for tearing as short as possible.
+        SyntheticBodyState::animate(update, std::chrono::duration<double>(nextUpdateTime - startTime).count());
+        *state = update;
+        SetEvent(event.get());
+        updateCount++;
+
+        nextUpdateTime += period;
+        if (nextUpdateTime < now) {
+            // We fell behind, do not try to catch up with a burst of updates.
+            nextUpdateTime = now + period;
+        }
+
+        if (now >= nextReportTime) {
+            std::cout << updateCount << " updates, max lateness "
+                      << std::chrono::duration<double, std::milli>(maxLateness).count() << " ms" << std::endl;
+            maxLateness = {};
+            nextReportTime += 1s;
+        }
+    }
+
+    // Tell the consumers that nothing is tracked anymore.
+    update.FaceIsValid = update.LeftEyeIsValid = update.RightEyeIsValid = 0;
+    update.LeftHandActive = update.RightHandActive = 0;
+    *state = update;
+    SetEvent(event.get());
+
+    return 0;
+}
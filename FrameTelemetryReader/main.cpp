@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Print the per-frame statistics published by the runtime when the "frame_telemetry" setting is enabled, one line per
+// frame.
+//
+// Usage: FrameTelemetryReader [interval]
+//
+// The interval is the polling period in milliseconds (default 100). The reader follows the application across session
+// restarts, and across applications taking over the shared memory.
+
+#include "pch.h"
+
+#include "frame_telemetry.h"
+
+namespace {
+
+    using namespace virtualdesktop_openxr::utils;
+
+    std::atomic<bool> g_stop{false};
+
+    BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType) {
+        g_stop = true;
+        return TRUE;
+    }
+
+    void printColumns() {
+        fmt::print("{:>10} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>6} {:>9} {:>9} {:>9} {:>8} {:>8} {:>4} {:>6}\n",
+                   "Frame",
+                   "Wait>Beg",
+                   "Beg>End",
+                   "End>Disp",
+                   "AppCPU",
+                   "AppGPU",
+                   "RunStart",
+                   "Queue",
+                   "MtP",
+                   "CompCPU",
+                   "CompGPU",
+                   "AppDrop",
+                   "CmpDrop",
+                   "ASW",
+                   "Layers");
+    }
+
+    void printRecord(const FrameTelemetryRecord& record) {
+        fmt::print("{:>10} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>6} "
+                   "{:>9.2f} {:>9.2f} {:>9.2f} {:>8} {:>8} {:>4} {:>6}\n",
+                   record.frameId,
+                   (record.beginFrameTime - record.waitFrameTime) * 1e3,
+                   (record.endFrameTime - record.beginFrameTime) * 1e3,
+                   (record.predictedDisplayTime - record.endFrameTime) * 1e3,
+                   record.appCpuTimeUs / 1e3,
+                   record.appGpuTimeUs / 1e3,
+                   record.runningStartUs / 1e3,
+                   record.framesInFlight,
+                   record.appMotionToPhotonLatency * 1e3,
+                   record.compositorCpuTime * 1e3,
+                   record.compositorGpuTime * 1e3,
+                   record.appDroppedFrameCount,
+                   record.compositorDroppedFrameCount,
+                   record.isAsyncReprojectionActive,
+                   record.layerCount);
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int interval = argc > 1 ? std::atoi(argv[1]) : 100;
+    if (interval <= 0) {
+        std::cerr << "Usage: FrameTelemetryReader [interval]" << std::endl;
+        return 1;
+    }
+
+    FrameTelemetryReader reader;
+    if (!reader.open()) {
+        std::cerr << "No application is publishing frame telemetry. Is the frame_telemetry setting enabled?"
+                  << std::endl;
+        return 1;
+    }
+
+    SetConsoleCtrlHandler(ConsoleCtrlHandler, true);
+
+    uint32_t processId = 0;
+    bool isWaiting = false;
+    uint64_t next = 0;
+    uint64_t printed = 0;
+    while (!g_stop) {
+        const FrameTelemetryHeader& header = reader.getHeader();
+        const uint32_t writerProcessId = reader.isValid() ? header.processId.load(std::memory_order_acquire) : 0;
+        if (!writerProcessId) {
+            if (!isWaiting) {
+                std::cout << "Waiting for an application to publish frame telemetry..." << std::endl;
+                isWaiting = true;
+            }
+            processId = 0;
+            Sleep(interval);
+            continue;
+        }
+
+        if (writerProcessId != processId) {
+            // A new session or a new application: start from its latest frame.
+            char applicationName[sizeof(header.applicationName) + 1]{};
+            memcpy(applicationName, header.applicationName, sizeof(header.applicationName));
+            std::cout << "Application: " << applicationName << " (PID " << writerProcessId << ")" << std::endl;
+            processId = writerProcessId;
+            isWaiting = false;
+            next = reader.getWriteIndex();
+            printed = 0;
+        }
+
+        const uint64_t writeIndex = reader.getWriteIndex();
+        if (writeIndex < next) {
+            // The application restarted its session.
+            next = writeIndex;
+        }
+        if (writeIndex - next > FrameTelemetryCapacity) {
+            std::cerr << "Missed " << (writeIndex - next - FrameTelemetryCapacity) << " frames" << std::endl;
+            next = writeIndex - FrameTelemetryCapacity;
+        }
+
+        while (next < writeIndex) {
+            FrameTelemetryRecord record;
+            const FrameTelemetryReader::Result result = reader.read(next, record);
+            if (result == FrameTelemetryReader::Result::Busy) {
+                // Try again later.
+                break;
+            }
+            if (result == FrameTelemetryReader::Result::Success) {
+                if (printed++ % 40 == 0) {
+                    printColumns();
+                }
+                printRecord(record);
+            }
+            next++;
+        }
+
+        Sleep(interval);
+    }
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "accessibility_remapping.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    TEST_CLASS(AccessibilityRemappingTests) {
+        TEST_METHOD(DisabledByDefault) {
+            AccessibilityRemapping remapping;
+            Assert::IsFalse(remapping.isEnabled());
+
+            ovrInputState state{};
+            state.Buttons = ovrButton_A;
+            state.HandTrigger[xr::Side::Left] = 0.5f;
+            remapping.apply(state);
+            Assert::AreEqual((unsigned int)ovrButton_A, state.Buttons);
+            Assert::AreEqual(0.5f, state.HandTrigger[xr::Side::Left], 0.f);
+        }
+
+        TEST_METHOD(ToggleButtons) {
+            AccessibilityRemappingSettings settings;
+            settings.toggleButtons = ovrButton_A;
+            AccessibilityRemapping remapping;
+            remapping.configure(settings);
+            Assert::IsTrue(remapping.isEnabled());
+
+            // Press and release A: it stays pressed. B is not affected.
+            const auto apply = [&](uint32_t buttons) {
+                ovrInputState state{};
+                state.Buttons = buttons;
+                remapping.apply(state);
+                return state.Buttons;
+            };
+            Assert::AreEqual((unsigned int)(ovrButton_A | ovrButton_B), apply(ovrButton_A | ovrButton_B));
+            Assert::AreEqual((unsigned int)ovrButton_A, apply(ovrButton_A));
+            Assert::AreEqual((unsigned int)ovrButton_A, apply(0));
+            Assert::AreEqual((unsigned int)ovrButton_A, apply(0));
+
+            // Press again: released.
+            Assert::AreEqual(0u, apply(ovrButton_A));
+            Assert::AreEqual(0u, apply(0));
+
+            // Changing the settings resets the toggles.
+            apply(ovrButton_A);
+            settings.toggleButtons = ovrButton_A | ovrButton_X;
+            remapping.configure(settings);
+            Assert::AreEqual(0u, apply(0));
+        }
+
+        TEST_METHOD(ToggleHandTrigger) {
+            AccessibilityRemappingSettings settings;
+            settings.toggleHandTrigger[xr::Side::Right] = true;
+            AccessibilityRemapping remapping;
+            remapping.configure(settings);
+
+            const auto apply = [&](float value) {
+                ovrInputState state{};
+                state.HandTrigger[xr::Side::Right] = state.HandTriggerNoDeadzone[xr::Side::Right] = value;
+                state.HandTrigger[xr::Side::Left] = value;
+                remapping.apply(state);
+                Assert::AreEqual(state.HandTrigger[xr::Side::Right], state.HandTriggerNoDeadzone[xr::Side::Right], 0.f);
+                Assert::AreEqual(value, state.HandTrigger[xr::Side::Left], 0.f);
+                return state.HandTrigger[xr::Side::Right];
+            };
+
+            // A partial squeeze is not a press.
+            Assert::AreEqual(0.f, apply(0.5f), 0.f);
+            Assert::AreEqual(1.f, apply(0.9f), 0.f);
+            // Releasing only partially and squeezing again does not toggle.
+            Assert::AreEqual(1.f, apply(0.4f), 0.f);
+            Assert::AreEqual(1.f, apply(0.9f), 0.f);
+            Assert::AreEqual(1.f, apply(0.f), 0.f);
+            Assert::AreEqual(0.f, apply(1.f), 0.f);
+            Assert::AreEqual(0.f, apply(0.f), 0.f);
+        }
+
+        TEST_METHOD(Chords) {
+            AccessibilityRemappingSettings settings;
+            settings.chords[0] = {ovrButton_A, ovrButton_B | ovrButton_RThumb};
+            settings.chords[1] = {ovrButton_X, ovrButton_Enter};
+            AccessibilityRemapping remapping;
+            remapping.configure(settings);
+            Assert::IsTrue(remapping.isEnabled());
+
+            ovrInputState state{};
+            state.Buttons = ovrButton_A;
+            remapping.apply(state);
+            Assert::AreEqual((unsigned int)(ovrButton_A | ovrButton_B | ovrButton_RThumb), state.Buttons);
+
+            // Chords are not chained.
+            settings.chords[1] = {ovrButton_B, ovrButton_Enter};
+            remapping.configure(settings);
+            state.Buttons = ovrButton_A;
+            remapping.apply(state);
+            Assert::AreEqual((unsigned int)(ovrButton_A | ovrButton_B | ovrButton_RThumb), state.Buttons);
+        }
+
+        TEST_METHOD(ChordToToggle) {
+            // The chord is resolved first, so the buttons it presses can be toggles.
+            AccessibilityRemappingSettings settings;
+            settings.chords[0] = {ovrButton_A, ovrButton_B};
+            settings.toggleButtons = ovrButton_B;
+            AccessibilityRemapping remapping;
+            remapping.configure(settings);
+
+            ovrInputState state{};
+            state.Buttons = ovrButton_A;
+            remapping.apply(state);
+            Assert::AreEqual((unsigned int)(ovrButton_A | ovrButton_B), state.Buttons);
+            state.Buttons = 0;
+            remapping.apply(state);
+            Assert::AreEqual((unsigned int)ovrButton_B, state.Buttons);
+        }
+
+        TEST_METHOD(MirrorLeftToRight) {
+            AccessibilityRemappingSettings settings;
+            settings.mirrorFromSide = xr::Side::Left;
+            settings.deriveOffHandPose = true;
+            AccessibilityRemapping remapping;
+            remapping.configure(settings);
+
+            ovrInputState state{};
+            state.Buttons = ovrButton_X | ovrButton_LThumb;
+            state.Touches = ovrTouch_LIndexTrigger;
+            state.IndexTrigger[xr::Side::Left] = state.IndexTriggerNoDeadzone[xr::Side::Left] = 0.8f;
+            state.IndexTrigger[xr::Side::Right] = state.IndexTriggerNoDeadzone[xr::Side::Right] = 0.3f;
+            state.HandTrigger[xr::Side::Right] = state.HandTriggerNoDeadzone[xr::Side::Right] = 0.6f;
+            state.Thumbstick[xr::Side::Left] = state.ThumbstickNoDeadzone[xr::Side::Left] = {0.f, 0.9f};
+            state.Thumbstick[xr::Side::Right] = state.ThumbstickNoDeadzone[xr::Side::Right] = {0.2f, 0.f};
+            remapping.apply(state);
+
+            Assert::AreEqual((unsigned int)(ovrButton_X | ovrButton_LThumb | ovrButton_A | ovrButton_RThumb),
+                             state.Buttons);
+            Assert::AreEqual((unsigned int)(ovrTouch_LIndexTrigger | ovrTouch_RIndexTrigger), state.Touches);
+            Assert::AreEqual(0.8f, state.IndexTrigger[xr::Side::Right], 0.f);
+            Assert::AreEqual(0.8f, state.IndexTriggerNoDeadzone[xr::Side::Right], 0.f);
+            // The right controller's own inputs are kept when they are larger.
+            Assert::AreEqual(0.6f, state.HandTrigger[xr::Side::Right], 0.f);
+            Assert::AreEqual(0.9f, state.Thumbstick[xr::Side::Right].y, 0.f);
+            // The source side is untouched.
+            Assert::AreEqual(0.8f, state.IndexTrigger[xr::Side::Left], 0.f);
+            Assert::AreEqual(0.f, state.HandTrigger[xr::Side::Left], 0.f);
+
+            Assert::IsTrue(remapping.isControllerEmulated(xr::Side::Right, false, true));
+            Assert::IsFalse(remapping.isControllerEmulated(xr::Side::Right, true, true));
+            Assert::IsFalse(remapping.isControllerEmulated(xr::Side::Left, false, true));
+            Assert::IsFalse(remapping.isControllerEmulated(xr::Side::Right, false, false));
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
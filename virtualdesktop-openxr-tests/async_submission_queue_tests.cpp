@@ -0,0 +1,315 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "async_submission_queue.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        using Clock = std::chrono::high_resolution_clock;
+
+        // Sleep() and WaitOnAddress() timeouts only have millisecond granularity: spin instead.
+        void SpinUntil(Clock::time_point time) {
+            while (Clock::now() < time) {
+                std::this_thread::yield();
+            }
+        }
+
+        // The submission thread and a compositor with a fixed refresh rate, following the protocol of
+        // OpenXrRuntime::asyncSubmissionThread(): wait for the next slot, retire the previous frame, wait for a frame,
+        // submit it.
+        class FakeCompositor {
+          public:
+            FakeCompositor(AsyncSubmissionQueue& queue,
+                           std::chrono::microseconds refreshPeriod,
+                           std::chrono::microseconds submitDuration)
+                : m_queue(queue), m_refreshPeriod(refreshPeriod), m_submitDuration(submitDuration),
+                  m_thread([&] { run(); }) {
+            }
+
+            ~FakeCompositor() {
+                stop();
+            }
+
+            void stop() {
+                if (m_thread.joinable()) {
+                    m_queue.terminate();
+                    m_thread.join();
+                }
+            }
+
+            // Time between the application waking up for a frame and its submission (one sample per frame). Only valid
+            // after stop().
+            const std::vector<double>& getLatencies() const {
+                return m_latencies;
+            }
+
+          private:
+            void run() {
+                const Clock::time_point start = Clock::now();
+                while (true) {
+                    // ovr_WaitToBeginFrame(): the next slot opens on the next refresh.
+                    SpinUntil(start + ((Clock::now() - start) / m_refreshPeriod + 1) * m_refreshPeriod);
+
+                    // ovr_BeginFrame().
+                    m_queue.retire();
+
+                    auto* const frame = m_queue.waitForPendingFrame();
+                    if (!frame) {
+                        break;
+                    }
+
+                    // ovr_EndFrame().
+                    SpinUntil(Clock::now() + m_submitDuration);
+                    m_latencies.push_back(
+                        std::chrono::duration<double>(Clock::now().time_since_epoch()).count() - frame->displayTime);
+                    m_queue.markSubmitted();
+                }
+            }
+
+            AsyncSubmissionQueue& m_queue;
+            const std::chrono::microseconds m_refreshPeriod;
+            const std::chrono::microseconds m_submitDuration;
+            std::vector<double> m_latencies;
+            std::thread m_thread;
+        };
+
+        // The application side, following xrWaitFrame() and xrEndFrame(). The time the application woke up for the
+        // frame is passed in place of the display time.
+        void RunApplicationFrames(AsyncSubmissionQueue& queue, uint32_t frameCount, std::chrono::microseconds work) {
+            for (uint32_t i = 0; i < frameCount; i++) {
+                queue.waitForFramesInFlight(queue.getDepth() - 1);
+                const double wakeTime = std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+                SpinUntil(Clock::now() + work);
+                queue.waitForHandoff();
+                queue.getNextFrame().frameId = i;
+                queue.getNextFrame().displayTime = wakeTime;
+                queue.push();
+            }
+            queue.waitForHandoff();
+        }
+
+        double Percentile(std::vector<double> values, double percentile) {
+            std::sort(values.begin(), values.end());
+            return values[std::min((size_t)(percentile * values.size()), values.size() - 1)];
+        }
+
+    } // namespace
+
+    TEST_CLASS(AsyncSubmissionQueueTests) {
+        TEST_METHOD(DepthIsClamped) {
+            AsyncSubmissionQueue queue;
+            Assert::AreEqual(1u, queue.getDepth());
+            queue.setDepth(0);
+            Assert::AreEqual(1u, queue.getDepth());
+            queue.setDepth(2);
+            Assert::AreEqual(2u, queue.getDepth());
+            queue.setDepth(3);
+            Assert::AreEqual(AsyncSubmissionQueue::MaxDepth, queue.getDepth());
+        }
+
+        TEST_METHOD(FramesAreSubmittedInOrder) {
+            for (uint32_t depth = 1; depth <= AsyncSubmissionQueue::MaxDepth; depth++) {
+                AsyncSubmissionQueue queue;
+                queue.setDepth(depth);
+
+                std::vector<long long> submitted;
+                std::vector<size_t> layerCounts;
+                std::thread consumer([&] {
+                    while (true) {
+                        queue.retire();
+                        auto* const frame = queue.waitForPendingFrame();
+                        if (!frame) {
+                            break;
+                        }
+                        layerCounts.push_back(frame->layers.size());
+                        submitted.push_back(frame->frameId);
+                        queue.markSubmitted();
+                    }
+                });
+
+                for (long long i = 0; i < 1000; i++) {
+                    queue.waitForFramesInFlight(depth - 1);
+                    queue.waitForHandoff();
+                    auto& frame = queue.getNextFrame();
+                    frame.frameId = i;
+                    frame.layers.resize(1);
+                    queue.push();
+                    Assert::IsTrue(queue.getFramesInFlight() <= depth);
+                }
+                queue.waitForHandoff();
+                queue.terminate();
+                consumer.join();
+
+                Assert::AreEqual((size_t)1000, submitted.size());
+                for (long long i = 0; i < 1000; i++) {
+                    Assert::AreEqual(i, submitted[i]);
+                    Assert::AreEqual((size_t)1, layerCounts[i]);
+                }
+            }
+        }
+
+        TEST_METHOD(BackPressure) {
+            AsyncSubmissionQueue queue;
+            queue.setDepth(2);
+            const auto soon = [] { return Clock::now() + 5ms; };
+
+            queue.push();
+            Assert::AreEqual(1u, queue.getFramesInFlight());
+            Assert::IsTrue(queue.waitForFramesInFlight(1, soon()));
+            Assert::IsFalse(queue.waitForFramesInFlight(0, soon()));
+
+            // Submitted but not retired: still in flight.
+            Assert::IsTrue(queue.hasPendingFrame());
+            queue.markSubmitted();
+            Assert::IsFalse(queue.hasPendingFrame());
+            queue.push();
+            Assert::AreEqual(2u, queue.getFramesInFlight());
+            Assert::IsFalse(queue.waitForFramesInFlight(1, soon()));
+
+            // Retiring only releases submitted frames.
+            queue.retire();
+            queue.retire();
+            Assert::AreEqual(1u, queue.getFramesInFlight());
+            Assert::IsTrue(queue.waitForFramesInFlight(1, soon()));
+
+            // The blocked producer is released by the consumer.
+            std::thread consumer([&] {
+                std::this_thread::sleep_for(10ms);
+                queue.markSubmitted();
+                queue.retire();
+            });
+            Assert::IsTrue(queue.waitForFramesInFlight(0));
+            consumer.join();
+        }
+
+        TEST_METHOD(TerminateReleasesConsumer) {
+            AsyncSubmissionQueue queue;
+            AsyncSubmissionQueue::Frame* frame = &queue.getNextFrame();
+            std::thread consumer([&] { frame = queue.waitForPendingFrame(); });
+            std::this_thread::sleep_for(10ms);
+            queue.terminate();
+            consumer.join();
+            Assert::IsTrue(frame == nullptr);
+            Assert::IsTrue(queue.isTerminating());
+
+            queue.reset();
+            Assert::IsFalse(queue.isTerminating());
+            Assert::AreEqual(0u, queue.getFramesInFlight());
+        }
+
+        TEST_METHOD(DepthBenchmark) {
+            // An application rendering in 8ms at 100Hz, with 3ms of submission: the frame does not fit in a single
+            // refresh period, unless the application can render the next frame while the previous one is submitted.
+            constexpr auto RefreshPeriod = 10000us;
+            constexpr uint32_t FrameCount = 100;
+
+            double frameRate[AsyncSubmissionQueue::MaxDepth + 1]{};
+            for (uint32_t depth = 1; depth <= AsyncSubmissionQueue::MaxDepth; depth++) {
+                AsyncSubmissionQueue queue;
+                queue.setDepth(depth);
+
+                const auto start = Clock::now();
+                std::vector<double> latencies;
+                {
+                    FakeCompositor compositor(queue, RefreshPeriod, 3000us);
+                    RunApplicationFrames(queue, FrameCount, 8000us);
+                    compositor.stop();
+                    latencies = compositor.getLatencies();
+                }
+                const double duration = std::chrono::duration<double>(Clock::now() - start).count();
+                frameRate[depth] = FrameCount / duration;
+
+                Logger::WriteMessage(fmt::format("Depth {}: {:.1f} fps, latency p50 {:.2f}ms, p99 {:.2f}ms\n",
+                                                 depth,
+                                                 frameRate[depth],
+                                                 Percentile(latencies, 0.5) * 1e3,
+                                                 Percentile(latencies, 0.99) * 1e3)
+                                         .c_str());
+            }
+
+            // Depth 1 halves the frame rate, depth 2 sustains the refresh rate.
+            Assert::IsTrue(frameRate[1] < 70);
+            Assert::IsTrue(frameRate[2] > 1.5 * frameRate[1]);
+        }
+
+        TEST_METHOD(HandoffLatencyBenchmark) {
+            // Time between push() and the submission thread waking up in waitForPendingFrame(), when the thread is
+            // already blocked in WaitOnAddress(): the cost of the handoff itself.
+            constexpr uint32_t FrameCount = 2000;
+
+            for (uint32_t depth = 1; depth <= AsyncSubmissionQueue::MaxDepth; depth++) {
+                AsyncSubmissionQueue queue;
+                queue.setDepth(depth);
+
+                std::vector<double> latencies;
+                latencies.reserve(FrameCount);
+                std::thread consumer([&] {
+                    while (true) {
+                        queue.retire();
+                        auto* const frame = queue.waitForPendingFrame();
+                        if (!frame) {
+                            break;
+                        }
+                        latencies.push_back(std::chrono::duration<double>(Clock::now().time_since_epoch()).count() -
+                                            frame->displayTime);
+                        queue.markSubmitted();
+                    }
+                });
+
+                for (uint32_t i = 0; i < FrameCount; i++) {
+                    queue.waitForFramesInFlight(depth - 1);
+                    queue.waitForHandoff();
+
+                    // Give the consumer time to block.
+                    SpinUntil(Clock::now() + 200us);
+                    queue.getNextFrame().frameId = i;
+                    queue.getNextFrame().displayTime =
+                        std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+                    queue.push();
+                }
+                queue.waitForHandoff();
+                queue.terminate();
+                consumer.join();
+
+                Assert::AreEqual((size_t)FrameCount, latencies.size());
+                Logger::WriteMessage(fmt::format("Depth {}: handoff latency p50 {:.1f}us, p99 {:.1f}us, max {:.1f}us\n",
+                                                 depth,
+                                                 Percentile(latencies, 0.5) * 1e6,
+                                                 Percentile(latencies, 0.99) * 1e6,
+                                                 Percentile(latencies, 1.0) * 1e6)
+                                         .c_str());
+
+                // Only catch gross regressions (eg: a lost wake-up falling back to a timeout).
+                Assert::IsTrue(Percentile(latencies, 0.5) < 0.001);
+            }
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
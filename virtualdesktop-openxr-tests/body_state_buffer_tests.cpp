@@ -0,0 +1,298 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "body_state_buffer.h"
+#include "body_state_recording.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        // Fill every byte of the state with a pattern unique to the generation, so that a copy mixing two
+        // generations can be detected anywhere in the state.
+        void FillPattern(BodyTracking::BodyStateV2& state, uint32_t generation) {
+            uint8_t* const bytes = reinterpret_cast<uint8_t*>(&state);
+            for (size_t i = 0; i < sizeof(state); i++) {
+                bytes[i] = (uint8_t)(generation * 131 + i * 7);
+            }
+            state.SkeletonChangedCount = (int32_t)generation;
+        }
+
+        bool HasPattern(const BodyTracking::BodyStateV2& state, uint32_t generation) {
+            if (state.SkeletonChangedCount != (int32_t)generation) {
+                return false;
+            }
+            const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(&state);
+            for (size_t i = 0; i < offsetof(BodyTracking::BodyStateV2, SkeletonChangedCount); i++) {
+                if (bytes[i] != (uint8_t)(generation * 131 + i * 7)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        float GetLeftHandPosition(const BodyStateBuffer& buffer, double time, double maxExtrapolation) {
+            float position = 0.f;
+            buffer.readAt(BodyStateSection::Hands,
+                          time,
+                          [&](const BodyTracking::BodyStateV2& older,
+                              double olderTime,
+                              const BodyTracking::BodyStateV2& newer,
+                              double newerTime) {
+                              const float t = GetBodyStateBlendFactor(olderTime, newerTime, time, maxExtrapolation);
+                              position = InterpolateBodyTrackingPose(older.LeftHandJointStates[0].Pose,
+                                                                     newer.LeftHandJointStates[0].Pose,
+                                                                     t)
+                                             .position.x;
+                          });
+            return position;
+        }
+
+        void SetLeftHandPosition(BodyTracking::BodyStateV2& state, float position) {
+            state.LeftHandActive = true;
+            for (auto& joint : state.LeftHandJointStates) {
+                joint.Pose.orientation = {0.f, 0.f, 0.f, 1.f};
+                joint.Pose.position = {position, 1.f, -0.3f};
+            }
+        }
+
+    } // namespace
+
+    TEST_CLASS(BodyStateBufferTests) {
+        TEST_METHOD(SectionUpdatesBracketTheTime) {
+            auto buffer = std::make_unique<BodyStateBuffer>();
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+
+            // The hands update more slowly than the eyes: the hands are carried over in the snapshots of the eyes.
+            SetLeftHandPosition(*state, 0.f);
+            buffer->publish(*state, 0.000);
+            state->LeftEyeConfidence = 1.f;
+            Assert::AreEqual(1u << (uint32_t)BodyStateSection::Eyes, buffer->publish(*state, 0.005));
+            SetLeftHandPosition(*state, 1.f);
+            buffer->publish(*state, 0.010);
+            state->LeftEyeConfidence = 2.f;
+            buffer->publish(*state, 0.012);
+
+            const auto bracket = [&](BodyStateSection section, double time) {
+                std::pair<double, double> times;
+                buffer->readAt(section,
+                               time,
+                               [&](const BodyTracking::BodyStateV2&,
+                                   double olderTime,
+                                   const BodyTracking::BodyStateV2&,
+                                   double newerTime) { times = {olderTime, newerTime}; });
+                return times;
+            };
+            Assert::IsTrue(bracket(BodyStateSection::Hands, 0.004) == std::make_pair(0.000, 0.010));
+            Assert::IsTrue(bracket(BodyStateSection::Hands, 0.011) == std::make_pair(0.000, 0.010));
+            Assert::IsTrue(bracket(BodyStateSection::Eyes, 0.004) == std::make_pair(0.000, 0.005));
+            Assert::IsTrue(bracket(BodyStateSection::Eyes, 0.011) == std::make_pair(0.005, 0.012));
+            Assert::IsTrue(bracket(BodyStateSection::Eyes, 0.020) == std::make_pair(0.005, 0.012));
+
+            // Interpolation and extrapolation follow the hand updates, not the publications.
+            Assert::AreEqual(0.5f, GetLeftHandPosition(*buffer, 0.005, 0.0), 1e-5f);
+            Assert::AreEqual(1.2f, GetLeftHandPosition(*buffer, 0.012, 0.01), 1e-5f);
+
+            // Before two updates of the section are available.
+            buffer = std::make_unique<BodyStateBuffer>();
+            buffer->publish(*state, 0.000);
+            state->LeftEyeConfidence = 3.f;
+            buffer->publish(*state, 0.005);
+            Assert::IsTrue(bracket(BodyStateSection::Hands, 0.010) == std::make_pair(0.000, 0.000));
+            Assert::AreEqual(1.f, GetLeftHandPosition(*buffer, 0.010, 0.01), 0.f);
+        }
+
+        TEST_METHOD(ReplayedHandMotion) {
+            // Record hands moving at a constant speed and updating at 60Hz, while the eyes update at 90Hz, then replay
+            // the recording into the buffer and resolve the hands at times between and past the updates.
+            constexpr uint32_t TicksPerSecond = 180;
+            constexpr uint32_t HandPeriod = 3;
+            constexpr uint32_t EyePeriod = 2;
+            constexpr float Speed = 0.5f;
+            constexpr double MaxExtrapolation = 0.025;
+
+            const std::filesystem::path path =
+                std::filesystem::temp_directory_path() / "virtualdesktop-openxr-tests-replay.bin";
+            {
+                BodyStateRecorder recorder;
+                Assert::IsTrue(recorder.open(path));
+                auto state = std::make_unique<BodyTracking::BodyStateV2>();
+                for (uint32_t tick = 0; tick <= TicksPerSecond; tick++) {
+                    const double time = (double)tick / TicksPerSecond;
+                    if (tick % HandPeriod == 0) {
+                        SetLeftHandPosition(*state, Speed * (float)time);
+                    }
+                    if (tick % EyePeriod == 0) {
+                        state->LeftEyeIsValid = true;
+                        state->LeftEyePose.position.x = (float)tick;
+                    }
+                    recorder.record(*state, time);
+                }
+                Assert::AreEqual((uint64_t)(TicksPerSecond / HandPeriod + TicksPerSecond / EyePeriod -
+                                            TicksPerSecond / (HandPeriod * EyePeriod) + 1),
+                                 recorder.frameCount());
+            }
+
+            BodyStateReplayer replayer;
+            Assert::IsTrue(replayer.open(path));
+            auto buffer = std::make_unique<BodyStateBuffer>();
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            double time;
+            uint32_t numEyesOnlyUpdates = 0;
+            float maxInterpolationError = 0.f;
+            float maxExtrapolationError = 0.f;
+            while (replayer.next(*state, time)) {
+                if (buffer->publish(*state, time) == 1u << (uint32_t)BodyStateSection::Eyes) {
+                    numEyesOnlyUpdates++;
+                }
+                if (time < 0.1) {
+                    continue;
+                }
+
+                const double pastTime = time - 0.008;
+                const float pastPosition = GetLeftHandPosition(*buffer, pastTime, MaxExtrapolation);
+                maxInterpolationError =
+                    std::max(maxInterpolationError, std::abs(pastPosition - Speed * (float)pastTime));
+                const double futureTime = time + 0.005;
+                const float futurePosition = GetLeftHandPosition(*buffer, futureTime, MaxExtrapolation);
+                maxExtrapolationError =
+                    std::max(maxExtrapolationError, std::abs(futurePosition - Speed * (float)futureTime));
+            }
+            replayer = {};
+            std::filesystem::remove(path);
+
+            Logger::WriteMessage(fmt::format("Max error: interpolation {:.3f}mm, extrapolation {:.3f}mm\n",
+                                             maxInterpolationError * 1e3f,
+                                             maxExtrapolationError * 1e3f)
+                                     .c_str());
+            Assert::IsTrue(numEyesOnlyUpdates > 0);
+            Assert::IsTrue(maxInterpolationError < 1e-4f);
+            Assert::IsTrue(maxExtrapolationError < 1e-4f);
+        }
+
+        TEST_METHOD(TornReadStress) {
+            // One writer publishing patterned states as fast as possible, and several readers using both read() and
+            // readAt(). Each reader validates its copies after the read returned, and records the errors.
+            constexpr uint32_t PublishCount = 20000;
+            constexpr uint32_t ReaderCount = 3;
+
+            auto buffer = std::make_unique<BodyStateBuffer>();
+            std::atomic<bool> isDone{false};
+
+            struct ReaderStats {
+                uint64_t numReads{0};
+                uint64_t numTornReads{0};
+                uint64_t numMismatchedGenerations{0};
+                uint64_t numGenerationRegressions{0};
+            };
+            ReaderStats stats[ReaderCount];
+
+            std::vector<std::thread> readers;
+            for (uint32_t r = 0; r < ReaderCount; r++) {
+                readers.emplace_back([&, r] {
+                    auto snapshot = std::make_unique<BodyTracking::BodyStateV2>();
+                    auto older = std::make_unique<BodyTracking::BodyStateV2>();
+                    ReaderStats& s = stats[r];
+                    uint64_t lastGeneration = 0;
+                    uint64_t lastBufferGeneration = 0;
+                    for (uint32_t i = 0; !isDone.load(std::memory_order_relaxed); i++) {
+                        const uint64_t bufferGeneration = buffer->generation();
+                        if (bufferGeneration < lastBufferGeneration) {
+                            s.numGenerationRegressions++;
+                        }
+                        lastBufferGeneration = bufferGeneration;
+
+                        if (i % 2) {
+                            const uint64_t generation = buffer->read(*snapshot);
+                            s.numReads++;
+                            if (generation < lastGeneration) {
+                                s.numGenerationRegressions++;
+                            }
+                            lastGeneration = generation;
+                            if (generation && !HasPattern(*snapshot, (uint32_t)generation)) {
+                                s.numTornReads++;
+                            }
+                        } else {
+                            // Somewhere within the history.
+                            const double time = (double)bufferGeneration - (i % (BodyStateBuffer::HistoryDepth + 2));
+                            double olderTime = 0, newerTime = 0;
+                            const uint64_t generation =
+                                buffer->readAt(BodyStateSection::Hands,
+                                               time,
+                                               [&](const BodyTracking::BodyStateV2& olderState,
+                                                   double olderStateTime,
+                                                   const BodyTracking::BodyStateV2& newerState,
+                                                   double newerStateTime) {
+                                                   *older = olderState;
+                                                   olderTime = olderStateTime;
+                                                   *snapshot = newerState;
+                                                   newerTime = newerStateTime;
+                                               });
+                            s.numReads++;
+                            if (!generation) {
+                                continue;
+                            }
+                            if (!HasPattern(*snapshot, (uint32_t)newerTime) ||
+                                !HasPattern(*older, (uint32_t)olderTime)) {
+                                s.numTornReads++;
+                            }
+                            if ((uint64_t)newerTime != generation ||
+                                (generation >= 2 && (uint64_t)olderTime != generation - 1)) {
+                                s.numMismatchedGenerations++;
+                            }
+                        }
+                    }
+                });
+            }
+
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            for (uint32_t generation = 1; generation <= PublishCount; generation++) {
+                FillPattern(*state, generation);
+                Assert::AreEqual(AllBodyStateSections, buffer->publish(*state, (double)generation));
+                Assert::AreEqual((uint64_t)generation, buffer->generation());
+            }
+            isDone = true;
+            for (auto& reader : readers) {
+                reader.join();
+            }
+
+            for (const auto& s : stats) {
+                Assert::IsTrue(s.numReads > 0);
+                Assert::AreEqual((uint64_t)0, s.numTornReads);
+                Assert::AreEqual((uint64_t)0, s.numMismatchedGenerations);
+                Assert::AreEqual((uint64_t)0, s.numGenerationRegressions);
+            }
+            Logger::WriteMessage(fmt::format("{} reads, {} retries\n",
+                                             stats[0].numReads + stats[1].numReads + stats[2].numReads,
+                                             buffer->readRetries())
+                                     .c_str());
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "body_state_filter.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr float Rate = 90.f;
+        constexpr float NoiseStdDev = 0.002f; // 2mm, in line with the jitter of optical hand tracking.
+        constexpr OneEuroFilterParameters DefaultParameters{1.f, 5.f, 1.f};
+
+        BodyTracking::Pose MakePose(float x, float yaw = 0.f) {
+            BodyTracking::Pose pose{};
+            pose.orientation = {0.f, std::sin(yaw / 2.f), 0.f, std::cos(yaw / 2.f)};
+            pose.position = {x, 1.f, 0.f};
+            return pose;
+        }
+
+        float RootMeanSquare(const std::vector<float>& values) {
+            float sum = 0.f;
+            for (const float value : values) {
+                sum += value * value;
+            }
+            return std::sqrt(sum / values.size());
+        }
+
+        float Yaw(const BodyTracking::Pose& pose) {
+            return 2.f * std::atan2(pose.orientation.y, pose.orientation.w);
+        }
+
+        // Filter a signal moving at a constant speed along X with gaussian noise, and return the errors of the raw and
+        // filtered signals against the ground truth, once the filter has settled.
+        void FilterRamp(const OneEuroFilterParameters& parameters,
+                        float speed,
+                        std::vector<float>& rawErrors,
+                        std::vector<float>& filteredErrors) {
+            std::mt19937 rng(42);
+            std::normal_distribution<float> noise(0.f, NoiseStdDev);
+
+            OneEuroPoseFilter filter;
+            const float dt = 1.f / Rate;
+            for (int i = 0; i < (int)Rate * 10; i++) {
+                const float truth = speed * i * dt;
+                const float raw = truth + noise(rng);
+                const BodyTracking::Pose filtered = filter.filter(MakePose(raw), dt, parameters);
+                if (i >= (int)Rate) {
+                    rawErrors.push_back(raw - truth);
+                    filteredErrors.push_back(filtered.position.x - truth);
+                }
+            }
+        }
+
+    } // namespace
+
+    TEST_CLASS(BodyStateFilterTests) {
+        TEST_METHOD(ReducesJitterAtRest) {
+            std::vector<float> rawErrors, filteredErrors;
+            FilterRamp(DefaultParameters, 0.f, rawErrors, filteredErrors);
+
+            const float rawJitter = RootMeanSquare(rawErrors);
+            const float filteredJitter = RootMeanSquare(filteredErrors);
+            Logger::WriteMessage(
+                fmt::format("Jitter at rest: {:.2f}mm -> {:.2f}mm\n", rawJitter * 1000, filteredJitter * 1000).c_str());
+            Assert::IsTrue(filteredJitter < rawJitter / 3.f);
+        }
+
+        TEST_METHOD(ReducesAngularJitterAtRest) {
+            std::mt19937 rng(42);
+            std::normal_distribution<float> noise(0.f, 0.005f); // ~0.3 degree
+
+            OneEuroPoseFilter filter;
+            std::vector<float> rawErrors, filteredErrors;
+            for (int i = 0; i < (int)Rate * 10; i++) {
+                const float raw = 0.5f + noise(rng);
+                const BodyTracking::Pose filtered = filter.filter(MakePose(0.f, raw), 1.f / Rate, DefaultParameters);
+                if (i >= (int)Rate) {
+                    rawErrors.push_back(raw - 0.5f);
+                    filteredErrors.push_back(Yaw(filtered) - 0.5f);
+                }
+            }
+
+            const float rawJitter = RootMeanSquare(rawErrors);
+            const float filteredJitter = RootMeanSquare(filteredErrors);
+            Logger::WriteMessage(fmt::format("Angular jitter at rest: {:.3f}deg -> {:.3f}deg\n",
+                                             rawJitter * 180 / M_PI,
+                                             filteredJitter * 180 / M_PI)
+                                     .c_str());
+            Assert::IsTrue(filteredJitter < rawJitter / 2.5f);
+        }
+
+        TEST_METHOD(BoundsLagInMotion) {
+            // Steady state lag while moving at 1m/s. Without the speed coefficient, the filter lags by speed / (2 pi
+            // minCutoff), which is 16cm with the default minimum cutoff.
+            std::vector<float> rawErrors, filteredErrors;
+            FilterRamp(DefaultParameters, 1.f, rawErrors, filteredErrors);
+            float lag = 0.f;
+            for (const float error : filteredErrors) {
+                lag -= error;
+            }
+            lag /= filteredErrors.size();
+
+            std::vector<float> rawErrorsNoBeta, filteredErrorsNoBeta;
+            FilterRamp({DefaultParameters.minCutoff, 0.f, DefaultParameters.derivativeCutoff},
+                       1.f,
+                       rawErrorsNoBeta,
+                       filteredErrorsNoBeta);
+            float lagNoBeta = 0.f;
+            for (const float error : filteredErrorsNoBeta) {
+                lagNoBeta -= error;
+            }
+            lagNoBeta /= filteredErrorsNoBeta.size();
+
+            Logger::WriteMessage(fmt::format("Lag at 1m/s: {:.1f}mm (without speed coefficient: {:.1f}mm)\n",
+                                             lag * 1000,
+                                             lagNoBeta * 1000)
+                                     .c_str());
+            Assert::IsTrue(lag > 0.f);
+            Assert::IsTrue(lag < 0.02f);
+            Assert::IsTrue(lag < lagNoBeta / 10.f);
+        }
+
+        TEST_METHOD(ResetsUntrackedJoints) {
+            BodyStateFilter filter(DefaultParameters, {}, {});
+            Assert::IsTrue(filter.isEnabled());
+
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            state->LeftHandActive = true;
+            state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].Pose = MakePose(0.f);
+            filter.apply(*state, 1.0);
+            state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].Pose = MakePose(0.1f);
+            filter.apply(*state, 1.0 + 1 / Rate);
+            Assert::IsTrue(state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].Pose.position.x < 0.1f);
+
+            // The hand is lost, then found elsewhere: the new position must not be blended with the old one.
+            state->LeftHandActive = false;
+            filter.apply(*state, 1.0 + 2 / Rate);
+            state->LeftHandActive = true;
+            state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].Pose = MakePose(0.5f);
+            filter.apply(*state, 1.0 + 3 / Rate);
+            Assert::AreEqual(0.5f, state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].Pose.position.x, 1e-6f);
+        }
+
+        TEST_METHOD(DisabledWithoutCutoff) {
+            BodyStateFilter filter({}, {}, {});
+            Assert::IsFalse(filter.isEnabled());
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
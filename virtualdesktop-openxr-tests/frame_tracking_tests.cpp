@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "pch.h"
+
+#include "frame_tracking.h"
+
+namespace {
+
+    // Count the allocations made by the current thread, so that the steady state of the frame loop can be checked for
+    // heap allocations.
+    thread_local uint64_t g_allocationCount = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocationCount++;
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr double Rate = 90.0;
+
+        struct AllocationCounter {
+            uint64_t count() const {
+                return g_allocationCount - start;
+            }
+
+            const uint64_t start{g_allocationCount};
+        };
+
+    } // namespace
+
+    TEST_CLASS(FrameTrackingTests) {
+      public:
+        TEST_METHOD(CountsFramesPerPeriod) {
+            FpsCounter counter;
+            Assert::AreEqual(0u, counter.fps());
+
+            AllocationCounter allocations;
+            const double startTime = 100.0;
+            for (int i = 0; i < 3 * Rate; i++) {
+                counter.addFrame(startTime + i / Rate);
+            }
+            Assert::AreEqual((uint64_t)0, allocations.count());
+            Assert::AreEqual(90.0, (double)counter.fps(), 1.0);
+
+            counter.reset();
+            Assert::AreEqual(0u, counter.fps());
+        }
+
+        TEST_METHOD(CommitOncePerFrame) {
+            SwapchainCommitTracker commits;
+            for (uint32_t i = 0; i < 3; i++) {
+                commits.addSlice();
+            }
+
+            uint64_t frameId = 1;
+            Assert::IsFalse(commits.isCommitted(1, frameId));
+            commits.markCommitted(1, frameId);
+            Assert::IsTrue(commits.isCommitted(1, frameId));
+            Assert::IsFalse(commits.isCommitted(0, frameId));
+            Assert::IsFalse(commits.isCommitted(2, frameId));
+
+            // A new frame needs no reset.
+            frameId++;
+            Assert::IsFalse(commits.isCommitted(1, frameId));
+        }
+
+        TEST_METHOD(SteadyStateDoesNotAllocate) {
+            // Two swapchains, one of which is used by two layers, as xrEndFrame() would see them.
+            SwapchainCommitTracker projection;
+            SwapchainCommitTracker quad;
+            projection.addSlice();
+            projection.addSlice();
+            quad.addSlice();
+            FpsCounter fpsCounter;
+
+            AllocationCounter allocations;
+            uint32_t numCommits = 0;
+            uint64_t frameId = 0;
+            const auto commit = [&](SwapchainCommitTracker& swapchain, uint32_t slice) {
+                if (!swapchain.isCommitted(slice, frameId)) {
+                    swapchain.markCommitted(slice, frameId);
+                    numCommits++;
+                }
+            };
+            for (int i = 0; i < 1000; i++) {
+                frameId++;
+                commit(projection, 0);
+                commit(projection, 1);
+                commit(quad, 0);
+                commit(quad, 0);
+                fpsCounter.addFrame(i / Rate);
+            }
+            Assert::AreEqual((uint64_t)0, allocations.count());
+            Assert::AreEqual(3000u, numCommits);
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
@@ -0,0 +1,161 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "pch.h"
+
+#include "gaze_prediction.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr double Rate = 90.0;
+        constexpr float Pi = 3.14159265f;
+
+        float DegreeToRad(float degrees) {
+            return degrees * Pi / 180.f;
+        }
+
+        // The defaults used by the runtime.
+        const GazePredictionParameters Parameters{DegreeToRad(180.f), DegreeToRad(60.f), 10.f, 0.03};
+
+        XrVector3f MakeDirection(float yaw, float pitch) {
+            return {-std::sin(yaw) * std::cos(pitch), std::sin(pitch), -std::cos(yaw) * std::cos(pitch)};
+        }
+
+        float GetAngle(const XrVector3f& a, const XrVector3f& b) {
+            const float dot = a.x * b.x + a.y * b.y + a.z * b.z;
+            return std::acos(std::clamp(dot, -1.f, 1.f));
+        }
+
+        XrVector3f GetDirection(const GazeModel& model) {
+            return {model.direction.x, model.direction.y, model.direction.z};
+        }
+
+        // Feed samples moving at the given angular speed (in degrees per second) around the vertical axis, and return
+        // whether each of them was classified as a saccade.
+        std::vector<bool> MoveAt(GazePredictor& predictor, double& time, float& yaw, float speed, int count) {
+            std::vector<bool> isSaccade;
+            for (int i = 0; i < count; i++) {
+                time += 1.0 / Rate;
+                yaw += DegreeToRad(speed) / (float)Rate;
+                isSaccade.push_back(predictor.update(time, MakeDirection(yaw, 0.f), 1.f).isSaccade);
+            }
+            return isSaccade;
+        }
+
+        bool All(const std::vector<bool>& values, bool expected) {
+            return std::all_of(values.cbegin(), values.cend(), [&](bool value) { return value == expected; });
+        }
+
+    } // namespace
+
+    TEST_CLASS(GazePredictionTests) {
+        TEST_METHOD(FixationWithNoise) {
+            GazePredictor predictor(Parameters);
+            std::mt19937 random(7);
+            std::normal_distribution<float> noise(0.f, DegreeToRad(0.2f));
+
+            const XrVector3f target = MakeDirection(DegreeToRad(5.f), DegreeToRad(-3.f));
+            double sampleError = 0.0;
+            double modelError = 0.0;
+            const int count = (int)(2 * Rate);
+            for (int i = 0; i < count; i++) {
+                const XrVector3f sample =
+                    MakeDirection(DegreeToRad(5.f) + noise(random), DegreeToRad(-3.f) + noise(random));
+                const GazeModel& model = predictor.update(i / Rate, sample, 1.f);
+                Assert::IsFalse(model.isSaccade);
+                if (i >= Rate / 10) {
+                    sampleError += GetAngle(sample, target);
+                    modelError += GetAngle(GetDirection(model), target);
+                }
+            }
+
+            Assert::AreEqual((uint64_t)0, predictor.getSaccadeSampleCount());
+
+            // The noise is smoothed out.
+            Logger::WriteMessage(fmt::format("Fixation: mean sample error {:.3f} deg, mean model error {:.3f} deg\n",
+                                             sampleError * 180.0 / Pi / count,
+                                             modelError * 180.0 / Pi / count)
+                                     .c_str());
+            Assert::IsTrue(modelError < 0.75 * sampleError);
+        }
+
+        TEST_METHOD(StepSaccade) {
+            GazePredictor predictor(Parameters);
+            double time = 0.0;
+            float yaw = 0.f;
+
+            Assert::IsTrue(All(MoveAt(predictor, time, yaw, 0.f, (int)(Rate / 2)), false));
+
+            // A 20 degree saccade at 500 deg/s, is followed unfiltered.
+            const std::vector<bool> saccade = MoveAt(predictor, time, yaw, 500.f, 4);
+            Assert::IsTrue(All(saccade, true));
+            Assert::AreEqual(0.f, GetAngle(GetDirection(predictor.getModel()), MakeDirection(yaw, 0.f)), 1e-4f);
+
+            // The gaze settles at the target right away.
+            const std::vector<bool> fixation = MoveAt(predictor, time, yaw, 0.f, (int)(Rate / 2));
+            Assert::IsTrue(All(fixation, false));
+            Assert::AreEqual(0.f, GetAngle(GetDirection(predictor.getModel()), MakeDirection(yaw, 0.f)), 1e-3f);
+        }
+
+        TEST_METHOD(Hysteresis) {
+            GazePredictor predictor(Parameters);
+            double time = 0.0;
+            float yaw = 0.f;
+
+            MoveAt(predictor, time, yaw, 0.f, 1);
+
+            // Between the two thresholds, the classification does not change.
+            Assert::IsTrue(All(MoveAt(predictor, time, yaw, 120.f, 5), false));
+            Assert::IsTrue(All(MoveAt(predictor, time, yaw, 300.f, 1), true));
+            Assert::IsTrue(All(MoveAt(predictor, time, yaw, 120.f, 5), true));
+            Assert::IsTrue(All(MoveAt(predictor, time, yaw, 30.f, 1), false));
+            Assert::IsTrue(All(MoveAt(predictor, time, yaw, 120.f, 5), false));
+        }
+
+        TEST_METHOD(SmoothPursuit) {
+            for (const float speed : {10.f, 30.f, 50.f}) {
+                GazePredictor predictor(Parameters);
+                double time = 0.0;
+                float yaw = 0.f;
+
+                MoveAt(predictor, time, yaw, 0.f, 1);
+                Assert::IsTrue(All(MoveAt(predictor, time, yaw, speed, (int)(2 * Rate)), false));
+
+                Logger::WriteMessage(
+                    fmt::format("Pursuit at {} deg/s: mean prediction error {:.3f} deg, mean hold error {:.3f} deg\n",
+                                speed,
+                                predictor.getMeanPredictionError() * 180.0 / Pi,
+                                predictor.getMeanHoldError() * 180.0 / Pi)
+                        .c_str());
+                Assert::IsTrue(predictor.getMeanPredictionError() < 0.5 * predictor.getMeanHoldError());
+            }
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
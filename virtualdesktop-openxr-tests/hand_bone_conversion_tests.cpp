@@ -0,0 +1,188 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "pch.h"
+
+#include "hand_bone_conversion.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+    using namespace xr::math;
+
+    namespace {
+
+        // The conversion as it was written before the corrections were precomputed: the correction rotations are built
+        // from Euler angles for every joint, and the radii are chosen per joint.
+        void ReferenceConversion(uint32_t side,
+                                 const XrPosef& basePose,
+                                 BodyTracking::FingerJointState* joints,
+                                 const vr::VRBoneTransform_t* bones) {
+            const auto vrPoseToXrPose = [](const vr::VRBoneTransform_t& vrPose) {
+                XrPosef xrPose;
+                xrPose.position = {vrPose.position.v[0], vrPose.position.v[1], vrPose.position.v[2]};
+                xrPose.orientation = {
+                    vrPose.orientation.x, vrPose.orientation.y, vrPose.orientation.z, vrPose.orientation.w};
+                return xrPose;
+            };
+
+            const auto xrPoseToBodyTrackingPose = [](const XrPosef& xrPose) {
+                BodyTracking::Pose bodyTrackingPose;
+                bodyTrackingPose.position = {xrPose.position.x, xrPose.position.y, xrPose.position.z};
+                bodyTrackingPose.orientation = {
+                    xrPose.orientation.x, xrPose.orientation.y, xrPose.orientation.z, xrPose.orientation.w};
+                return bodyTrackingPose;
+            };
+
+            XrVector3f barycenter{};
+            XrPosef accumulatedPose = basePose;
+            XrPosef wristPose;
+            for (uint32_t i = 0; i <= eBone_PinkyFinger4; i++) {
+                accumulatedPose = Pose::Multiply(vrPoseToXrPose(bones[i]), accumulatedPose);
+
+                if (i != XR_HAND_JOINT_PALM_EXT) {
+                    XrPosef correctedPose;
+                    if (i != XR_HAND_JOINT_WRIST_EXT) {
+                        correctedPose = Pose::Multiply(
+                            Pose::Orientation(
+                                {(side == xr::Side::Left) ? 0.f : (float)M_PI, (float)-M_PI_2, (float)M_PI}),
+                            accumulatedPose);
+                    } else {
+                        correctedPose = Pose::Multiply(
+                            Pose::Orientation(
+                                {(float)M_PI, 0.f, (side == xr::Side::Left) ? (float)-M_PI_2 : (float)M_PI_2}),
+                            accumulatedPose);
+                    }
+                    joints[i].Pose = xrPoseToBodyTrackingPose(correctedPose);
+                }
+
+                switch (i) {
+                case XR_HAND_JOINT_WRIST_EXT:
+                    joints[i].Radius = 0.016f;
+                    wristPose = accumulatedPose;
+                    break;
+
+                case XR_HAND_JOINT_INDEX_METACARPAL_EXT:
+                case XR_HAND_JOINT_INDEX_PROXIMAL_EXT:
+                case XR_HAND_JOINT_MIDDLE_METACARPAL_EXT:
+                case XR_HAND_JOINT_MIDDLE_PROXIMAL_EXT:
+                case XR_HAND_JOINT_RING_METACARPAL_EXT:
+                case XR_HAND_JOINT_RING_PROXIMAL_EXT:
+                case XR_HAND_JOINT_LITTLE_METACARPAL_EXT:
+                case XR_HAND_JOINT_LITTLE_PROXIMAL_EXT:
+                    joints[i].Radius = 0.016f;
+                    barycenter = barycenter + accumulatedPose.position;
+                    break;
+
+                case XR_HAND_JOINT_THUMB_TIP_EXT:
+                case XR_HAND_JOINT_INDEX_TIP_EXT:
+                case XR_HAND_JOINT_MIDDLE_TIP_EXT:
+                case XR_HAND_JOINT_RING_TIP_EXT:
+                case XR_HAND_JOINT_LITTLE_TIP_EXT:
+                    joints[i].Radius = 0.008f;
+                    accumulatedPose = wristPose;
+                    break;
+
+                default:
+                    joints[i].Radius = 0.008f;
+                    break;
+                }
+            }
+
+            barycenter = barycenter / 8.0f;
+            joints[XR_HAND_JOINT_PALM_EXT].Radius = 0.016f;
+            joints[XR_HAND_JOINT_PALM_EXT].Pose = xrPoseToBodyTrackingPose(
+                Pose::MakePose(joints[XR_HAND_JOINT_MIDDLE_METACARPAL_EXT].Pose.orientation, barycenter));
+        }
+
+        XrQuaternionf RandomOrientation(std::mt19937& random) {
+            // Normalized gaussian samples are uniformly distributed over the rotations.
+            std::normal_distribution<float> component;
+            XrQuaternionf orientation;
+            StoreXrQuaternion(&orientation,
+                              DirectX::XMQuaternionNormalize(DirectX::XMVectorSet(
+                                  component(random), component(random), component(random), component(random))));
+            return orientation;
+        }
+
+        XrVector3f RandomPosition(std::mt19937& random, float range) {
+            std::uniform_real_distribution<float> coordinate(-range, range);
+            return {coordinate(random), coordinate(random), coordinate(random)};
+        }
+
+    } // namespace
+
+    TEST_CLASS(HandBoneConversionTests) {
+        TEST_METHOD(MatchesEulerConversion) {
+            std::mt19937 random(42);
+            float maxPositionError = 0.f;
+            float maxOrientationError = 0.f;
+            for (int iteration = 0; iteration < 500; iteration++) {
+                vr::VRBoneTransform_t bones[eBone_Count];
+                for (uint32_t i = 0; i < eBone_Count; i++) {
+                    const XrQuaternionf orientation = RandomOrientation(random);
+                    const XrVector3f position = RandomPosition(random, 0.05f);
+                    bones[i].orientation = {orientation.w, orientation.x, orientation.y, orientation.z};
+                    bones[i].position = {position.x, position.y, position.z, 1.f};
+                }
+                const XrPosef basePose = Pose::MakePose(RandomOrientation(random), RandomPosition(random, 2.f));
+
+                for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                    BodyTracking::FingerJointState expected[XR_HAND_JOINT_COUNT_EXT]{};
+                    BodyTracking::FingerJointState actual[XR_HAND_JOINT_COUNT_EXT]{};
+                    ReferenceConversion(side, basePose, expected, bones);
+                    convertSteamVRBonesToFingerJoints(side, basePose, actual, bones);
+
+                    for (uint32_t i = 0; i < XR_HAND_JOINT_COUNT_EXT; i++) {
+                        Assert::AreEqual(expected[i].Radius, actual[i].Radius);
+
+                        const BodyTracking::Pose& e = expected[i].Pose;
+                        const BodyTracking::Pose& a = actual[i].Pose;
+                        maxPositionError = std::max({maxPositionError,
+                                                     std::abs(e.position.x - a.position.x),
+                                                     std::abs(e.position.y - a.position.y),
+                                                     std::abs(e.position.z - a.position.z)});
+                        maxOrientationError = std::max({maxOrientationError,
+                                                        std::abs(e.orientation.x - a.orientation.x),
+                                                        std::abs(e.orientation.y - a.orientation.y),
+                                                        std::abs(e.orientation.z - a.orientation.z),
+                                                        std::abs(e.orientation.w - a.orientation.w)});
+                    }
+                }
+            }
+
+            Logger::WriteMessage(fmt::format("Max position difference {:.3g} m, max quaternion difference {:.3g}\n",
+                                             maxPositionError,
+                                             maxOrientationError)
+                                     .c_str());
+
+            // Both paths compute the same quaternion products, up to floating point contraction.
+            Assert::AreEqual(0.f, maxPositionError, 1e-5f);
+            Assert::AreEqual(0.f, maxOrientationError, 1e-5f);
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
@@ -0,0 +1,178 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "hand_gestures.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr float JointRadius = 0.008f;
+
+        // An open hand, with all the finger tips far from the thumb and the palm.
+        void MakeOpenHand(BodyTracking::FingerJointState* joints) {
+            for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                joints[i] = {{{0.f, 0.f, 0.f, 1.f}, {0.f, 0.f, -0.2f}}, JointRadius, {}, {}};
+            }
+            joints[XR_HAND_JOINT_PALM_EXT].Pose.position = {0.f, 0.f, 0.f};
+            joints[XR_HAND_JOINT_THUMB_TIP_EXT].Pose.position = {0.1f, 0.f, 0.f};
+        }
+
+        // Place the index tip at the given distance (between the surfaces of the joints) from the thumb tip.
+        void SetPinchDistance(BodyTracking::FingerJointState* joints, float distance) {
+            const auto& thumb = joints[XR_HAND_JOINT_THUMB_TIP_EXT].Pose.position;
+            joints[XR_HAND_JOINT_INDEX_TIP_EXT].Pose.position = {
+                thumb.x, thumb.y + distance + 2 * JointRadius, thumb.z};
+        }
+
+    } // namespace
+
+    TEST_CLASS(HandGesturesTests) {
+        TEST_METHOD(LatchHysteresis) {
+            GestureLatch latch(0.9f, 0.7f);
+            Assert::IsFalse(latch.update(0.85f));
+            Assert::IsTrue(latch.update(0.95f));
+            Assert::IsTrue(latch.update(0.75f));
+            Assert::IsFalse(latch.update(0.65f));
+            Assert::IsFalse(latch.update(0.85f));
+            latch.update(0.95f);
+            latch.reset();
+            Assert::IsFalse(latch.isActive());
+        }
+
+        TEST_METHOD(PinchDoesNotFlickerOnNoisyData) {
+            // Approach the fingers, then hold them around the engage threshold with 1.5mm of tracking noise. The value
+            // crosses the engage threshold many times, but never the release threshold.
+            std::mt19937 rng(42);
+            std::uniform_real_distribution<float> noise(-0.0015f, 0.0015f);
+
+            BodyTracking::FingerJointState left[BodyTracking::HandJointCount];
+            BodyTracking::FingerJointState right[BodyTracking::HandJointCount];
+            MakeOpenHand(left);
+            MakeOpenHand(right);
+
+            HandGestureEngine engine;
+            uint64_t generation = 0;
+            uint32_t transitions = 0;
+            uint32_t thresholdCrossings = 0;
+            bool wasPinching = false;
+            bool wasAboveThreshold = false;
+            for (int i = 0; i < 400; i++) {
+                const float distance = i < 100 ? 0.03f - 0.0002f * i : 0.0125f + noise(rng);
+                SetPinchDistance(left, distance);
+                Assert::IsTrue(engine.update(++generation, true, left, true, right));
+
+                const HandGestures& gestures = engine.getGestures(xr::Side::Left);
+                if (gestures.isPinching != wasPinching) {
+                    transitions++;
+                    wasPinching = gestures.isPinching;
+                }
+                if ((gestures.pinchValue > 0.9f) != wasAboveThreshold) {
+                    thresholdCrossings++;
+                    wasAboveThreshold = gestures.pinchValue > 0.9f;
+                }
+                Assert::IsFalse(engine.getGestures(xr::Side::Right).isPinching);
+            }
+
+            Assert::IsTrue(wasPinching);
+            Assert::AreEqual(1u, transitions);
+            Assert::IsTrue(thresholdCrossings > 10);
+
+            // Open the hand.
+            SetPinchDistance(left, 0.02f);
+            engine.update(++generation, true, left, true, right);
+            Assert::IsFalse(engine.getGestures(xr::Side::Left).isPinching);
+        }
+
+        TEST_METHOD(OnlyAdvancesOnNewData) {
+            BodyTracking::FingerJointState left[BodyTracking::HandJointCount];
+            BodyTracking::FingerJointState right[BodyTracking::HandJointCount];
+            MakeOpenHand(left);
+            MakeOpenHand(right);
+            SetPinchDistance(left, 0.f);
+
+            HandGestureEngine engine;
+            Assert::IsTrue(engine.update(1, true, left, true, right));
+            Assert::IsTrue(engine.getGestures(xr::Side::Left).isPinching);
+
+            // Same generation: the gestures are not re-evaluated, even though the joints were modified.
+            SetPinchDistance(left, 0.1f);
+            Assert::IsFalse(engine.update(1, true, left, true, right));
+            Assert::IsTrue(engine.getGestures(xr::Side::Left).isPinching);
+
+            // Losing the hand resets its gestures.
+            Assert::IsTrue(engine.update(1, false, left, true, right));
+            Assert::IsFalse(engine.getGestures(xr::Side::Left).isPinching);
+            Assert::AreEqual(0.f, engine.getGestures(xr::Side::Left).pinchValue, 0.f);
+        }
+
+        TEST_METHOD(SystemGestureNeedsBothHands) {
+            BodyTracking::FingerJointState left[BodyTracking::HandJointCount];
+            BodyTracking::FingerJointState right[BodyTracking::HandJointCount];
+            MakeOpenHand(left);
+            MakeOpenHand(right);
+
+            // The right index tip touches the left palm.
+            right[XR_HAND_JOINT_INDEX_TIP_EXT].Pose.position = left[XR_HAND_JOINT_PALM_EXT].Pose.position;
+
+            HandGestureEngine engine;
+            engine.update(1, true, left, true, right);
+            Assert::IsTrue(engine.getGestures(xr::Side::Left).isSystemGesture);
+            Assert::IsFalse(engine.getGestures(xr::Side::Right).isSystemGesture);
+
+            engine.update(2, true, left, false, right);
+            Assert::IsFalse(engine.getGestures(xr::Side::Left).isSystemGesture);
+        }
+
+        TEST_METHOD(GrabAndPoint) {
+            BodyTracking::FingerJointState left[BodyTracking::HandJointCount];
+            BodyTracking::FingerJointState right[BodyTracking::HandJointCount];
+            MakeOpenHand(left);
+            MakeOpenHand(right);
+
+            // Middle, ring and little fingers curled into the palm, index extended.
+            for (const auto joint :
+                 {XR_HAND_JOINT_MIDDLE_TIP_EXT, XR_HAND_JOINT_RING_TIP_EXT, XR_HAND_JOINT_LITTLE_TIP_EXT}) {
+                left[joint].Pose.position = left[XR_HAND_JOINT_PALM_EXT].Pose.position;
+            }
+
+            HandGestureEngine engine;
+            engine.update(1, true, left, true, right);
+            Assert::IsTrue(engine.getGestures(xr::Side::Left).isGrabbing);
+            Assert::IsTrue(engine.getGestures(xr::Side::Left).isPointing);
+
+            // Index curled too: a fist is not pointing.
+            left[XR_HAND_JOINT_INDEX_TIP_EXT].Pose.position = left[XR_HAND_JOINT_PALM_EXT].Pose.position;
+            engine.update(2, true, left, true, right);
+            Assert::IsTrue(engine.getGestures(xr::Side::Left).isGrabbing);
+            Assert::IsFalse(engine.getGestures(xr::Side::Left).isPointing);
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
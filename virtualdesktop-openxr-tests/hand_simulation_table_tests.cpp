@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "pch.h"
+
+#include "hand_simulation_table.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        // The table is blended linearly between grid entries 0.1 curl apart. Positions are mostly relative to the
+        // parent bone, and rotations are a few degrees apart between neighboring entries.
+        constexpr float MaxPositionError = 0.002f;
+        constexpr float MaxAngleError = 2.f * float(M_PI) / 180.f;
+
+        struct Errors {
+            float position{0.f};
+            float angle{0.f};
+        };
+
+        void Simulate(MyHandSimulation& simulation,
+                      vr::ETrackedControllerRole role,
+                      uint32_t thumbState,
+                      float indexCurl,
+                      float gripCurl,
+                      vr::VRBoneTransform_t* bones) {
+            MyFingerCurls curls{};
+            curls.thumb = HandSimulationTable::getThumbCurl(thumbState);
+            curls.index = indexCurl;
+            curls.middle = curls.ring = curls.pinky = gripCurl;
+            simulation.ComputeSkeletonTransforms(role, curls, {}, bones);
+        }
+
+        void AccumulateErrors(const vr::VRBoneTransform_t* expected,
+                              const vr::VRBoneTransform_t* actual,
+                              Errors& errors) {
+            for (uint32_t i = 0; i < eBone_Count; i++) {
+                const float dx = expected[i].position.v[0] - actual[i].position.v[0];
+                const float dy = expected[i].position.v[1] - actual[i].position.v[1];
+                const float dz = expected[i].position.v[2] - actual[i].position.v[2];
+                errors.position = std::max(errors.position, std::sqrt(dx * dx + dy * dy + dz * dz));
+
+                const float cosHalfAngle = std::abs(expected[i].orientation.w * actual[i].orientation.w +
+                                                    expected[i].orientation.x * actual[i].orientation.x +
+                                                    expected[i].orientation.y * actual[i].orientation.y +
+                                                    expected[i].orientation.z * actual[i].orientation.z);
+                errors.angle = std::max(errors.angle, 2.f * std::acos(std::min(cosHalfAngle, 1.f)));
+            }
+        }
+
+    } // namespace
+
+    TEST_CLASS(HandSimulationTableTests) {
+        TEST_METHOD(OffGridSamples) {
+            for (const auto role : {vr::TrackedControllerRole_LeftHand, vr::TrackedControllerRole_RightHand}) {
+                MyHandSimulation simulation;
+                HandSimulationTable table;
+                table.build(simulation, role);
+                Assert::IsTrue(table.isBuilt());
+
+                std::mt19937 random(1234);
+                std::uniform_real_distribution<float> curl(0.f, 1.f);
+                Errors errors;
+                vr::VRBoneTransform_t expected[eBone_Count];
+                vr::VRBoneTransform_t actual[eBone_Count];
+                for (int i = 0; i < 2000; i++) {
+                    const uint32_t thumbState = i % HandSimulationTable::ThumbStates;
+                    const float indexCurl = curl(random);
+                    const float gripCurl = curl(random);
+                    Simulate(simulation, role, thumbState, indexCurl, gripCurl, expected);
+                    table.computeSkeletonTransforms(thumbState, indexCurl, gripCurl, actual);
+                    AccumulateErrors(expected, actual, errors);
+                }
+
+                Logger::WriteMessage(fmt::format("{} hand: max position error {:.3f} mm, max angle error {:.3f} deg\n",
+                                                 role == vr::TrackedControllerRole_LeftHand ? "Left" : "Right",
+                                                 errors.position * 1000.f,
+                                                 errors.angle * 180.f / float(M_PI))
+                                         .c_str());
+                Assert::IsTrue(errors.position < MaxPositionError);
+                Assert::IsTrue(errors.angle < MaxAngleError);
+            }
+        }
+
+        TEST_METHOD(GridSamplesAreExact) {
+            MyHandSimulation simulation;
+            HandSimulationTable table;
+            table.build(simulation, vr::TrackedControllerRole_LeftHand);
+
+            Errors errors;
+            vr::VRBoneTransform_t expected[eBone_Count];
+            vr::VRBoneTransform_t actual[eBone_Count];
+            for (uint32_t thumbState = 0; thumbState < HandSimulationTable::ThumbStates; thumbState++) {
+                for (uint32_t index = 0; index < HandSimulationTable::CurlSteps; index++) {
+                    for (uint32_t grip = 0; grip < HandSimulationTable::CurlSteps; grip++) {
+                        const float indexCurl = (float)index / (HandSimulationTable::CurlSteps - 1);
+                        const float gripCurl = (float)grip / (HandSimulationTable::CurlSteps - 1);
+                        Simulate(
+                            simulation, vr::TrackedControllerRole_LeftHand, thumbState, indexCurl, gripCurl, expected);
+                        table.computeSkeletonTransforms(thumbState, indexCurl, gripCurl, actual);
+                        AccumulateErrors(expected, actual, errors);
+                    }
+                }
+            }
+
+            Assert::AreEqual(0.f, errors.position, 1e-5f);
+            Assert::AreEqual(0.f, errors.angle, 1e-3f);
+        }
+
+        TEST_METHOD(CurlsAreClamped) {
+            MyHandSimulation simulation;
+            HandSimulationTable table;
+            table.build(simulation, vr::TrackedControllerRole_RightHand);
+
+            vr::VRBoneTransform_t expected[eBone_Count];
+            vr::VRBoneTransform_t actual[eBone_Count];
+            Errors errors;
+            table.computeSkeletonTransforms(1, -0.5f, 0.f, expected);
+            table.computeSkeletonTransforms(1, 0.f, -0.5f, actual);
+            AccumulateErrors(expected, actual, errors);
+            table.computeSkeletonTransforms(1, 1.f, 1.f, expected);
+            table.computeSkeletonTransforms(1, 1.5f, 2.f, actual);
+            AccumulateErrors(expected, actual, errors);
+
+            Assert::AreEqual(0.f, errors.position);
+            Assert::AreEqual(0.f, errors.angle);
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
@@ -0,0 +1,185 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "hand_velocity_estimator.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr double Rate = 90.0;
+
+        // All the joints of the left hand translating at a constant speed along X, while rotating at a constant speed
+        // around Y.
+        void SetAnalyticMotion(BodyTracking::BodyStateV2& state, double time, float speed, float angularSpeed) {
+            state.LeftHandActive = true;
+            const float angle = angularSpeed * (float)time;
+            for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                auto& joint = state.LeftHandJointStates[i];
+                joint.Pose.orientation = {0.f, std::sin(angle / 2.f), 0.f, std::cos(angle / 2.f)};
+                joint.Pose.position = {speed * (float)time, 1.f + 0.01f * i, -0.3f};
+                joint.AngularVelocity = joint.LinearVelocity = {};
+            }
+        }
+
+    } // namespace
+
+    TEST_CLASS(HandVelocityEstimatorTests) {
+        TEST_METHOD(AnalyticMotion) {
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            HandVelocityEstimator estimator;
+
+            for (int i = 0; i < 10; i++) {
+                const double time = 10.0 + i / Rate;
+                SetAnalyticMotion(*state, time, 0.5f, 2.f);
+                estimator.apply(*state, time);
+                if (i == 0) {
+                    // Nothing to differentiate yet.
+                    Assert::AreEqual(0.f, state->LeftHandJointStates[0].LinearVelocity.x, 0.f);
+                    continue;
+                }
+
+                for (uint32_t j = 0; j < BodyTracking::HandJointCount; j++) {
+                    const auto& joint = state->LeftHandJointStates[j];
+                    Assert::AreEqual(0.5f, joint.LinearVelocity.x, 1e-3f);
+                    Assert::AreEqual(0.f, joint.LinearVelocity.y, 1e-3f);
+                    Assert::AreEqual(0.f, joint.LinearVelocity.z, 1e-3f);
+                    Assert::AreEqual(0.f, joint.AngularVelocity.x, 1e-3f);
+                    Assert::AreEqual(2.f, joint.AngularVelocity.y, 1e-2f);
+                    Assert::AreEqual(0.f, joint.AngularVelocity.z, 1e-3f);
+                }
+                Assert::IsFalse(state->RightHandActive);
+                Assert::AreEqual(0.f, state->RightHandJointStates[0].LinearVelocity.x, 0.f);
+            }
+        }
+
+        TEST_METHOD(ReverseRotation) {
+            // Crossing the quaternion double cover must not flip the angular velocity.
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            HandVelocityEstimator estimator;
+            for (int i = 0; i < 5; i++) {
+                const double time = 1.0 + i / Rate;
+                SetAnalyticMotion(*state, time, 0.f, -2.f);
+                for (auto& joint : state->LeftHandJointStates) {
+                    if (i % 2) {
+                        auto& q = joint.Pose.orientation;
+                        q = {-q.x, -q.y, -q.z, -q.w};
+                    }
+                }
+                estimator.apply(*state, time);
+            }
+            Assert::AreEqual(-2.f, state->LeftHandJointStates[0].AngularVelocity.y, 1e-2f);
+        }
+
+        TEST_METHOD(StaleEstimateIsDropped) {
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            HandVelocityEstimator estimator;
+            double time = 1.0;
+            for (int i = 0; i < 5; i++) {
+                time = 1.0 + i / Rate;
+                SetAnalyticMotion(*state, time, 0.5f, 0.f);
+                estimator.apply(*state, time);
+            }
+            Assert::AreEqual(0.5f, state->LeftHandJointStates[0].LinearVelocity.x, 1e-3f);
+
+            // The hand does not move while other sections of the body state are updated: the estimate is kept for a
+            // short while, then dropped.
+            const double stopTime = time;
+            for (int i = 1; i < 20; i++) {
+                time = stopTime + i / Rate;
+                SetAnalyticMotion(*state, stopTime, 0.5f, 0.f);
+                estimator.apply(*state, time);
+                const float expected = time - stopTime > HandVelocityEstimator::MaxInterval ? 0.f : 0.5f;
+                Assert::AreEqual(expected, state->LeftHandJointStates[0].LinearVelocity.x, 1e-3f);
+            }
+
+            // Moving again after a long pause starts a new estimate.
+            time += 1 / Rate;
+            SetAnalyticMotion(*state, stopTime + 1 / Rate, 0.5f, 0.f);
+            estimator.apply(*state, time);
+            Assert::AreEqual(0.f, state->LeftHandJointStates[0].LinearVelocity.x, 0.f);
+            time += 1 / Rate;
+            SetAnalyticMotion(*state, stopTime + 2 / Rate, 0.5f, 0.f);
+            estimator.apply(*state, time);
+            Assert::AreEqual(0.5f, state->LeftHandJointStates[0].LinearVelocity.x, 1e-3f);
+        }
+
+        TEST_METHOD(SilentProducerExpiresEstimate) {
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            HandVelocityEstimator estimator;
+            double time = 1.0;
+            for (int i = 0; i < 5; i++) {
+                time = 1.0 + i / Rate;
+                SetAnalyticMotion(*state, time, 0.5f, 2.f);
+                estimator.apply(*state, time);
+            }
+            Assert::AreEqual(0.5f, state->LeftHandJointStates[0].LinearVelocity.x, 1e-3f);
+
+            // The producer goes silent: apply() is no longer called, only expire() as the watcher times out.
+            const double lastTime = time;
+            Assert::IsFalse(estimator.expire(*state, lastTime + HandVelocityEstimator::MaxInterval / 2));
+            Assert::AreEqual(0.5f, state->LeftHandJointStates[0].LinearVelocity.x, 1e-3f);
+            Assert::AreEqual(2.f, state->LeftHandJointStates[0].AngularVelocity.y, 1e-2f);
+
+            Assert::IsTrue(estimator.expire(*state, lastTime + HandVelocityEstimator::MaxInterval * 2));
+            for (uint32_t j = 0; j < BodyTracking::HandJointCount; j++) {
+                const auto& joint = state->LeftHandJointStates[j];
+                Assert::AreEqual(0.f, joint.LinearVelocity.x, 0.f);
+                Assert::AreEqual(0.f, joint.AngularVelocity.y, 0.f);
+            }
+
+            // Nothing left to expire.
+            Assert::IsFalse(estimator.expire(*state, lastTime + HandVelocityEstimator::MaxInterval * 3));
+
+            // The producer resumes: a new estimate starts.
+            time = lastTime + 1.0;
+            SetAnalyticMotion(*state, time, 0.5f, 2.f);
+            estimator.apply(*state, time);
+            Assert::AreEqual(0.f, state->LeftHandJointStates[0].LinearVelocity.x, 0.f);
+            time += 1 / Rate;
+            SetAnalyticMotion(*state, time, 0.5f, 2.f);
+            estimator.apply(*state, time);
+            Assert::AreEqual(0.5f, state->LeftHandJointStates[0].LinearVelocity.x, 1e-3f);
+        }
+
+        TEST_METHOD(ProducerVelocitiesAreKept) {
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            HandVelocityEstimator estimator;
+            for (int i = 0; i < 3; i++) {
+                const double time = 1.0 + i / Rate;
+                SetAnalyticMotion(*state, time, 0.5f, 0.f);
+                state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].LinearVelocity = {0.f, 0.f, 1.f};
+                estimator.apply(*state, time);
+            }
+            Assert::AreEqual(0.f, state->LeftHandJointStates[XR_HAND_JOINT_PALM_EXT].LinearVelocity.x, 0.f);
+            Assert::AreEqual(1.f, state->LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].LinearVelocity.z, 0.f);
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
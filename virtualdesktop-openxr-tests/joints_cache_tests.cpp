@@ -0,0 +1,189 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "pch.h"
+
+#include "body_state_buffer.h"
+#include "joints_cache.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        const XrSpace LocalSpace = (XrSpace)0x1000;
+        const XrSpace StageSpace = (XrSpace)0x2000;
+
+        constexpr XrSpaceLocationFlags TrackedFlags =
+            XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT |
+            XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+
+        HandJointsCacheKey MakeKey(XrTime time,
+                                   XrSpace baseSpace,
+                                   uint64_t generation,
+                                   XrSpaceLocationFlags baseSpaceFlags = TrackedFlags,
+                                   XrPosef baseSpacePose = {{0.f, 0.f, 0.f, 1.f}, {0.f, 0.f, 0.f}}) {
+            return {time, baseSpace, baseSpaceFlags, baseSpacePose, generation};
+        }
+
+        // Store joints that can be told apart by their first position.
+        void StoreJoints(HandJointsCache& cache, const HandJointsCacheKey& key, float marker, bool withVelocities) {
+            HandJointsCache::Entry& entry = cache.store(key);
+            for (uint32_t i = 0; i < XR_HAND_JOINT_COUNT_EXT; i++) {
+                entry.jointLocations[i].pose.position = {marker, (float)i, 0.f};
+            }
+            entry.hasVelocities = withVelocities;
+            entry.hasAimState = false;
+        }
+
+        void MoveLeftHand(BodyTracking::BodyStateV2& state, float x) {
+            state.LeftHandActive = true;
+            state.LeftHandJointStates[XR_HAND_JOINT_WRIST_EXT].Pose.position.x = x;
+        }
+
+    } // namespace
+
+    TEST_CLASS(JointsCacheTests) {
+        TEST_METHOD(RepeatedQueriesHit) {
+            HandJointsCache cache;
+            const HandJointsCacheKey key = MakeKey(1000, LocalSpace, 3);
+
+            Assert::IsNull(cache.lookup(key, false, false));
+            StoreJoints(cache, key, 1.f, false);
+
+            for (int i = 0; i < 5; i++) {
+                const HandJointsCache::Entry* cached = cache.lookup(key, false, false);
+                Assert::IsNotNull(cached);
+                Assert::AreEqual(1.f, cached->jointLocations[0].pose.position.x);
+            }
+            Assert::AreEqual((uint64_t)5, cache.hits());
+            Assert::AreEqual((uint64_t)1, cache.misses());
+        }
+
+        TEST_METHOD(DifferentTimeOrBaseSpaceMisses) {
+            HandJointsCache cache;
+            StoreJoints(cache, MakeKey(1000, LocalSpace, 3), 1.f, false);
+
+            Assert::IsNull(cache.lookup(MakeKey(1001, LocalSpace, 3), false, false));
+            Assert::IsNull(cache.lookup(MakeKey(1000, StageSpace, 3), false, false));
+            Assert::IsNotNull(cache.lookup(MakeKey(1000, LocalSpace, 3), false, false));
+
+            // A new query replaces the cached one.
+            StoreJoints(cache, MakeKey(1000, StageSpace, 3), 2.f, false);
+            Assert::IsNull(cache.lookup(MakeKey(1000, LocalSpace, 3), false, false));
+            const HandJointsCache::Entry* cached = cache.lookup(MakeKey(1000, StageSpace, 3), false, false);
+            Assert::IsNotNull(cached);
+            Assert::AreEqual(2.f, cached->jointLocations[0].pose.position.x);
+        }
+
+        TEST_METHOD(BaseSpaceLocatedDifferentlyMisses) {
+            HandJointsCache cache;
+            StoreJoints(cache, MakeKey(1000, LocalSpace, 3), 1.f, false);
+
+            // The base space lost tracking, or became invalid, since the joints were cached.
+            Assert::IsNull(cache.lookup(MakeKey(1000,
+                                                LocalSpace,
+                                                3,
+                                                XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+                                                    XR_SPACE_LOCATION_POSITION_VALID_BIT),
+                                        false,
+                                        false));
+            Assert::IsNull(cache.lookup(MakeKey(1000, LocalSpace, 3, 0), false, false));
+
+            // The base space was relocated.
+            Assert::IsNull(cache.lookup(
+                MakeKey(1000, LocalSpace, 3, TrackedFlags, {{0.f, 0.f, 0.f, 1.f}, {0.f, 0.f, 0.001f}}), false, false));
+
+            Assert::IsNotNull(cache.lookup(MakeKey(1000, LocalSpace, 3), false, false));
+        }
+
+        TEST_METHOD(NewGenerationMisses) {
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            BodyStateBuffer buffer;
+            HandJointsCache cache;
+
+            MoveLeftHand(*state, 0.1f);
+            buffer.publish(*state, 1.0);
+            StoreJoints(cache, MakeKey(1000, LocalSpace, buffer.generation()), 1.f, false);
+            Assert::IsNotNull(cache.lookup(MakeKey(1000, LocalSpace, buffer.generation()), false, false));
+
+            // Publishing an identical state does not create a new generation.
+            buffer.publish(*state, 1.01);
+            Assert::IsNotNull(cache.lookup(MakeKey(1000, LocalSpace, buffer.generation()), false, false));
+
+            // Any new body state does, even for a query at the same time and in the same base space.
+            MoveLeftHand(*state, 0.2f);
+            buffer.publish(*state, 1.02);
+            Assert::IsNull(cache.lookup(MakeKey(1000, LocalSpace, buffer.generation()), false, false));
+        }
+
+        TEST_METHOD(QueriesForMoreDataMiss) {
+            HandJointsCache cache;
+            const HandJointsCacheKey key = MakeKey(1000, LocalSpace, 3);
+            StoreJoints(cache, key, 1.f, false);
+
+            Assert::IsNull(cache.lookup(key, true, false));
+            Assert::IsNull(cache.lookup(key, false, true));
+
+            StoreJoints(cache, key, 1.f, true);
+            Assert::IsNotNull(cache.lookup(key, true, false));
+            Assert::IsNotNull(cache.lookup(key, false, false));
+        }
+
+        TEST_METHOD(SkeletonFollowsChangedCount) {
+            auto state = std::make_unique<BodyTracking::BodyStateV2>();
+            BodyStateBuffer buffer;
+            BodySkeletonCache cache;
+
+            auto readChangedCount = [&] {
+                int32_t skeletonChangedCount;
+                buffer.read([&](const BodyTracking::BodyStateV2& snapshot) {
+                    skeletonChangedCount = snapshot.SkeletonChangedCount;
+                });
+                return skeletonChangedCount;
+            };
+
+            // Nothing is cached initially, not even for a zero counter.
+            state->SkeletonChangedCount = 0;
+            buffer.publish(*state, 1.0);
+            Assert::IsFalse(cache.isCurrent(readChangedCount()));
+            cache.store(readChangedCount())[0].parentJoint = 7;
+            Assert::IsTrue(cache.isCurrent(readChangedCount()));
+
+            // Other sections changing do not invalidate the skeleton.
+            MoveLeftHand(*state, 0.3f);
+            buffer.publish(*state, 1.01);
+            Assert::IsTrue(cache.isCurrent(readChangedCount()));
+            Assert::AreEqual(7, (int)cache.joints()[0].parentJoint);
+
+            state->SkeletonChangedCount = 1;
+            buffer.publish(*state, 1.02);
+            Assert::IsFalse(cache.isCurrent(readChangedCount()));
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
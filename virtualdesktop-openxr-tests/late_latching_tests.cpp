@@ -0,0 +1,217 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "async_submission_queue.h"
+#include "late_latching.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+    using namespace xr::math;
+
+    namespace {
+
+        constexpr double Rate = 90.0;
+        constexpr float Pi = 3.14159265f;
+
+        XrPosef MakeYawPose(float yaw, const XrVector3f& position) {
+            return Pose::MakePose({0.f, std::sin(yaw / 2.f), 0.f, std::cos(yaw / 2.f)}, position);
+        }
+
+        float GetAngle(const XrQuaternionf& q1, const XrQuaternionf& q2) {
+            const float dot = std::abs(q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w);
+            return 2.f * std::acos(std::min(dot, 1.f));
+        }
+
+        float GetDistance(const XrVector3f& p1, const XrVector3f& p2) {
+            return std::sqrt((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y) +
+                             (p2.z - p1.z) * (p2.z - p1.z));
+        }
+
+        // A controller held at arm's length and swinging around the shoulder, with the constant velocity prediction
+        // done by LibOVR when a pose is queried ahead of time.
+        struct SwingingController {
+            float amplitude{Pi / 3.f}; // radians
+            float frequency{1.f};      // Hz
+            float armLength{0.5f};     // meters
+
+            float getYaw(double time) const {
+                return amplitude * std::sin(2.f * Pi * frequency * (float)time);
+            }
+
+            float getYawRate(double time) const {
+                return amplitude * 2.f * Pi * frequency * std::cos(2.f * Pi * frequency * (float)time);
+            }
+
+            XrVector3f getPosition(float yaw) const {
+                return {-armLength * std::sin(yaw), 1.2f, -armLength * std::cos(yaw)};
+            }
+
+            XrPosef getPose(double time) const {
+                return MakeYawPose(getYaw(time), getPosition(getYaw(time)));
+            }
+
+            // The pose predicted for targetTime, from the state of the controller at sampleTime.
+            XrPosef predict(double sampleTime, double targetTime) const {
+                const float dt = (float)(targetTime - sampleTime);
+                const float yaw = getYaw(sampleTime);
+                const float yawRate = getYawRate(sampleTime);
+                const XrVector3f position = getPosition(yaw);
+                const XrVector3f linearVelocity = {-armLength * std::cos(yaw) * yawRate,
+                                                   0.f,
+                                                   armLength * std::sin(yaw) * yawRate};
+                return MakeYawPose(yaw + yawRate * dt,
+                                   {position.x + linearVelocity.x * dt,
+                                    position.y + linearVelocity.y * dt,
+                                    position.z + linearVelocity.z * dt});
+            }
+        };
+
+        struct ModelError {
+            float meanAngle{0.f};
+            float meanDistance{0.f};
+            uint32_t numRejected{0};
+        };
+
+        // Simulate one second of frames of a quad held in front of the controller. The runtime samples the controller
+        // in xrEndFrame(), depth frames before the submission thread picks up the frame, and the submission thread
+        // late-latches one frame period before display.
+        ModelError RunModel(const SwingingController& controller, uint32_t depth, bool useLateLatching) {
+            const XrPosef quadInController = Pose::Translation({0.f, 0.05f, -0.1f});
+            const LateLatchingEnvelope envelope{15.f * Pi / 180.f, 0.1f};
+
+            ModelError error;
+            constexpr uint32_t FrameCount = (uint32_t)Rate;
+            for (uint32_t i = 0; i < FrameCount; i++) {
+                const double displayTime = 10.0 + i / Rate;
+                const double submitTime = displayTime - 1 / Rate;
+                const double endFrameTime = submitTime - depth / Rate;
+
+                const XrPosef devicePose = controller.predict(endFrameTime, displayTime);
+                XrPosef quadPose = Pose::Multiply(quadInController, devicePose);
+                if (useLateLatching) {
+                    XrPosef correction;
+                    float angle, distance;
+                    if (GetLateLatchingCorrection(devicePose,
+                                                  controller.predict(submitTime, displayTime),
+                                                  envelope,
+                                                  correction,
+                                                  angle,
+                                                  distance)) {
+                        quadPose = Pose::Multiply(quadPose, correction);
+                    } else {
+                        error.numRejected++;
+                    }
+                }
+
+                const XrPosef actualQuadPose = Pose::Multiply(quadInController, controller.getPose(displayTime));
+                error.meanAngle += GetAngle(quadPose.orientation, actualQuadPose.orientation) / FrameCount;
+                error.meanDistance += GetDistance(quadPose.position, actualQuadPose.position) / FrameCount;
+            }
+            return error;
+        }
+
+    } // namespace
+
+    TEST_CLASS(LateLatchingTests) {
+        TEST_METHOD(CorrectionFollowsTheController) {
+            const XrPosef quadInController = MakeYawPose(0.3f, {0.f, 0.05f, -0.1f});
+            const XrPosef previousDevicePose = MakeYawPose(0.1f, {0.2f, 1.2f, -0.4f});
+            const XrPosef latestDevicePose = MakeYawPose(0.15f, {0.21f, 1.19f, -0.4f});
+
+            XrPosef correction;
+            float angle, distance;
+            Assert::IsTrue(GetLateLatchingCorrection(
+                previousDevicePose, latestDevicePose, {0.1f, 0.1f}, correction, angle, distance));
+            Assert::AreEqual(0.05f, angle, 1e-4f);
+            Assert::AreEqual(std::sqrt(2.f) * 0.01f, distance, 1e-5f);
+
+            // Moving the layer by the correction is the same as placing it relative to the latest pose.
+            const XrPosef corrected = Pose::Multiply(Pose::Multiply(quadInController, previousDevicePose), correction);
+            const XrPosef expected = Pose::Multiply(quadInController, latestDevicePose);
+            Assert::AreEqual(0.f, GetAngle(corrected.orientation, expected.orientation), 1e-3f);
+            Assert::AreEqual(0.f, GetDistance(corrected.position, expected.position), 1e-5f);
+        }
+
+        TEST_METHOD(OutsideEnvelopeIsRejected) {
+            const XrPosef previousDevicePose = MakeYawPose(0.f, {0.f, 1.2f, -0.4f});
+            const LateLatchingEnvelope envelope{0.1f, 0.05f};
+
+            XrPosef correction;
+            float angle, distance;
+            Assert::IsFalse(GetLateLatchingCorrection(
+                previousDevicePose, MakeYawPose(0.2f, {0.f, 1.2f, -0.4f}), envelope, correction, angle, distance));
+            Assert::AreEqual(0.2f, angle, 1e-4f);
+            Assert::AreEqual(0.f, GetAngle(correction.orientation, Pose::Identity().orientation), 1e-3f);
+
+            Assert::IsFalse(GetLateLatchingCorrection(
+                previousDevicePose, MakeYawPose(0.f, {0.f, 1.2f, -0.3f}), envelope, correction, angle, distance));
+            Assert::AreEqual(0.1f, distance, 1e-5f);
+            Assert::AreEqual(0.f, GetDistance(correction.position, Pose::Identity().position), 0.f);
+
+            // Quaternions q and -q are the same rotation.
+            XrPosef flipped = previousDevicePose;
+            flipped.orientation = {-flipped.orientation.x,
+                                   -flipped.orientation.y,
+                                   -flipped.orientation.z,
+                                   -flipped.orientation.w};
+            Assert::IsTrue(
+                GetLateLatchingCorrection(previousDevicePose, flipped, envelope, correction, angle, distance));
+            Assert::AreEqual(0.f, angle, 1e-3f);
+        }
+
+        TEST_METHOD(SwingingControllerModel) {
+            // A controller swinging at 1Hz by +/-60 degrees, the fastest motion expected for a layer held in hand. The
+            // late-latched layer only carries the prediction error over one frame period, regardless of the depth of
+            // the submission queue.
+            const SwingingController controller;
+            std::optional<ModelError> lateLatchedError;
+            for (uint32_t depth = 1; depth <= AsyncSubmissionQueue::MaxDepth; depth++) {
+                const ModelError error = RunModel(controller, depth, false);
+                const ModelError latchedError = RunModel(controller, depth, true);
+                Logger::WriteMessage(fmt::format("Depth {}: mean error {:.2f}deg/{:.1f}mm, late-latched "
+                                                 "{:.2f}deg/{:.1f}mm ({} rejected)\n",
+                                                 depth,
+                                                 error.meanAngle * 180.f / Pi,
+                                                 error.meanDistance * 1e3f,
+                                                 latchedError.meanAngle * 180.f / Pi,
+                                                 latchedError.meanDistance * 1e3f,
+                                                 latchedError.numRejected)
+                                         .c_str());
+
+                Assert::AreEqual(0u, latchedError.numRejected);
+                Assert::IsTrue(latchedError.meanAngle < 0.5f * error.meanAngle);
+                Assert::IsTrue(latchedError.meanDistance < 0.5f * error.meanDistance);
+                if (lateLatchedError) {
+                    Assert::AreEqual(lateLatchedError->meanAngle, latchedError.meanAngle, 1e-4f);
+                    Assert::AreEqual(lateLatchedError->meanDistance, latchedError.meanDistance, 1e-5f);
+                }
+                lateLatchedError = latchedError;
+            }
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
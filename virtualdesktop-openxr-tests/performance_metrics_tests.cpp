@@ -0,0 +1,202 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "performance_metrics.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr XrFlags64 FloatValid =
+            XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META |
+            XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META;
+        constexpr XrFlags64 UintValid =
+            XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META |
+            XR_PERFORMANCE_METRICS_COUNTER_UINT_VALUE_VALID_BIT_META;
+
+        ovrPerfStats MakePerfStats(int dropped, bool isAswActive) {
+            ovrPerfStats stats{};
+            stats.FrameStatsCount = 2;
+            stats.FrameStats[0].AppMotionToPhotonLatency = 0.025f;
+            stats.FrameStats[0].CompositorCpuElapsedTime = 0.0005f;
+            stats.FrameStats[0].CompositorGpuElapsedTime = 0.0012f;
+            stats.FrameStats[0].CompositorDroppedFrameCount = dropped;
+            stats.FrameStats[0].AswIsActive = isAswActive;
+
+            // Older statistics must be ignored.
+            stats.FrameStats[1].AppMotionToPhotonLatency = 1.f;
+            stats.FrameStats[1].CompositorDroppedFrameCount = 1000;
+            return stats;
+        }
+
+        XrPerformanceMetricsCounterMETA Read(const PerformanceMetricsBuffer& buffer,
+                                             PerformanceMetricsCounter counter) {
+            XrPerformanceMetricsCounterMETA value{XR_TYPE_PERFORMANCE_METRICS_COUNTER_META};
+            buffer.read(counter, value);
+            return value;
+        }
+
+    } // namespace
+
+    TEST_CLASS(PerformanceMetricsTests) {
+        TEST_METHOD(SampleFromPerfStats) {
+            const PerformanceMetricsSnapshot snapshot = SamplePerformanceMetrics(MakePerfStats(3, true), 4500, 6200);
+
+            for (uint32_t i = 0; i < (uint32_t)PerformanceMetricsCounter::Count; i++) {
+                Assert::IsTrue(snapshot.isValid[i]);
+            }
+            Assert::AreEqual(4.5f, snapshot.floatValues[(uint32_t)PerformanceMetricsCounter::AppCpuFrameTime], 1e-5f);
+            Assert::AreEqual(6.2f, snapshot.floatValues[(uint32_t)PerformanceMetricsCounter::AppGpuFrameTime], 1e-5f);
+            Assert::AreEqual(
+                25.f, snapshot.floatValues[(uint32_t)PerformanceMetricsCounter::AppMotionToPhotonLatency], 1e-4f);
+            Assert::AreEqual(
+                0.5f, snapshot.floatValues[(uint32_t)PerformanceMetricsCounter::CompositorCpuFrameTime], 1e-5f);
+            Assert::AreEqual(
+                1.2f, snapshot.floatValues[(uint32_t)PerformanceMetricsCounter::CompositorGpuFrameTime], 1e-5f);
+            Assert::AreEqual(3u, snapshot.uintValues[(uint32_t)PerformanceMetricsCounter::CompositorDroppedFrameCount]);
+            Assert::AreEqual(1u, snapshot.uintValues[(uint32_t)PerformanceMetricsCounter::CompositorSpacewarpMode]);
+        }
+
+        TEST_METHOD(SampleWithoutGpuTimerOrCompositorStats) {
+            const PerformanceMetricsSnapshot snapshot = SamplePerformanceMetrics(ovrPerfStats{}, 4500, {});
+
+            Assert::IsTrue(snapshot.isValid[(uint32_t)PerformanceMetricsCounter::AppCpuFrameTime]);
+            for (uint32_t i = (uint32_t)PerformanceMetricsCounter::AppGpuFrameTime;
+                 i < (uint32_t)PerformanceMetricsCounter::Count;
+                 i++) {
+                Assert::IsFalse(snapshot.isValid[i]);
+            }
+        }
+
+        TEST_METHOD(NegativeDroppedFrameCountIsClamped) {
+            const PerformanceMetricsSnapshot snapshot = SamplePerformanceMetrics(MakePerfStats(-1, false), 0, 0);
+            Assert::AreEqual(0u, snapshot.uintValues[(uint32_t)PerformanceMetricsCounter::CompositorDroppedFrameCount]);
+            Assert::AreEqual(0u, snapshot.uintValues[(uint32_t)PerformanceMetricsCounter::CompositorSpacewarpMode]);
+        }
+
+        TEST_METHOD(CountersArePackedWithTheirValidity) {
+            PerformanceMetricsBuffer buffer;
+
+            // Nothing published yet.
+            for (uint32_t i = 0; i < (uint32_t)PerformanceMetricsCounter::Count; i++) {
+                const auto value = Read(buffer, (PerformanceMetricsCounter)i);
+                Assert::AreEqual((XrFlags64)0, value.counterFlags);
+                Assert::IsTrue(value.counterUnit == PerformanceMetricsCounters[i].unit);
+            }
+
+            buffer.publish(SamplePerformanceMetrics(MakePerfStats(3, true), 4500, {}));
+
+            auto value = Read(buffer, PerformanceMetricsCounter::AppCpuFrameTime);
+            Assert::AreEqual(FloatValid, value.counterFlags);
+            Assert::IsTrue(value.counterUnit == XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META);
+            Assert::AreEqual(4.5f, value.floatValue, 1e-5f);
+            Assert::AreEqual(0u, value.uintValue);
+
+            // A missing counter must not be reported with a stale or zero value.
+            value = Read(buffer, PerformanceMetricsCounter::AppGpuFrameTime);
+            Assert::AreEqual((XrFlags64)0, value.counterFlags);
+
+            value = Read(buffer, PerformanceMetricsCounter::CompositorDroppedFrameCount);
+            Assert::AreEqual(UintValid, value.counterFlags);
+            Assert::IsTrue(value.counterUnit == XR_PERFORMANCE_METRICS_COUNTER_UNIT_GENERIC_META);
+            Assert::AreEqual(3u, value.uintValue);
+            Assert::AreEqual(0.f, value.floatValue);
+
+            buffer.reset();
+            value = Read(buffer, PerformanceMetricsCounter::AppCpuFrameTime);
+            Assert::AreEqual((XrFlags64)0, value.counterFlags);
+        }
+
+        TEST_METHOD(ValidityDoesNotDependOnTheValue) {
+            // Valid zeros and all-ones bit patterns must be distinguishable from an invalid counter.
+            PerformanceMetricsSnapshot snapshot;
+            snapshot.set(PerformanceMetricsCounter::AppCpuFrameTime, 0.f);
+            snapshot.set(PerformanceMetricsCounter::AppGpuFrameTime, -0.f);
+            snapshot.set(PerformanceMetricsCounter::CompositorDroppedFrameCount, 0u);
+            snapshot.set(PerformanceMetricsCounter::CompositorSpacewarpMode, UINT32_MAX);
+
+            PerformanceMetricsBuffer buffer;
+            buffer.publish(snapshot);
+
+            Assert::AreEqual(FloatValid, Read(buffer, PerformanceMetricsCounter::AppCpuFrameTime).counterFlags);
+            const auto negativeZero = Read(buffer, PerformanceMetricsCounter::AppGpuFrameTime);
+            Assert::AreEqual(FloatValid, negativeZero.counterFlags);
+            Assert::IsTrue(std::signbit(negativeZero.floatValue));
+            Assert::AreEqual(UintValid,
+                             Read(buffer, PerformanceMetricsCounter::CompositorDroppedFrameCount).counterFlags);
+            const auto allOnes = Read(buffer, PerformanceMetricsCounter::CompositorSpacewarpMode);
+            Assert::AreEqual(UintValid, allOnes.counterFlags);
+            Assert::AreEqual(UINT32_MAX, allOnes.uintValue);
+            Assert::AreEqual((XrFlags64)0,
+                             Read(buffer, PerformanceMetricsCounter::AppMotionToPhotonLatency).counterFlags);
+        }
+
+        TEST_METHOD(ConcurrentReadsAreNeverTorn) {
+            // The frame thread alternates between two snapshots with different validity: a reader must always observe
+            // one of them, never the value of one with the validity of the other.
+            PerformanceMetricsSnapshot withGpu = SamplePerformanceMetrics(ovrPerfStats{}, 1000, 2000);
+            PerformanceMetricsSnapshot withoutGpu = SamplePerformanceMetrics(ovrPerfStats{}, 3000, {});
+            withoutGpu.floatValues[(uint32_t)PerformanceMetricsCounter::AppGpuFrameTime] = 5.f;
+
+            PerformanceMetricsBuffer buffer;
+            buffer.publish(withGpu);
+
+            std::atomic<bool> stop{false};
+            std::atomic<uint32_t> numPublished{0};
+            std::thread writer([&] {
+                for (uint32_t i = 0; !stop; i++) {
+                    buffer.publish(i % 2 ? withGpu : withoutGpu);
+                    numPublished.store(i + 1, std::memory_order_relaxed);
+                }
+            });
+            while (numPublished.load(std::memory_order_relaxed) < 2) {
+                std::this_thread::yield();
+            }
+
+            uint32_t numTorn = 0;
+            uint32_t numValid = 0;
+            for (uint32_t i = 0; i < 1000000; i++) {
+                const auto value = Read(buffer, PerformanceMetricsCounter::AppGpuFrameTime);
+                if (value.counterFlags) {
+                    numValid++;
+                    if (value.floatValue != 2.f) {
+                        numTorn++;
+                    }
+                } else if (value.floatValue != 0.f) {
+                    numTorn++;
+                }
+            }
+            stop = true;
+            writer.join();
+
+            Assert::AreEqual(0u, numTorn);
+            Logger::WriteMessage(fmt::format("{} valid reads out of 1000000\n", numValid).c_str());
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
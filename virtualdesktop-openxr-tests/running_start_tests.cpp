@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "running_start.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace virtualdesktop_openxr::utils;
+
+    namespace {
+
+        constexpr double FrameDuration = 1 / 90.0;
+
+        // An application whose frame time follows a normal distribution. It wakes up the running start before the
+        // compositor's slot opens, so its submission lands appFrameTime - runningStart into the slot.
+        struct SimulatedApplication {
+            SimulatedApplication(double mean, double deviation) : frameTime(mean, deviation) {
+            }
+
+            bool runFrame(RunningStartController& controller) {
+                const double appFrameTime = std::max(frameTime(rng), 0.0);
+                return controller.update(appFrameTime, appFrameTime - controller.getRunningStart(), FrameDuration);
+            }
+
+            std::mt19937 rng{42};
+            std::normal_distribution<double> frameTime;
+        };
+
+    } // namespace
+
+    TEST_CLASS(RunningStartTests) {
+        TEST_METHOD(FixedRunningStart) {
+            RunningStartController controller;
+            controller.configure(false, 0.0, 0.010);
+            Assert::AreEqual(RunningStartController::DefaultRunningStart, controller.getRunningStart());
+
+            Assert::IsFalse(controller.update(0.012, 0.010, FrameDuration));
+            Assert::IsTrue(controller.update(0.014, 0.012, FrameDuration));
+            Assert::AreEqual(RunningStartController::DefaultRunningStart, controller.getRunningStart());
+            Assert::AreEqual(2ull, (unsigned long long)controller.getNumFrames());
+            Assert::AreEqual(1ull, (unsigned long long)controller.getNumMissedFrames());
+        }
+
+        TEST_METHOD(LightApplicationShrinksToMinimum) {
+            RunningStartController controller;
+            controller.configure(true, 0.0005, 0.010);
+            SimulatedApplication application(0.004, 0.0005);
+            for (int i = 0; i < 900; i++) {
+                Assert::IsFalse(application.runFrame(controller));
+            }
+            Assert::AreEqual(0.0005, controller.getRunningStart(), 1e-5);
+        }
+
+        TEST_METHOD(HeavyApplicationConverges) {
+            // 12ms +/- 0.3ms does not fit in a 11.1ms slot without a running start of about 2.3ms (3 deviations and
+            // the guard included).
+            RunningStartController controller;
+            controller.configure(true, 0.0, 0.010);
+            SimulatedApplication application(0.012, 0.0003);
+            for (int i = 0; i < 900; i++) {
+                application.runFrame(controller);
+            }
+
+            const uint64_t missedBefore = controller.getNumMissedFrames();
+            for (int i = 0; i < 9000; i++) {
+                application.runFrame(controller);
+            }
+            const double missRate = (double)(controller.getNumMissedFrames() - missedBefore) / 9000;
+            const double expected = 0.012 + RunningStartController::Deviations * 0.0003 - FrameDuration +
+                                    RunningStartController::Guard;
+            Logger::WriteMessage(fmt::format("Running start: {:.2f}ms (expected {:.2f}ms), miss rate: {:.2f}%\n",
+                                             controller.getRunningStart() * 1000,
+                                             expected * 1000,
+                                             missRate * 100)
+                                     .c_str());
+            Assert::AreEqual(0.012, controller.getMeanFrameTime(), 0.0002);
+            Assert::AreEqual(expected, controller.getRunningStart(), 0.0005);
+            Assert::IsTrue(missRate < 0.01);
+        }
+
+        TEST_METHOD(MissedFrameReactsAndHolds) {
+            RunningStartController controller;
+            controller.configure(true, 0.0005, 0.010);
+            for (int i = 0; i < 900; i++) {
+                controller.update(0.004, 0.004 - controller.getRunningStart(), FrameDuration);
+            }
+            const double before = controller.getRunningStart();
+
+            // A single late frame.
+            Assert::IsTrue(controller.update(0.013, 0.013 - before, FrameDuration));
+            const double after = controller.getRunningStart();
+            Assert::IsTrue(after >= 2 * before);
+
+            // No shrinking while holding.
+            for (uint32_t i = 0; i < RunningStartController::MissHoldFrames; i++) {
+                controller.update(0.004, 0.004 - controller.getRunningStart(), FrameDuration);
+                Assert::AreEqual(after, controller.getRunningStart());
+            }
+            controller.update(0.004, 0.004 - controller.getRunningStart(), FrameDuration);
+            Assert::IsTrue(controller.getRunningStart() < after);
+        }
+
+        TEST_METHOD(ClampedToBounds) {
+            RunningStartController controller;
+            controller.configure(true, 0.003, 0.005);
+            Assert::AreEqual(0.003, controller.getRunningStart());
+
+            for (int i = 0; i < 100; i++) {
+                controller.update(0.030, 0.030 - controller.getRunningStart(), FrameDuration);
+            }
+            Assert::AreEqual(0.005, controller.getRunningStart());
+
+            // Reconfiguring starts over.
+            controller.configure(true, 0.0, 0.005);
+            Assert::AreEqual(RunningStartController::DefaultRunningStart, controller.getRunningStart());
+            Assert::AreEqual(0ull, (unsigned long long)controller.getNumFrames());
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
@@ -0,0 +1,202 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "utils.h"
+
+namespace virtualdesktop_openxr_tests {
+
+    using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+    using namespace xr::math;
+
+    namespace {
+
+        constexpr XrSpaceVelocityFlags BothValid =
+            XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+
+        XrSpaceVelocity MakeVelocity(const XrVector3f& linear,
+                                     const XrVector3f& angular,
+                                     XrSpaceVelocityFlags flags = BothValid) {
+            XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+            velocity.velocityFlags = flags;
+            velocity.linearVelocity = linear;
+            velocity.angularVelocity = angular;
+            return velocity;
+        }
+
+        XrQuaternionf MakeRotation(const XrVector3f& axis, float angle) {
+            XrQuaternionf orientation;
+            StoreXrQuaternion(
+                &orientation,
+                DirectX::XMQuaternionRotationAxis(DirectX::XMVector3Normalize(LoadXrVector3(axis)), angle));
+            return orientation;
+        }
+
+        // The pose of a rigid body moving at constant linear and angular velocity (both in the common frame), dt
+        // seconds later.
+        XrPosef Advance(const XrPosef& pose, const XrSpaceVelocity& velocity, float dt) {
+            XrPosef result = pose;
+            result.position = {pose.position.x + velocity.linearVelocity.x * dt,
+                               pose.position.y + velocity.linearVelocity.y * dt,
+                               pose.position.z + velocity.linearVelocity.z * dt};
+            const float speed = Length(velocity.angularVelocity);
+            if (speed > 0.f) {
+                StoreXrQuaternion(&result.orientation,
+                                  DirectX::XMQuaternionMultiply(LoadXrQuaternion(pose.orientation),
+                                                                LoadXrQuaternion(MakeRotation(
+                                                                    velocity.angularVelocity, speed * dt))));
+            }
+            return result;
+        }
+
+        // Central differences of a pose sampled dt before and after: the linear velocity, and the angular velocity in
+        // the frame the poses are expressed in.
+        XrSpaceVelocity Differentiate(const XrPosef& before, const XrPosef& after, float dt) {
+            XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+            velocity.velocityFlags = BothValid;
+            velocity.linearVelocity = {(after.position.x - before.position.x) / (2 * dt),
+                                       (after.position.y - before.position.y) / (2 * dt),
+                                       (after.position.z - before.position.z) / (2 * dt)};
+
+            XrQuaternionf delta;
+            StoreXrQuaternion(&delta,
+                              DirectX::XMQuaternionMultiply(
+                                  DirectX::XMQuaternionConjugate(LoadXrQuaternion(before.orientation)),
+                                  LoadXrQuaternion(after.orientation)));
+            const float sign = delta.w < 0.f ? -1.f : 1.f;
+            velocity.angularVelocity = {sign * delta.x / dt, sign * delta.y / dt, sign * delta.z / dt};
+            return velocity;
+        }
+
+        void AssertVectorEqual(const XrVector3f& expected, const XrVector3f& actual, float tolerance) {
+            Assert::AreEqual(expected.x, actual.x, tolerance);
+            Assert::AreEqual(expected.y, actual.y, tolerance);
+            Assert::AreEqual(expected.z, actual.z, tolerance);
+        }
+
+    } // namespace
+
+    TEST_CLASS(VelocityTests) {
+        TEST_METHOD(OffsetPointOnSpinningBody) {
+            const XrPosef bodyPose = Pose::MakePose(MakeRotation({0.f, 1.f, 0.f}, 0.5f), {0.2f, 1.f, -0.3f});
+            const XrSpaceVelocity bodyVelocity = MakeVelocity({0.3f, 0.f, -0.1f}, {0.5f, 2.f, -1.f});
+            const XrPosef offset = Pose::Translation({0.f, -0.05f, 0.12f});
+
+            XrSpaceVelocity velocity = bodyVelocity;
+            Velocity::ApplyOffset(bodyPose, offset, velocity);
+
+            // The point at the offset, followed over time.
+            constexpr float dt = 1e-3f;
+            const XrSpaceVelocity expected = Differentiate(Pose::Multiply(offset, Advance(bodyPose, bodyVelocity, -dt)),
+                                                           Pose::Multiply(offset, Advance(bodyPose, bodyVelocity, dt)),
+                                                           dt);
+            Assert::AreEqual(BothValid, velocity.velocityFlags);
+            AssertVectorEqual(expected.linearVelocity, velocity.linearVelocity, 5e-3f);
+            AssertVectorEqual(bodyVelocity.angularVelocity, velocity.angularVelocity, 0.f);
+
+            // The tangential term must be there: w x r is far from 0 here.
+            Assert::IsTrue(Length({velocity.linearVelocity.x - bodyVelocity.linearVelocity.x,
+                                   velocity.linearVelocity.y - bodyVelocity.linearVelocity.y,
+                                   velocity.linearVelocity.z - bodyVelocity.linearVelocity.z}) > 0.1f);
+        }
+
+        TEST_METHOD(OffsetWithoutAngularVelocity) {
+            const XrPosef bodyPose = Pose::Identity();
+            const XrSpaceVelocity linearOnly = MakeVelocity({1.f, 0.f, 0.f}, {}, XR_SPACE_VELOCITY_LINEAR_VALID_BIT);
+
+            // At the body's origin, the linear velocity is the body's.
+            XrSpaceVelocity velocity = linearOnly;
+            Velocity::ApplyOffset(bodyPose, Pose::MakePose(MakeRotation({0.f, 1.f, 0.f}, 1.f), {}), velocity);
+            Assert::AreEqual((XrSpaceVelocityFlags)XR_SPACE_VELOCITY_LINEAR_VALID_BIT, velocity.velocityFlags);
+            AssertVectorEqual({1.f, 0.f, 0.f}, velocity.linearVelocity, 0.f);
+
+            // Away from it, the tangential term is unknown.
+            velocity = linearOnly;
+            Velocity::ApplyOffset(bodyPose, Pose::Translation({0.f, 0.f, 0.1f}), velocity);
+            Assert::AreEqual((XrSpaceVelocityFlags)0, velocity.velocityFlags);
+
+            // Nothing to do without a linear velocity.
+            velocity = MakeVelocity({}, {0.f, 1.f, 0.f}, XR_SPACE_VELOCITY_ANGULAR_VALID_BIT);
+            Velocity::ApplyOffset(bodyPose, Pose::Translation({0.f, 0.f, 0.1f}), velocity);
+            Assert::AreEqual((XrSpaceVelocityFlags)XR_SPACE_VELOCITY_ANGULAR_VALID_BIT, velocity.velocityFlags);
+            AssertVectorEqual({0.f, 0.f, 0.f}, velocity.linearVelocity, 0.f);
+        }
+
+        TEST_METHOD(RotatingAndTranslatingBase) {
+            const XrPosef pose = Pose::MakePose(MakeRotation({1.f, 0.f, 0.f}, 0.3f), {0.4f, 1.2f, -0.5f});
+            const XrSpaceVelocity velocity = MakeVelocity({0.2f, 0.1f, 0.f}, {0.f, 1.5f, 0.5f});
+            const XrPosef basePose = Pose::MakePose(MakeRotation({0.f, 1.f, 0.f}, -0.8f), {-0.3f, 0.1f, 0.6f});
+            const XrSpaceVelocity baseVelocity = MakeVelocity({-0.4f, 0.f, 0.3f}, {0.2f, -1.f, 0.f});
+
+            const XrSpaceVelocity relative = Velocity::Relative(pose, velocity, basePose, baseVelocity);
+
+            // The pose relative to the base, followed over time.
+            constexpr float dt = 1e-3f;
+            const XrSpaceVelocity expected = Differentiate(
+                Pose::Multiply(Advance(pose, velocity, -dt), Pose::Invert(Advance(basePose, baseVelocity, -dt))),
+                Pose::Multiply(Advance(pose, velocity, dt), Pose::Invert(Advance(basePose, baseVelocity, dt))),
+                dt);
+            Assert::AreEqual(BothValid, relative.velocityFlags);
+            AssertVectorEqual(expected.linearVelocity, relative.linearVelocity, 5e-3f);
+            AssertVectorEqual(expected.angularVelocity, relative.angularVelocity, 5e-3f);
+        }
+
+        TEST_METHOD(RelativeToItself) {
+            const XrPosef pose = Pose::MakePose(MakeRotation({0.f, 0.f, 1.f}, 1.f), {1.f, 2.f, 3.f});
+            const XrSpaceVelocity velocity = MakeVelocity({0.5f, -0.2f, 0.1f}, {1.f, 2.f, 3.f});
+
+            const XrSpaceVelocity relative = Velocity::Relative(pose, velocity, pose, velocity);
+            Assert::AreEqual(BothValid, relative.velocityFlags);
+            AssertVectorEqual({0.f, 0.f, 0.f}, relative.linearVelocity, 1e-5f);
+            AssertVectorEqual({0.f, 0.f, 0.f}, relative.angularVelocity, 1e-5f);
+        }
+
+        TEST_METHOD(RelativeValidity) {
+            const XrPosef pose = Pose::Translation({0.f, 1.f, -0.5f});
+            const XrPosef basePose = Pose::Translation({0.f, 1.f, 0.f});
+            const auto relativeFlags = [&](XrSpaceVelocityFlags flags, XrSpaceVelocityFlags baseFlags) {
+                return Velocity::Relative(pose,
+                                          MakeVelocity({1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, flags),
+                                          basePose,
+                                          MakeVelocity({0.f, 1.f, 0.f}, {1.f, 0.f, 0.f}, baseFlags))
+                    .velocityFlags;
+            };
+            constexpr XrSpaceVelocityFlags Linear = XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+            constexpr XrSpaceVelocityFlags Angular = XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+
+            Assert::AreEqual(BothValid, relativeFlags(BothValid, BothValid));
+            Assert::AreEqual(Linear, relativeFlags(Linear, BothValid));
+            Assert::AreEqual(Angular, relativeFlags(Angular, BothValid));
+            Assert::AreEqual(Angular, relativeFlags(BothValid, Angular));
+            Assert::AreEqual((XrSpaceVelocityFlags)0, relativeFlags(0, BothValid));
+            Assert::AreEqual((XrSpaceVelocityFlags)0, relativeFlags(BothValid, 0));
+
+            // The rotation of the base drags the body along: without the base's angular velocity, the linear velocity
+            // is unknown.
+            Assert::AreEqual((XrSpaceVelocityFlags)0, relativeFlags(BothValid, Linear));
+            Assert::AreEqual((XrSpaceVelocityFlags)0, relativeFlags(Linear, Linear));
+        }
+    };
+
+} // namespace virtualdesktop_openxr_tests
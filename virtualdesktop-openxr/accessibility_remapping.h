@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "hand_gestures.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    struct AccessibilityRemappingSettings {
+        static constexpr uint32_t MaxChords = 4;
+
+        // A single button pressing several buttons at once.
+        struct Chord {
+            uint32_t button{0};
+            uint32_t buttons{0};
+
+            bool operator==(const Chord& other) const {
+                return button == other.button && buttons == other.buttons;
+            }
+        };
+
+        // Side whose inputs are also reported on the other side, or -1.
+        int mirrorFromSide{-1};
+        // Report the mirrored controller as connected and derive its pose from the other hand.
+        bool deriveOffHandPose{false};
+        // Buttons (ovrButton bits) that toggle on press instead of being held.
+        uint32_t toggleButtons{0};
+        bool toggleHandTrigger[xr::Side::Count]{};
+        Chord chords[MaxChords]{};
+
+        bool isEnabled() const {
+            return mirrorFromSide >= 0 || toggleButtons || toggleHandTrigger[xr::Side::Left] ||
+                   toggleHandTrigger[xr::Side::Right] ||
+                   std::any_of(std::cbegin(chords), std::cend(chords), [](const Chord& chord) {
+                       return chord.button && chord.buttons;
+                   });
+        }
+
+        bool operator==(const AccessibilityRemappingSettings& other) const {
+            return mirrorFromSide == other.mirrorFromSide && deriveOffHandPose == other.deriveOffHandPose &&
+                   toggleButtons == other.toggleButtons &&
+                   std::equal(std::cbegin(toggleHandTrigger),
+                              std::cend(toggleHandTrigger),
+                              std::cbegin(other.toggleHandTrigger)) &&
+                   std::equal(std::cbegin(chords), std::cend(chords), std::cbegin(other.chords));
+        }
+    };
+
+    // Rewrite the latched controller input state for users who cannot use both controllers or hold buttons. This is
+    // applied once per xrSyncActions(), before the state is propagated to the action sets, so the action state getters
+    // read the remapped values directly.
+    class AccessibilityRemapping {
+      public:
+        void configure(const AccessibilityRemappingSettings& settings) {
+            if (settings == m_settings) {
+                return;
+            }
+
+            m_settings = settings;
+            m_toggledButtons = m_previousButtons = 0;
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                m_isHandTriggerToggled[side] = false;
+                m_handTriggerPress[side].reset();
+            }
+        }
+
+        bool isEnabled() const {
+            return m_settings.isEnabled();
+        }
+
+        // Whether the controller must be reported as connected even though it is not.
+        bool isControllerEmulated(uint32_t side, bool isConnected, bool isOtherConnected) const {
+            return !isConnected && isOtherConnected && m_settings.deriveOffHandPose &&
+                   m_settings.mirrorFromSide == (int)(side ^ 1);
+        }
+
+        void apply(ovrInputState& state) {
+            if (m_settings.mirrorFromSide >= 0) {
+                mirror(state, m_settings.mirrorFromSide);
+            }
+
+            const uint32_t buttons = state.Buttons;
+            for (const auto& chord : m_settings.chords) {
+                if (chord.button && (buttons & chord.button)) {
+                    state.Buttons |= chord.buttons;
+                }
+            }
+
+            if (m_settings.toggleButtons) {
+                const uint32_t pressed = state.Buttons & ~m_previousButtons & m_settings.toggleButtons;
+                m_previousButtons = state.Buttons;
+                m_toggledButtons ^= pressed;
+                state.Buttons = (state.Buttons & ~m_settings.toggleButtons) | m_toggledButtons;
+            }
+
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                if (!m_settings.toggleHandTrigger[side]) {
+                    continue;
+                }
+
+                const bool wasPressed = m_handTriggerPress[side].isActive();
+                if (m_handTriggerPress[side].update(state.HandTrigger[side]) && !wasPressed) {
+                    m_isHandTriggerToggled[side] = !m_isHandTriggerToggled[side];
+                }
+                state.HandTrigger[side] = state.HandTriggerNoDeadzone[side] = m_isHandTriggerToggled[side] ? 1.f : 0.f;
+            }
+        }
+
+      private:
+        static void mirror(ovrInputState& state, uint32_t from) {
+            struct MirroredBit {
+                uint32_t left;
+                uint32_t right;
+            };
+            static constexpr MirroredBit MirroredButtons[] = {
+                {ovrButton_X, ovrButton_A},
+                {ovrButton_Y, ovrButton_B},
+                {ovrButton_LThumb, ovrButton_RThumb},
+            };
+            static constexpr MirroredBit MirroredTouches[] = {
+                {ovrTouch_X, ovrTouch_A},
+                {ovrTouch_Y, ovrTouch_B},
+                {ovrTouch_LThumb, ovrTouch_RThumb},
+                {ovrTouch_LThumbRest, ovrTouch_RThumbRest},
+                {ovrTouch_LIndexTrigger, ovrTouch_RIndexTrigger},
+                {ovrTouch_LIndexPointing, ovrTouch_RIndexPointing},
+                {ovrTouch_LThumbUp, ovrTouch_RThumbUp},
+            };
+
+            const auto mirrorBits = [&](uint32_t& bits, const auto& table) {
+                const uint32_t source = bits;
+                for (const auto& bit : table) {
+                    const uint32_t fromBit = from == xr::Side::Left ? bit.left : bit.right;
+                    const uint32_t toBit = from == xr::Side::Left ? bit.right : bit.left;
+                    if (source & fromBit) {
+                        bits |= toBit;
+                    }
+                }
+            };
+            mirrorBits(state.Buttons, MirroredButtons);
+            mirrorBits(state.Touches, MirroredTouches);
+
+            const uint32_t to = from ^ 1;
+            state.IndexTrigger[to] = std::max(state.IndexTrigger[to], state.IndexTrigger[from]);
+            state.HandTrigger[to] = std::max(state.HandTrigger[to], state.HandTrigger[from]);
+            state.IndexTriggerNoDeadzone[to] =
+                std::max(state.IndexTriggerNoDeadzone[to], state.IndexTriggerNoDeadzone[from]);
+            state.HandTriggerNoDeadzone[to] =
+                std::max(state.HandTriggerNoDeadzone[to], state.HandTriggerNoDeadzone[from]);
+
+            // Keep the thumbstick with the largest deflection.
+            const auto lengthSquared = [](const ovrVector2f& v) { return v.x * v.x + v.y * v.y; };
+            if (lengthSquared(state.ThumbstickNoDeadzone[from]) > lengthSquared(state.ThumbstickNoDeadzone[to])) {
+                state.Thumbstick[to] = state.Thumbstick[from];
+                state.ThumbstickNoDeadzone[to] = state.ThumbstickNoDeadzone[from];
+            }
+        }
+
+        AccessibilityRemappingSettings m_settings;
+
+        uint32_t m_previousButtons{0};
+        uint32_t m_toggledButtons{0};
+        GestureLatch m_handTriggerPress[xr::Side::Count]{{0.75f, 0.25f}, {0.75f, 0.25f}};
+        bool m_isHandTriggerToggled[xr::Side::Count]{};
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -984,14 +984,26 @@ namespace virtualdesktop_openxr {
 
         // Latch the state of all inputs, and we will let the further calls to xrGetActionState*() do the triage.
         CHECK_OVRCMD(ovr_GetInputState(m_ovrSession, ovrControllerType_Touch, &m_cachedInputState));
+        const unsigned int connectedControllers = ovr_GetConnectedControllerTypes(m_ovrSession);
+
+        // Whether a side is emulated depends on both controllers, and the controller poses use it regardless of which
+        // sides are synced. Update it for both sides.
+        for (uint32_t side = 0; side < xr::Side::Count; side++) {
+            m_isControllerEmulated[side] = m_accessibilityRemapping.isControllerEmulated(
+                side,
+                connectedControllers & (side == 0 ? ovrControllerType_LTouch : ovrControllerType_RTouch),
+                connectedControllers & (side == 0 ? ovrControllerType_RTouch : ovrControllerType_LTouch));
+        }
+
         for (uint32_t side = 0; side < xr::Side::Count; side++) {
             if (!doSide[side]) {
                 continue;
             }
 
             const auto lastControllerType = m_cachedControllerType[side];
-            const bool isControllerConnected = ovr_GetConnectedControllerTypes(m_ovrSession) &
-                                               (side == 0 ? ovrControllerType_LTouch : ovrControllerType_RTouch);
+            const bool isPhysicalControllerConnected =
+                connectedControllers & (side == 0 ? ovrControllerType_LTouch : ovrControllerType_RTouch);
+            const bool isControllerConnected = isPhysicalControllerConnected || m_isControllerEmulated[side];
             if (isControllerConnected) {
                 m_cachedControllerType[side] = "touch_controller";
                 m_isControllerActive[side] = true;
@@ -1001,6 +1013,7 @@ namespace virtualdesktop_openxr {
                     "OVR_InputState",
                     TLArg(side == 0 ? "Left" : "Right", "Side"),
                     TLArg(true, "Connected"),
+                    TLArg(m_isControllerEmulated[side], "Emulated"),
                     TLArg(m_cachedInputState.TimeInSeconds, "TimeInSeconds"),
                     TLArg(m_cachedInputState.Buttons & (side == 0 ? ovrButton_LMask : ovrButton_RMask), "Buttons"),
                     TLArg(m_cachedInputState.Touches & (side == 0 ? ovrTouch_LButtonMask : ovrTouch_RButtonMask),
@@ -1038,6 +1051,15 @@ namespace virtualdesktop_openxr {
             }
         }
 
+        if (m_accessibilityRemapping.isEnabled()) {
+            m_accessibilityRemapping.apply(m_cachedInputState);
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrSyncActions_AccessibilityRemapping",
+                              TLArg(m_cachedInputState.Buttons, "Buttons"),
+                              TLArg(m_cachedInputState.Touches, "Touches"));
+        }
+
         // Propagate the input state to the entire action state.
         for (uint32_t i = 0; i < syncInfo->countActiveActionSets; i++) {
             ActionSet& xrActionSet = *(ActionSet*)syncInfo->activeActionSets[i].actionSet;
@@ -0,0 +1,193 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "late_latching.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Single-producer/single-consumer ring of frames handed off by xrEndFrame() to the asynchronous submission thread.
+    // The frames are preallocated and reused, and the two sides synchronize with atomic counters and WaitOnAddress()
+    // instead of a mutex and a condition variable.
+    //
+    // A frame goes through 3 states: queued by the producer, submitted by the consumer (the OVR swapchain images
+    // committed for the frame and the submission context are handed back to the producer), then retired by the
+    // consumer once OVR opens the next slot.
+    //
+    // The depth is the number of frames in flight (queued or submitted, but not retired). It is limited to 2: the
+    // producer uses the submission context in xrEndFrame(), which the consumer shares with ovr_EndFrame(), so a frame
+    // cannot be queued until the previous one is submitted. With the previous frame only retired after the next
+    // ovr_BeginFrame(), this leaves room for at most one frame being rendered while another one awaits its slot.
+    class AsyncSubmissionQueue {
+      public:
+        // Must be a power of 2 so that the counters can wrap around.
+        static constexpr uint32_t Capacity = 4;
+
+        static constexpr uint32_t MaxDepth = 2;
+
+        struct Frame {
+            long long frameId{0};
+            std::vector<ovrLayer_Union> layers;
+            std::vector<LateLatchedLayer> lateLatchedLayers;
+            double displayTime{0.0};
+        };
+
+        AsyncSubmissionQueue() {
+            for (auto& frame : m_frames) {
+                frame.layers.reserve(ovrMaxLayerCount);
+                frame.lateLatchedLayers.reserve(ovrMaxLayerCount);
+            }
+        }
+
+        // Must not be called while the consumer is running.
+        void reset() {
+            m_queued = m_submitted = m_retired = 0;
+            m_terminate = false;
+        }
+
+        void setDepth(uint32_t depth) {
+            m_depth = std::clamp(depth, 1u, MaxDepth);
+        }
+
+        uint32_t getDepth() const {
+            return m_depth.load(std::memory_order_relaxed);
+        }
+
+        uint32_t getFramesInFlight() const {
+            return m_queued.load(std::memory_order_acquire) - m_retired.load(std::memory_order_acquire);
+        }
+
+        // Producer side.
+
+        // The next frame to fill. Only valid after waitForHandoff().
+        Frame& getNextFrame() {
+            return m_frames[m_queued.load(std::memory_order_relaxed) % Capacity];
+        }
+
+        void push() {
+            signal(m_queued);
+        }
+
+        void terminate() {
+            m_terminate = true;
+            signal(m_queued);
+        }
+
+        // Wait until at most maxFramesInFlight frames are in flight. Returns false upon reaching the deadline.
+        bool waitForFramesInFlight(uint32_t maxFramesInFlight,
+                                   std::optional<std::chrono::high_resolution_clock::time_point> deadline = {}) {
+            return wait(m_retired, [&] { return getFramesInFlight() <= maxFramesInFlight; }, deadline);
+        }
+
+        // Wait until all frames are submitted and there is room for a new frame.
+        void waitForHandoff() {
+            wait(m_submitted, [&] {
+                return m_submitted.load(std::memory_order_acquire) == m_queued.load(std::memory_order_relaxed);
+            });
+            waitForFramesInFlight(getDepth() - 1);
+        }
+
+        // Consumer side.
+
+        bool isTerminating() const {
+            return m_terminate.load(std::memory_order_acquire);
+        }
+
+        bool hasPendingFrame() const {
+            return m_submitted.load(std::memory_order_relaxed) != m_queued.load(std::memory_order_acquire);
+        }
+
+        // The oldest frame not submitted yet. Only valid when hasPendingFrame().
+        Frame& getPendingFrame() {
+            return m_frames[m_submitted.load(std::memory_order_relaxed) % Capacity];
+        }
+
+        // Wait for a frame to submit. Returns nullptr upon termination.
+        Frame* waitForPendingFrame() {
+            wait(m_queued, [&] { return isTerminating() || hasPendingFrame(); });
+            return !isTerminating() ? &getPendingFrame() : nullptr;
+        }
+
+        void markSubmitted() {
+            signal(m_submitted);
+        }
+
+        // Retire the oldest submitted frame, if any.
+        void retire() {
+            if (m_retired.load(std::memory_order_relaxed) != m_submitted.load(std::memory_order_relaxed)) {
+                signal(m_retired);
+            }
+        }
+
+      private:
+        static void signal(std::atomic<uint32_t>& counter) {
+            counter.fetch_add(1, std::memory_order_release);
+            WakeByAddressAll(&counter);
+        }
+
+        template <typename Predicate>
+        static bool wait(std::atomic<uint32_t>& counter,
+                         Predicate predicate,
+                         std::optional<std::chrono::high_resolution_clock::time_point> deadline = {}) {
+            while (true) {
+                // Sample the counter before evaluating the predicate, so that a signal in-between cannot be missed.
+                uint32_t observed = counter.load(std::memory_order_acquire);
+                if (predicate()) {
+                    return true;
+                }
+
+                DWORD timeout = INFINITE;
+                if (deadline) {
+                    const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                        deadline.value() - std::chrono::high_resolution_clock::now());
+                    if (remaining.count() <= 0) {
+                        return predicate();
+                    }
+
+                    // WaitOnAddress() only has millisecond granularity.
+                    if (remaining.count() < 1000) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    timeout = (DWORD)(remaining.count() / 1000);
+                }
+                WaitOnAddress(&counter, &observed, sizeof(observed), timeout);
+            }
+        }
+
+        Frame m_frames[Capacity];
+        std::atomic<uint32_t> m_depth{1};
+        std::atomic<bool> m_terminate{false};
+
+        // Producer-owned.
+        alignas(64) std::atomic<uint32_t> m_queued{0};
+
+        // Consumer-owned.
+        alignas(64) std::atomic<uint32_t> m_submitted{0};
+        alignas(64) std::atomic<uint32_t> m_retired{0};
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -0,0 +1,310 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // The independently updated sections of the body state.
+    enum class BodyStateSection : uint32_t { Face = 0, Eyes, Hands, Body, Skeleton, Count };
+
+    struct BodyStateSectionRange {
+        size_t offset;
+        size_t size;
+    };
+
+    // Byte ranges of each section within the body state, in the order of BodyStateSection.
+    constexpr BodyStateSectionRange BodyStateSections[(uint32_t)BodyStateSection::Count] = {
+        {offsetof(BodyTracking::BodyStateV2, FaceIsValid),
+         offsetof(BodyTracking::BodyStateV2, LeftEyeIsValid) - offsetof(BodyTracking::BodyStateV2, FaceIsValid)},
+        {offsetof(BodyTracking::BodyStateV2, LeftEyeIsValid),
+         offsetof(BodyTracking::BodyStateV2, LeftHandActive) - offsetof(BodyTracking::BodyStateV2, LeftEyeIsValid)},
+        {offsetof(BodyTracking::BodyStateV2, LeftHandActive),
+         offsetof(BodyTracking::BodyStateV2, BodyTrackingCalibrated) -
+             offsetof(BodyTracking::BodyStateV2, LeftHandActive)},
+        {offsetof(BodyTracking::BodyStateV2, BodyTrackingCalibrated),
+         offsetof(BodyTracking::BodyStateV2, SkeletonJoints) -
+             offsetof(BodyTracking::BodyStateV2, BodyTrackingCalibrated)},
+        {offsetof(BodyTracking::BodyStateV2, SkeletonJoints),
+         sizeof(BodyTracking::BodyStateV2) - offsetof(BodyTracking::BodyStateV2, SkeletonJoints)},
+    };
+    static_assert(offsetof(BodyTracking::BodyStateV2, FaceIsValid) == 0);
+
+    constexpr uint32_t AllBodyStateSections = (1u << (uint32_t)BodyStateSection::Count) - 1;
+
+    // Compare each section of two body states. The skeleton is compared through the producer's change counter.
+    // Returns the mask of the sections that differ.
+    static inline uint32_t GetChangedBodyStateSections(const BodyTracking::BodyStateV2& a,
+                                                        const BodyTracking::BodyStateV2& b) {
+        uint32_t changedSections = 0;
+        for (uint32_t i = 0; i < (uint32_t)BodyStateSection::Count; i++) {
+            const bool changed = i == (uint32_t)BodyStateSection::Skeleton
+                                     ? a.SkeletonChangedCount != b.SkeletonChangedCount
+                                     : memcmp(reinterpret_cast<const uint8_t*>(&a) + BodyStateSections[i].offset,
+                                              reinterpret_cast<const uint8_t*>(&b) + BodyStateSections[i].offset,
+                                              BodyStateSections[i].size);
+            if (changed) {
+                changedSections |= 1u << i;
+            }
+        }
+        return changedSections;
+    }
+
+    // Publication of the body state from the watcher thread to the application threads.
+    // The writer fills the oldest slot of a small ring, then publishes it by bumping the generation. Readers never take
+    // a lock: they copy out of a slot and validate the copy against the slot's sequence number. A retry is only needed
+    // when the writer laps a reader (i.e. overwrites the slot while the reader is copying it).
+    // The ring also serves as a short history of timestamped snapshots, so that queries can be resolved at the time
+    // requested by the application.
+    class BodyStateBuffer {
+      public:
+        static constexpr uint32_t SlotCount = 8;
+
+        // How many past snapshots can be read safely while the writer is filling the next one.
+        static constexpr uint32_t HistoryDepth = SlotCount - 1;
+
+        // Writer side (single thread only).
+        // Publish only when at least one section changed since the previous publication. Unchanged sections are
+        // carried over from the previous snapshot rather than copied from the producer. Returns the mask of the
+        // sections that changed (0 when nothing was published).
+        uint32_t publish(const BodyTracking::BodyStateV2& state, double time) {
+            const uint64_t generation = m_generation.load(std::memory_order_relaxed);
+            const Slot& previous = m_slots[generation % SlotCount];
+
+            const uint32_t changedSections =
+                generation ? GetChangedBodyStateSections(state, previous.state) : AllBodyStateSections;
+            if (!changedSections) {
+                return 0;
+            }
+
+            Slot& slot = beginUpdate();
+            for (uint32_t i = 0; i < (uint32_t)BodyStateSection::Count; i++) {
+                const bool changed = changedSections & (1u << i);
+                memcpy(reinterpret_cast<uint8_t*>(&slot.state) + BodyStateSections[i].offset,
+                       reinterpret_cast<const uint8_t*>(changed ? &state : &previous.state) +
+                           BodyStateSections[i].offset,
+                       BodyStateSections[i].size);
+                slot.sectionTimes[i].store(changed ? time : previous.sectionTimes[i].load(std::memory_order_relaxed),
+                                           std::memory_order_relaxed);
+            }
+            endUpdate(time);
+
+            return changedSections;
+        }
+
+        // Reader side (any thread). The copyOut callback may be invoked several times and must only copy data out of
+        // the state it is given. Returns the generation of the snapshot (0 if nothing was ever published).
+        template <typename CopyOut>
+        uint64_t read(CopyOut&& copyOut) const {
+            return readSlot([&](const Slot& slot) { copyOut(slot.state); });
+        }
+
+        uint64_t read(BodyTracking::BodyStateV2& snapshot) const {
+            return read([&](const BodyTracking::BodyStateV2& state) { snapshot = state; });
+        }
+
+        // Time of the latest publication where the section changed (0 if it was never published).
+        double lastUpdateTime(BodyStateSection section) const {
+            double time = 0;
+            readSlot([&](const Slot& slot) {
+                time = slot.sectionTimes[(uint32_t)section].load(std::memory_order_relaxed);
+            });
+            return time;
+        }
+
+        // Read the two snapshots bracketing the requested time for a section. Unchanged sections are carried over from
+        // one snapshot to the next, so only the snapshots where the section changed are considered, and they are timed
+        // with the section's own update time. When the time is past the latest update, the two latest updates are
+        // returned. When the time is before the history, the two oldest updates are returned. The copyOut callback
+        // receives (older, olderTime, newer, newerTime), and may be invoked several times. Before two updates of the
+        // section are available, the latest snapshot is passed as both older and newer.
+        template <typename CopyOut>
+        uint64_t readAt(BodyStateSection section, double time, CopyOut&& copyOut) const {
+            const uint32_t index = (uint32_t)section;
+            while (true) {
+                const uint64_t generation = m_generation.load(std::memory_order_acquire);
+
+                // Walk back the history and collect the updates of the section, newest first. Each update is read from
+                // the most recent snapshot carrying it.
+                const uint64_t oldestGeneration = std::max(generation + 1, (uint64_t)HistoryDepth + 1) - HistoryDepth;
+                uint64_t updateGenerations[HistoryDepth + 1];
+                double updateTimes[HistoryDepth + 1];
+                uint32_t numUpdates = 0;
+                for (uint64_t g = generation; g >= oldestGeneration && g > 0; g--) {
+                    const double updateTime =
+                        m_slots[g % SlotCount].sectionTimes[index].load(std::memory_order_relaxed);
+                    if (!numUpdates || updateTime < updateTimes[numUpdates - 1]) {
+                        updateGenerations[numUpdates] = g;
+                        updateTimes[numUpdates] = updateTime;
+                        numUpdates++;
+                    }
+                }
+
+                if (!numUpdates) {
+                    // Nothing was published yet.
+                    updateGenerations[0] = 0;
+                    updateTimes[0] = 0;
+                    numUpdates = 1;
+                }
+
+                // Find the update older than the requested time.
+                uint32_t newerUpdate = 0;
+                while (newerUpdate + 2 < numUpdates && updateTimes[newerUpdate + 1] > time) {
+                    newerUpdate++;
+                }
+                const uint32_t olderUpdate = std::min(newerUpdate + 1, numUpdates - 1);
+                const uint64_t newerGeneration = updateGenerations[newerUpdate];
+                const uint64_t olderGeneration = updateGenerations[olderUpdate];
+                const Slot& newer = m_slots[newerGeneration % SlotCount];
+                const Slot& older = m_slots[olderGeneration % SlotCount];
+
+                // The older snapshot is overwritten first: validating it is enough to know the walk above was not
+                // lapped by the writer.
+                uint32_t newerSequence, olderSequence;
+                if (beginRead(older, olderGeneration, olderSequence) &&
+                    beginRead(newer, newerGeneration, newerSequence)) {
+                    copyOut(older.state, updateTimes[olderUpdate], newer.state, updateTimes[newerUpdate]);
+
+                    if (endRead(older, olderSequence) && endRead(newer, newerSequence)) {
+                        return newerGeneration;
+                    }
+                }
+
+                m_readRetries.fetch_add(1, std::memory_order_relaxed);
+                _mm_pause();
+            }
+        }
+
+        uint64_t generation() const {
+            return m_generation.load(std::memory_order_acquire);
+        }
+
+        uint64_t readRetries() const {
+            return m_readRetries.load(std::memory_order_relaxed);
+        }
+
+      private:
+        struct Slot {
+            std::atomic<uint32_t> sequence{0};
+            std::atomic<uint64_t> generation{0};
+            std::atomic<double> time{0};
+            std::atomic<double> sectionTimes[(uint32_t)BodyStateSection::Count]{};
+            BodyTracking::BodyStateV2 state{};
+        };
+
+        Slot& beginUpdate() {
+            Slot& slot = m_slots[(m_generation.load(std::memory_order_relaxed) + 1) % SlotCount];
+            slot.sequence.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            return slot;
+        }
+
+        void endUpdate(double time) {
+            const uint64_t generation = m_generation.load(std::memory_order_relaxed) + 1;
+            Slot& slot = m_slots[generation % SlotCount];
+            slot.time.store(time, std::memory_order_relaxed);
+            slot.generation.store(generation, std::memory_order_relaxed);
+            slot.sequence.fetch_add(1, std::memory_order_release);
+            m_generation.store(generation, std::memory_order_release);
+        }
+
+        template <typename CopyOut>
+        uint64_t readSlot(CopyOut&& copyOut) const {
+            while (true) {
+                const uint64_t generation = m_generation.load(std::memory_order_acquire);
+                const Slot& slot = m_slots[generation % SlotCount];
+
+                uint32_t sequence;
+                if (beginRead(slot, generation, sequence)) {
+                    copyOut(slot);
+
+                    if (endRead(slot, sequence)) {
+                        return generation;
+                    }
+                }
+
+                m_readRetries.fetch_add(1, std::memory_order_relaxed);
+                _mm_pause();
+            }
+        }
+
+        static bool beginRead(const Slot& slot, uint64_t generation, uint32_t& sequence) {
+            sequence = slot.sequence.load(std::memory_order_acquire);
+            return !(sequence & 1) && slot.generation.load(std::memory_order_relaxed) == generation;
+        }
+
+        static bool endRead(const Slot& slot, uint32_t sequence) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.sequence.load(std::memory_order_relaxed) == sequence;
+        }
+
+        Slot m_slots[SlotCount];
+        std::atomic<uint64_t> m_generation{0};
+        mutable std::atomic<uint64_t> m_readRetries{0};
+    };
+
+    // Blend factor between two timestamped snapshots for the requested time. The factor is 0 at the older snapshot
+    // and 1 at the newer snapshot. It goes above 1 to extrapolate, but never further than maxExtrapolation seconds
+    // past the newer snapshot.
+    static inline float
+    GetBodyStateBlendFactor(double olderTime, double newerTime, double time, double maxExtrapolation) {
+        const double interval = newerTime - olderTime;
+        if (interval <= 0.0) {
+            return 1.f;
+        }
+        return (float)((std::clamp(time, olderTime, newerTime + maxExtrapolation) - olderTime) / interval);
+    }
+
+    static inline BodyTracking::Pose InterpolateBodyTrackingPose(const BodyTracking::Pose& a,
+                                                                 const BodyTracking::Pose& b,
+                                                                 float t) {
+        const DirectX::XMVECTOR orientation = DirectX::XMQuaternionNormalize(DirectX::XMQuaternionSlerp(
+            DirectX::XMVectorSet(a.orientation.x, a.orientation.y, a.orientation.z, a.orientation.w),
+            DirectX::XMVectorSet(b.orientation.x, b.orientation.y, b.orientation.z, b.orientation.w),
+            t));
+        const DirectX::XMVECTOR position =
+            DirectX::XMVectorLerp(DirectX::XMVectorSet(a.position.x, a.position.y, a.position.z, 0.f),
+                                  DirectX::XMVectorSet(b.position.x, b.position.y, b.position.z, 0.f),
+                                  t);
+
+        BodyTracking::Pose pose;
+        pose.orientation = {DirectX::XMVectorGetX(orientation),
+                            DirectX::XMVectorGetY(orientation),
+                            DirectX::XMVectorGetZ(orientation),
+                            DirectX::XMVectorGetW(orientation)};
+        pose.position = {
+            DirectX::XMVectorGetX(position), DirectX::XMVectorGetY(position), DirectX::XMVectorGetZ(position)};
+        return pose;
+    }
+
+    static inline BodyTracking::Vector3 InterpolateBodyTrackingVector(const BodyTracking::Vector3& a,
+                                                                      const BodyTracking::Vector3& b,
+                                                                      float t) {
+        return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+    }
+
+} // namespace virtualdesktop_openxr::utils
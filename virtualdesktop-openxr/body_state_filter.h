@@ -0,0 +1,197 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Parameters of the 1€ filter (https://gery.casiez.net/1euro/). The cutoff frequency is raised from minCutoff by
+    // beta times the speed of the signal, which trades jitter at low speed for lag at high speed.
+    struct OneEuroFilterParameters {
+        float minCutoff; // Hz
+        float beta;
+        float derivativeCutoff; // Hz
+    };
+
+    // A 1€ filter for a pose. The position and the orientation are filtered separately, using the linear and angular
+    // speeds respectively.
+    class OneEuroPoseFilter {
+      public:
+        void reset() {
+            m_initialized = false;
+        }
+
+        BodyTracking::Pose filter(const BodyTracking::Pose& pose, float dt, const OneEuroFilterParameters& parameters) {
+            const DirectX::XMVECTOR position =
+                DirectX::XMVectorSet(pose.position.x, pose.position.y, pose.position.z, 0.f);
+            DirectX::XMVECTOR orientation = DirectX::XMVectorSet(
+                pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w);
+            if (!m_initialized || dt <= 0.f) {
+                DirectX::XMStoreFloat3(&m_position, position);
+                DirectX::XMStoreFloat4(&m_orientation, orientation);
+                m_linearSpeed = m_angularSpeed = 0.f;
+                m_initialized = true;
+                return pose;
+            }
+
+            const DirectX::XMVECTOR previousPosition = DirectX::XMLoadFloat3(&m_position);
+            const DirectX::XMVECTOR previousOrientation = DirectX::XMLoadFloat4(&m_orientation);
+
+            // Position.
+            const float linearSpeed =
+                DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(position, previousPosition))) /
+                dt;
+            m_linearSpeed += (linearSpeed - m_linearSpeed) * alpha(parameters.derivativeCutoff, dt);
+            const DirectX::XMVECTOR filteredPosition = DirectX::XMVectorLerp(
+                previousPosition, position, alpha(parameters.minCutoff + parameters.beta * m_linearSpeed, dt));
+
+            // Orientation, taking the shortest path.
+            float cosAngle = DirectX::XMVectorGetX(DirectX::XMVector4Dot(orientation, previousOrientation));
+            if (cosAngle < 0.f) {
+                orientation = DirectX::XMVectorNegate(orientation);
+                cosAngle = -cosAngle;
+            }
+            const float angularSpeed = 2.f * std::acos(std::min(cosAngle, 1.f)) / dt;
+            m_angularSpeed += (angularSpeed - m_angularSpeed) * alpha(parameters.derivativeCutoff, dt);
+            const DirectX::XMVECTOR filteredOrientation = DirectX::XMQuaternionNormalize(DirectX::XMQuaternionSlerp(
+                previousOrientation, orientation, alpha(parameters.minCutoff + parameters.beta * m_angularSpeed, dt)));
+
+            DirectX::XMStoreFloat3(&m_position, filteredPosition);
+            DirectX::XMStoreFloat4(&m_orientation, filteredOrientation);
+
+            BodyTracking::Pose filtered;
+            filtered.position = {m_position.x, m_position.y, m_position.z};
+            filtered.orientation = {m_orientation.x, m_orientation.y, m_orientation.z, m_orientation.w};
+            return filtered;
+        }
+
+      private:
+        // Smoothing factor of an exponential filter with the given cutoff frequency.
+        static float alpha(float cutoff, float dt) {
+            const float r = 2.f * (float)M_PI * cutoff * dt;
+            return r / (r + 1.f);
+        }
+
+        bool m_initialized{false};
+        DirectX::XMFLOAT3 m_position{};
+        DirectX::XMFLOAT4 m_orientation{};
+        float m_linearSpeed{0.f};
+        float m_angularSpeed{0.f};
+    };
+
+    // Filtering of the hands, body and eyes poses in the body state. Each group is only filtered when its minimum
+    // cutoff is not zero. The filter state of a joint is reset whenever the joint is not tracked.
+    class BodyStateFilter {
+      public:
+        BodyStateFilter(const OneEuroFilterParameters& hands,
+                        const OneEuroFilterParameters& body,
+                        const OneEuroFilterParameters& eyes)
+            : m_handsParameters(hands), m_bodyParameters(body), m_eyesParameters(eyes) {
+        }
+
+        bool isEnabled() const {
+            return m_handsParameters.minCutoff > 0.f || m_bodyParameters.minCutoff > 0.f ||
+                   m_eyesParameters.minCutoff > 0.f;
+        }
+
+        void apply(BodyTracking::BodyStateV2& state, double time) {
+            const float dt = m_lastTime ? (float)(time - m_lastTime) : 0.f;
+            m_lastTime = time;
+
+            if (m_handsParameters.minCutoff > 0.f) {
+                filterHand(state.LeftHandActive,
+                           state.LeftHandJointStates,
+                           state.LeftAimState,
+                           m_handFilters[0],
+                           m_aimFilters[0],
+                           dt);
+                filterHand(state.RightHandActive,
+                           state.RightHandJointStates,
+                           state.RightAimState,
+                           m_handFilters[1],
+                           m_aimFilters[1],
+                           dt);
+            }
+
+            if (m_bodyParameters.minCutoff > 0.f) {
+                for (uint32_t i = 0; i < BodyTracking::FullBodyJointCount; i++) {
+                    BodyTracking::BodyJointLocation& joint = state.BodyJoints[i];
+                    if (state.BodyTrackingConfidence > 0.f && xr::math::Pose::IsPoseValid(joint.LocationFlags)) {
+                        joint.Pose = m_bodyFilters[i].filter(joint.Pose, dt, m_bodyParameters);
+                    } else {
+                        m_bodyFilters[i].reset();
+                    }
+                }
+            }
+
+            if (m_eyesParameters.minCutoff > 0.f) {
+                filterPose(state.LeftEyeIsValid, state.LeftEyePose, m_eyeFilters[0], m_eyesParameters, dt);
+                filterPose(state.RightEyeIsValid, state.RightEyePose, m_eyeFilters[1], m_eyesParameters, dt);
+            }
+        }
+
+      private:
+        static void filterPose(bool isValid,
+                               BodyTracking::Pose& pose,
+                               OneEuroPoseFilter& filter,
+                               const OneEuroFilterParameters& parameters,
+                               float dt) {
+            if (isValid) {
+                pose = filter.filter(pose, dt, parameters);
+            } else {
+                filter.reset();
+            }
+        }
+
+        void filterHand(bool isActive,
+                        BodyTracking::FingerJointState* joints,
+                        BodyTracking::HandTrackingAimState& aimState,
+                        OneEuroPoseFilter* filters,
+                        OneEuroPoseFilter& aimFilter,
+                        float dt) {
+            for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                filterPose(isActive, joints[i].Pose, filters[i], m_handsParameters, dt);
+            }
+            filterPose(isActive && (aimState.AimStatus & XR_HAND_TRACKING_AIM_VALID_BIT_FB),
+                       aimState.AimPose,
+                       aimFilter,
+                       m_handsParameters,
+                       dt);
+        }
+
+        const OneEuroFilterParameters m_handsParameters;
+        const OneEuroFilterParameters m_bodyParameters;
+        const OneEuroFilterParameters m_eyesParameters;
+        double m_lastTime{0};
+
+        OneEuroPoseFilter m_handFilters[2][BodyTracking::HandJointCount];
+        OneEuroPoseFilter m_aimFilters[2];
+        OneEuroPoseFilter m_bodyFilters[BodyTracking::FullBodyJointCount];
+        OneEuroPoseFilter m_eyeFilters[2];
+    };
+
+} // namespace virtualdesktop_openxr::utils
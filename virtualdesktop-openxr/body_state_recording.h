@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+#include "body_state_buffer.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // File format for body state recordings. After the header, each frame is made of its time (in seconds, relative to
+    // the first frame), the mask of the sections it carries, then the content of those sections in the order of
+    // BodyStateSection. Only the sections that changed since the previous frame are stored.
+    struct BodyStateRecordingHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t stateSize;
+        uint32_t reserved;
+    };
+
+    constexpr char BodyStateRecordingMagic[4] = {'V', 'D', 'B', 'S'};
+    constexpr uint32_t BodyStateRecordingVersion = 1;
+
+    class BodyStateRecorder {
+      public:
+        bool open(const std::filesystem::path& path) {
+            m_file.open(path, std::ios_base::binary | std::ios_base::trunc);
+            if (!m_file.is_open()) {
+                return false;
+            }
+
+            BodyStateRecordingHeader header{};
+            memcpy(header.magic, BodyStateRecordingMagic, sizeof(header.magic));
+            header.version = BodyStateRecordingVersion;
+            header.stateSize = sizeof(BodyTracking::BodyStateV2);
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            m_frameCount = 0;
+            return m_file.good();
+        }
+
+        bool isOpen() const {
+            return m_file.is_open();
+        }
+
+        // Append a frame with the sections that changed since the previous frame. The first frame always carries the
+        // full state. Nothing is recorded when no section changed.
+        void record(const BodyTracking::BodyStateV2& state, double time) {
+            uint32_t sections = AllBodyStateSections;
+            if (!m_frameCount) {
+                m_startTime = time;
+                m_previousState = std::make_unique<BodyTracking::BodyStateV2>();
+            } else {
+                sections = GetChangedBodyStateSections(state, *m_previousState);
+                if (!sections) {
+                    return;
+                }
+            }
+            *m_previousState = state;
+
+            const double frameTime = time - m_startTime;
+            m_file.write(reinterpret_cast<const char*>(&frameTime), sizeof(frameTime));
+            m_file.write(reinterpret_cast<const char*>(&sections), sizeof(sections));
+            for (uint32_t i = 0; i < (uint32_t)BodyStateSection::Count; i++) {
+                if (sections & (1u << i)) {
+                    m_file.write(reinterpret_cast<const char*>(&state) + BodyStateSections[i].offset,
+                                 BodyStateSections[i].size);
+                }
+            }
+            m_frameCount++;
+        }
+
+        uint64_t frameCount() const {
+            return m_frameCount;
+        }
+
+      private:
+        std::ofstream m_file;
+        std::unique_ptr<BodyTracking::BodyStateV2> m_previousState;
+        double m_startTime{0};
+        uint64_t m_frameCount{0};
+    };
+
+    class BodyStateReplayer {
+      public:
+        bool open(const std::filesystem::path& path) {
+            m_file.open(path, std::ios_base::binary);
+            if (!m_file.is_open()) {
+                return false;
+            }
+
+            BodyStateRecordingHeader header{};
+            m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!m_file.good() || memcmp(header.magic, BodyStateRecordingMagic, sizeof(header.magic)) ||
+                header.version != BodyStateRecordingVersion || header.stateSize != sizeof(BodyTracking::BodyStateV2)) {
+                m_file.close();
+                return false;
+            }
+            return true;
+        }
+
+        bool isOpen() const {
+            return m_file.is_open();
+        }
+
+        // Apply the next frame on top of the state. Returns false at the end of the recording (or if the recording is
+        // truncated), in which case the state is left untouched.
+        bool next(BodyTracking::BodyStateV2& state, double& time) {
+            double frameTime;
+            uint32_t sections;
+            m_file.read(reinterpret_cast<char*>(&frameTime), sizeof(frameTime));
+            m_file.read(reinterpret_cast<char*>(&sections), sizeof(sections));
+            if (!m_file.good() || (sections & ~AllBodyStateSections)) {
+                return false;
+            }
+
+            BodyTracking::BodyStateV2 frame = state;
+            for (uint32_t i = 0; i < (uint32_t)BodyStateSection::Count; i++) {
+                if (sections & (1u << i)) {
+                    m_file.read(reinterpret_cast<char*>(&frame) + BodyStateSections[i].offset,
+                                BodyStateSections[i].size);
+                }
+            }
+            if (!m_file.good()) {
+                return false;
+            }
+
+            state = frame;
+            time = frameTime;
+            return true;
+        }
+
+        // Go back to the first frame.
+        void rewind() {
+            m_file.clear();
+            m_file.seekg(sizeof(BodyStateRecordingHeader));
+        }
+
+      private:
+        std::ifstream m_file;
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+#include "body_state_recording.h"
+#include "synthetic_body_state.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // A producer of body state updates. Only used from the body state watcher thread.
+    struct IBodyStateSource {
+        virtual ~IBodyStateSource() = default;
+
+        // Wait for the next update, for up to the timeout. Returns true if an update was signaled. Sources that are not
+        // signaled must be polled after this returns.
+        virtual bool waitForUpdate(std::chrono::milliseconds timeout) = 0;
+
+        // Whether updates are signaled by waitForUpdate().
+        virtual bool isSignaled() const = 0;
+
+        // Whether the data is coming from the headset. Other sources may contain any kind of data, regardless of the
+        // capabilities of the headset.
+        virtual bool isLive() const = 0;
+
+        // The latest state, and the time it was produced.
+        virtual const BodyTracking::BodyStateV2& getState() const = 0;
+        virtual double getUpdateTime() const = 0;
+    };
+
+    // The body state shared by Virtual Desktop through a memory mapped file.
+    class MmfBodyStateSource : public IBodyStateSource {
+      public:
+        // Takes ownership of the file mapping and its view.
+        MmfBodyStateSource(wil::unique_handle file, const BodyTracking::BodyStateV2* state, wil::unique_handle event)
+            : m_file(std::move(file)), m_state(state), m_event(std::move(event)) {
+        }
+
+        ~MmfBodyStateSource() override {
+            UnmapViewOfFile(m_state);
+        }
+
+        bool waitForUpdate(std::chrono::milliseconds timeout) override {
+            // Without an event, return immediately and let the caller poll.
+            return m_event && WaitForSingleObject(m_event.get(), (DWORD)timeout.count()) == WAIT_OBJECT_0;
+        }
+
+        bool isSignaled() const override {
+            return !!m_event;
+        }
+
+        bool isLive() const override {
+            return true;
+        }
+
+        const BodyTracking::BodyStateV2& getState() const override {
+            return *m_state;
+        }
+
+        double getUpdateTime() const override {
+            // The producer does not timestamp its updates.
+            return ovr_GetTimeInSeconds();
+        }
+
+      private:
+        const wil::unique_handle m_file;
+        const BodyTracking::BodyStateV2* const m_state;
+        const wil::unique_handle m_event;
+    };
+
+    // Base for the sources producing updates on their own schedule.
+    class ScheduledBodyStateSource : public IBodyStateSource {
+      public:
+        bool isSignaled() const override {
+            return true;
+        }
+
+        bool isLive() const override {
+            return false;
+        }
+
+        const BodyTracking::BodyStateV2& getState() const override {
+            return m_state;
+        }
+
+        double getUpdateTime() const override {
+            return m_updateTime;
+        }
+
+      protected:
+        ScheduledBodyStateSource()
+            : m_timer(
+                  CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS)) {
+        }
+
+        // Sleep until the requested time, but no longer than the timeout. Returns true if the time was reached.
+        bool sleepUntil(double time, std::chrono::milliseconds timeout) {
+            const double deadline = std::min(time, ovr_GetTimeInSeconds() + timeout.count() / 1000.0);
+            double now;
+            while ((now = ovr_GetTimeInSeconds()) < deadline) {
+                const std::chrono::duration<double> duration(deadline - now);
+                LARGE_INTEGER dueTime;
+                dueTime.QuadPart = -std::max((LONGLONG)(duration.count() * 10'000'000), 1LL);
+                if (m_timer && SetWaitableTimer(m_timer.get(), &dueTime, 0, nullptr, nullptr, false)) {
+                    WaitForSingleObject(m_timer.get(), INFINITE);
+                } else {
+                    std::this_thread::sleep_for(duration);
+                }
+            }
+            return now >= time;
+        }
+
+        BodyTracking::BodyStateV2 m_state{};
+        double m_updateTime{0};
+
+      private:
+        const wil::unique_handle m_timer;
+    };
+
+    // Replay a recording made with BodyStateRecorder. The recording loops at its end. Updates are timestamped with
+    // their scheduled time, so that the same recording always yields the same sequence of updates.
+    class ReplayBodyStateSource : public ScheduledBodyStateSource {
+      public:
+        // The speed is a time scaling factor (1 is the recorded speed).
+        static std::unique_ptr<ReplayBodyStateSource> open(const std::filesystem::path& path, double speed) {
+            std::unique_ptr<ReplayBodyStateSource> source(new ReplayBodyStateSource(speed));
+            if (!source->m_replayer.open(path)) {
+                return {};
+            }
+            return source;
+        }
+
+        bool waitForUpdate(std::chrono::milliseconds timeout) override {
+            if (!m_hasPendingFrame) {
+                if (!m_replayer.next(m_pendingState, m_pendingFrameTime)) {
+                    // Loop back to the beginning of the recording.
+                    m_replayer.rewind();
+                    if (!m_replayer.next(m_pendingState, m_pendingFrameTime)) {
+                        std::this_thread::sleep_for(timeout);
+                        return false;
+                    }
+                    m_startTime = 0;
+                }
+                m_hasPendingFrame = true;
+            }
+
+            // Start the clock upon the first wait, so that we do not replay a burst of late frames.
+            if (!m_startTime) {
+                m_startTime = ovr_GetTimeInSeconds() - m_pendingFrameTime / m_speed;
+            }
+
+            const double updateTime = m_startTime + m_pendingFrameTime / m_speed;
+            if (!sleepUntil(updateTime, timeout)) {
+                return false;
+            }
+
+            m_state = m_pendingState;
+            m_updateTime = updateTime;
+            m_hasPendingFrame = false;
+            return true;
+        }
+
+      private:
+        ReplayBodyStateSource(double speed) : m_speed(speed) {
+        }
+
+        const double m_speed;
+        BodyStateReplayer m_replayer;
+        BodyTracking::BodyStateV2 m_pendingState{};
+        double m_pendingFrameTime{0};
+        bool m_hasPendingFrame{false};
+        double m_startTime{0};
+    };
+
+    // Synthetic body state (see SyntheticBodyState) produced at a fixed rate.
+    class SyntheticBodyStateSource : public ScheduledBodyStateSource {
+      public:
+        SyntheticBodyStateSource(double rate) : m_period(1.0 / rate) {
+        }
+
+        bool waitForUpdate(std::chrono::milliseconds timeout) override {
+            if (!m_nextUpdateTime) {
+                m_nextUpdateTime = ovr_GetTimeInSeconds();
+            }
+            if (!sleepUntil(m_nextUpdateTime, timeout)) {
+                return false;
+            }
+
+            m_updateTime = m_nextUpdateTime;
+            m_nextUpdateTime += m_period;
+            SyntheticBodyState::animate(m_state, m_updateTime);
+            return true;
+        }
+
+      private:
+        const double m_period;
+        double m_nextUpdateTime{0};
+    };
+
+} // namespace virtualdesktop_openxr::utils
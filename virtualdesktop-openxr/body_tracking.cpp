@@ -35,6 +35,34 @@
 // Implement emulation for XR_HTCX_vive_tracker_interaction using the body tracking data.
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_HTCX_vive_tracker_interaction
 
+namespace {
+
+    using namespace virtualdesktop_openxr;
+
+    // The subset of the body state needed for body tracking.
+    struct BodyJointsState {
+        float BodyTrackingConfidence;
+        bool BodyTrackingHighFidelity;
+        BodyTracking::BodyJointLocation BodyJoints[BodyTracking::FullBodyJointCount];
+        int32_t SkeletonChangedCount;
+    };
+
+    BodyTracking::BodyJointLocation blendBodyJoint(const BodyTracking::BodyJointLocation& older,
+                                                   const BodyTracking::BodyJointLocation& newer,
+                                                   float t) {
+        // Only blend when the joint was located in both snapshots.
+        if (!(xr::math::Pose::IsPoseValid(older.LocationFlags) && xr::math::Pose::IsPoseValid(newer.LocationFlags))) {
+            return newer;
+        }
+
+        BodyTracking::BodyJointLocation location;
+        location.LocationFlags = newer.LocationFlags;
+        location.Pose = utils::InterpolateBodyTrackingPose(older.Pose, newer.Pose, t);
+        return location;
+    }
+
+} // namespace
+
 namespace virtualdesktop_openxr {
 
     using namespace virtualdesktop_openxr::log;
@@ -161,16 +189,34 @@ namespace virtualdesktop_openxr {
         const auto flags = locateSpaceToOrigin(xrBaseSpace, locateInfo->time, baseSpaceToVirtual, nullptr, nullptr);
 
         {
-            std::shared_lock lock(m_bodyStateMutex);
+            // Take a private snapshot of the body state, at the requested time.
+            BodyJointsState body;
+            const double time = xrTimeToOvrTime(locateInfo->time);
+            const auto blend = [&](const BodyTracking::BodyStateV2& older,
+                                   double olderTime,
+                                   const BodyTracking::BodyStateV2& newer,
+                                   double newerTime) {
+                const float t = GetBodyStateBlendFactor(olderTime, newerTime, time, m_bodyStateMaxExtrapolation);
+                body.BodyTrackingConfidence = newer.BodyTrackingConfidence;
+                body.BodyTrackingHighFidelity = newer.BodyTrackingHighFidelity;
+                for (uint32_t i = 0; i < BodyTracking::FullBodyJointCount; i++) {
+                    body.BodyJoints[i] = blendBodyJoint(older.BodyJoints[i], newer.BodyJoints[i], t);
+                }
+                body.SkeletonChangedCount = newer.SkeletonChangedCount;
+            };
+            m_bodyStateBuffer.readAt(BodyStateSection::Body, time, blend);
+            if (isBodyStateStale(BodyStateSection::Body)) {
+                body.BodyTrackingConfidence = 0.f;
+            }
 
             // Check the hand state.
-            if (m_bodyState && m_cachedBodyState.BodyTrackingConfidence > 0.f) {
-                const BodyTracking::BodyJointLocation* const joints = m_cachedBodyState.BodyJoints;
+            if (m_bodyStateSource && body.BodyTrackingConfidence > 0.f) {
+                const BodyTracking::BodyJointLocation* const joints = body.BodyJoints;
 
                 TraceLoggingWrite(
                     g_traceProvider,
                     "xrLocateBodyJointsFB",
-                    TLArg(m_cachedBodyState.BodyTrackingConfidence, "BodyTrackingConfidence"),
+                    TLArg(body.BodyTrackingConfidence, "BodyTrackingConfidence"),
                     TLArg(joints[XR_FULL_BODY_JOINT_ROOT_META].LocationFlags, "RootLocationFlags"),
                     TLArg(xr::ToString(joints[XR_FULL_BODY_JOINT_ROOT_META].Pose).c_str(), "Root"),
                     TLArg(joints[XR_FULL_BODY_JOINT_HIPS_META].LocationFlags, "HipsLocationFlags"),
@@ -191,7 +237,7 @@ namespace virtualdesktop_openxr {
             } else {
                 TraceLoggingWrite(g_traceProvider,
                                   "xrLocateBodyJointsFB",
-                                  TLArg(m_cachedBodyState.BodyTrackingConfidence, "BodyTrackingConfidence"));
+                                  TLArg(body.BodyTrackingConfidence, "BodyTrackingConfidence"));
 
                 locations->isActive = XR_FALSE;
             }
@@ -199,7 +245,7 @@ namespace virtualdesktop_openxr {
             // Report the fidelity.
             if (has_XR_META_body_tracking_fidelity && fidelityStatus) {
                 fidelityStatus->fidelity = (xrBodyTracker.maxFidelity == XR_BODY_TRACKING_FIDELITY_HIGH_META &&
-                                            m_cachedBodyState.BodyTrackingHighFidelity)
+                                            body.BodyTrackingHighFidelity)
                                                ? XR_BODY_TRACKING_FIDELITY_HIGH_META
                                                : XR_BODY_TRACKING_FIDELITY_LOW_META;
             }
@@ -225,18 +271,18 @@ namespace virtualdesktop_openxr {
                 (std::abs(floorHeight) >= FLT_EPSILON) ? Pose::Translation({0, floorHeight, 0}) : Pose::Identity();
             const XrPosef basePose = Pose::Multiply(jointsToVirtual, Pose::Invert(baseSpaceToVirtual));
 
-            locations->confidence = m_cachedBodyState.BodyTrackingConfidence;
+            locations->confidence = body.BodyTrackingConfidence;
             for (uint32_t i = 0; i < locations->jointCount; i++) {
-                locations->jointLocations[i].locationFlags = m_cachedBodyState.BodyJoints[i].LocationFlags;
+                locations->jointLocations[i].locationFlags = body.BodyJoints[i].LocationFlags;
                 if (Pose::IsPoseValid(locations->jointLocations[i].locationFlags)) {
                     const XrPosef poseOfBodyJoint = Pose::Multiply(
-                        xr::math::Pose::MakePose(XrQuaternionf{m_cachedBodyState.BodyJoints[i].Pose.orientation.x,
-                                                               m_cachedBodyState.BodyJoints[i].Pose.orientation.y,
-                                                               m_cachedBodyState.BodyJoints[i].Pose.orientation.z,
-                                                               m_cachedBodyState.BodyJoints[i].Pose.orientation.w},
-                                                 XrVector3f{m_cachedBodyState.BodyJoints[i].Pose.position.x,
-                                                            m_cachedBodyState.BodyJoints[i].Pose.position.y,
-                                                            m_cachedBodyState.BodyJoints[i].Pose.position.z}),
+                        xr::math::Pose::MakePose(XrQuaternionf{body.BodyJoints[i].Pose.orientation.x,
+                                                               body.BodyJoints[i].Pose.orientation.y,
+                                                               body.BodyJoints[i].Pose.orientation.z,
+                                                               body.BodyJoints[i].Pose.orientation.w},
+                                                 XrVector3f{body.BodyJoints[i].Pose.position.x,
+                                                            body.BodyJoints[i].Pose.position.y,
+                                                            body.BodyJoints[i].Pose.position.z}),
                         basePose);
 
                     locations->jointLocations[i].pose =
@@ -250,7 +296,7 @@ namespace virtualdesktop_openxr {
                                   TLArg(xr::ToString(locations->jointLocations[i].pose).c_str(), "Pose"));
             }
 
-            locations->skeletonChangedCount = m_cachedBodyState.SkeletonChangedCount;
+            locations->skeletonChangedCount = body.SkeletonChangedCount;
         }
 
         return XR_SUCCESS;
@@ -277,7 +323,7 @@ namespace virtualdesktop_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        const BodyTracker& xrBodyTracker = *(BodyTracker*)bodyTracker;
+        BodyTracker& xrBodyTracker = *(BodyTracker*)bodyTracker;
 
         if ((!xrBodyTracker.useFullBody && skeleton->jointCount != XR_BODY_JOINT_COUNT_FB) ||
             (xrBodyTracker.useFullBody && skeleton->jointCount != XR_FULL_BODY_JOINT_COUNT_META)) {
@@ -285,21 +331,42 @@ namespace virtualdesktop_openxr {
         }
 
         // Forward the state from the memory mapped file.
-        if (m_bodyState) {
-            std::shared_lock lock(m_bodyStateMutex);
-
-            for (uint32_t i = 0; i < skeleton->jointCount; i++) {
-                skeleton->joints[i].joint = m_cachedBodyState.SkeletonJoints[i].Joint;
-                skeleton->joints[i].parentJoint = m_cachedBodyState.SkeletonJoints[i].ParentJoint;
-                skeleton->joints[i].pose =
-                    xr::math::Pose::MakePose(XrQuaternionf{m_cachedBodyState.SkeletonJoints[i].Pose.orientation.x,
-                                                           m_cachedBodyState.SkeletonJoints[i].Pose.orientation.y,
-                                                           m_cachedBodyState.SkeletonJoints[i].Pose.orientation.z,
-                                                           m_cachedBodyState.SkeletonJoints[i].Pose.orientation.w},
-                                             XrVector3f{m_cachedBodyState.SkeletonJoints[i].Pose.position.x,
-                                                        m_cachedBodyState.SkeletonJoints[i].Pose.position.y,
-                                                        m_cachedBodyState.SkeletonJoints[i].Pose.position.z});
+        if (m_bodyStateSource) {
+            std::unique_lock skeletonLock(xrBodyTracker.skeletonMutex);
+
+            // Only convert the skeleton again when it changed.
+            int32_t skeletonChangedCount;
+            m_bodyStateBuffer.read(
+                [&](const BodyTracking::BodyStateV2& state) { skeletonChangedCount = state.SkeletonChangedCount; });
+            const bool isCached = xrBodyTracker.skeleton.isCurrent(skeletonChangedCount);
+            if (!isCached) {
+                BodyTracking::SkeletonJoint skeletonJoints[BodyTracking::FullBodyJointCount];
+                m_bodyStateBuffer.read([&](const BodyTracking::BodyStateV2& state) {
+                    std::copy_n(state.SkeletonJoints, BodyTracking::FullBodyJointCount, skeletonJoints);
+                    skeletonChangedCount = state.SkeletonChangedCount;
+                });
+
+                XrBodySkeletonJointFB* const cachedJoints = xrBodyTracker.skeleton.store(skeletonChangedCount);
+                for (uint32_t i = 0; i < BodyTracking::FullBodyJointCount; i++) {
+                    cachedJoints[i].joint = skeletonJoints[i].Joint;
+                    cachedJoints[i].parentJoint = skeletonJoints[i].ParentJoint;
+                    cachedJoints[i].pose =
+                        xr::math::Pose::MakePose(XrQuaternionf{skeletonJoints[i].Pose.orientation.x,
+                                                               skeletonJoints[i].Pose.orientation.y,
+                                                               skeletonJoints[i].Pose.orientation.z,
+                                                               skeletonJoints[i].Pose.orientation.w},
+                                                 XrVector3f{skeletonJoints[i].Pose.position.x,
+                                                            skeletonJoints[i].Pose.position.y,
+                                                            skeletonJoints[i].Pose.position.z});
+                }
             }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrGetBodySkeletonFB",
+                              TLArg(skeletonChangedCount, "SkeletonChangedCount"),
+                              TLArg(isCached, "Cached"));
+
+            std::copy_n(xrBodyTracker.skeleton.joints(), skeleton->jointCount, skeleton->joints);
         } else {
             for (uint32_t i = 0; i < skeleton->jointCount; i++) {
                 skeleton->joints[i].joint = i;
@@ -452,16 +519,29 @@ namespace virtualdesktop_openxr {
     }
 
     XrSpaceLocationFlags OpenXrRuntime::getBodyJointPose(XrFullBodyJointMETA joint, XrTime time, XrPosef& pose) const {
-        std::shared_lock lock(m_bodyStateMutex);
+        float bodyTrackingConfidence = 0.f;
+        BodyTracking::BodyJointLocation location{};
+        const double ovrTime = xrTimeToOvrTime(time);
+        const auto blend = [&](const BodyTracking::BodyStateV2& older,
+                               double olderTime,
+                               const BodyTracking::BodyStateV2& newer,
+                               double newerTime) {
+            const float t = GetBodyStateBlendFactor(olderTime, newerTime, ovrTime, m_bodyStateMaxExtrapolation);
+            bodyTrackingConfidence = newer.BodyTrackingConfidence;
+            location = blendBodyJoint(older.BodyJoints[joint], newer.BodyJoints[joint], t);
+        };
+        m_bodyStateBuffer.readAt(BodyStateSection::Body, ovrTime, blend);
+        if (isBodyStateStale(BodyStateSection::Body)) {
+            bodyTrackingConfidence = 0.f;
+        }
 
         TraceLoggingWrite(g_traceProvider,
                           "VirtualDesktopBodyTracker",
-                          TLArg(m_cachedBodyState.BodyTrackingConfidence, "BodyTrackingConfidence"));
-        if (!m_cachedBodyState.BodyTrackingConfidence) {
+                          TLArg(bodyTrackingConfidence, "BodyTrackingConfidence"));
+        if (!bodyTrackingConfidence) {
             return 0;
         }
 
-        const BodyTracking::BodyJointLocation& location = m_cachedBodyState.BodyJoints[joint];
         TraceLoggingWrite(g_traceProvider,
                           "VirtualDesktopBodyTracker",
                           TLArg((int)joint, "JointIndex"),
@@ -450,10 +450,9 @@ namespace virtualdesktop_openxr {
     void OpenXrRuntime::prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
                                                        uint32_t layerIndex,
                                                        uint32_t slice,
-                                                       XrCompositionLayerFlags compositionFlags,
-                                                       std::set<std::pair<ovrTextureSwapChain, uint32_t>>& committed) {
-        // If the texture was never used or already committed, do nothing.
-        if (xrSwapchain.slices[0].empty() || committed.count(std::make_pair(xrSwapchain.ovrSwapchain[0], slice))) {
+                                                       XrCompositionLayerFlags compositionFlags) {
+        // If the texture was never used or already committed during this frame, do nothing.
+        if (xrSwapchain.slices[0].empty() || xrSwapchain.commits.isCommitted(slice, m_commitFrameId)) {
             return;
         }
 
@@ -618,7 +617,7 @@ namespace virtualdesktop_openxr {
 
         // Commit the texture to OVR.
         CHECK_OVRCMD(ovr_CommitTextureSwapChain(m_ovrSession, xrSwapchain.ovrSwapchain[slice]));
-        committed.insert(std::make_pair(xrSwapchain.ovrSwapchain[0], slice));
+        xrSwapchain.commits.markCommitted(slice, m_commitFrameId);
     }
 
     void OpenXrRuntime::ensureSwapchainSliceResources(Swapchain& xrSwapchain, uint32_t slice) const {
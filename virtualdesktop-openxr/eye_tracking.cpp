@@ -30,6 +30,48 @@
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_EXT_eye_gaze_interaction
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_FB_eye_tracking_social
 
+namespace {
+
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    // The subset of the body state needed for eye tracking.
+    struct EyesState {
+        bool LeftEyeIsValid;
+        bool RightEyeIsValid;
+        BodyTracking::Pose LeftEyePose;
+        BodyTracking::Pose RightEyePose;
+        float LeftEyeConfidence;
+        float RightEyeConfidence;
+    };
+
+    uint64_t readEyesState(const BodyStateBuffer& buffer, EyesState& eyes) {
+        return buffer.read([&](const BodyTracking::BodyStateV2& state) {
+            eyes.LeftEyeIsValid = state.LeftEyeIsValid;
+            eyes.RightEyeIsValid = state.RightEyeIsValid;
+            eyes.LeftEyePose = state.LeftEyePose;
+            eyes.RightEyePose = state.RightEyePose;
+            eyes.LeftEyeConfidence = state.LeftEyeConfidence;
+            eyes.RightEyeConfidence = state.RightEyeConfidence;
+        });
+    }
+
+    // The shortest rotation from one unit vector to another.
+    DirectX::XMVECTOR getRotationBetween(const XrVector3f& from, const XrVector3f& to) {
+        const DirectX::XMVECTOR a = xr::math::LoadXrVector3(from);
+        const DirectX::XMVECTOR b = xr::math::LoadXrVector3(to);
+        const DirectX::XMVECTOR axis = DirectX::XMVector3Cross(a, b);
+        const float sinAngle = DirectX::XMVectorGetX(DirectX::XMVector3Length(axis));
+        if (sinAngle <= FLT_EPSILON) {
+            return DirectX::XMQuaternionIdentity();
+        }
+        return DirectX::XMQuaternionRotationNormal(
+            DirectX::XMVectorScale(axis, 1.f / sinAngle),
+            std::atan2(sinAngle, DirectX::XMVectorGetX(DirectX::XMVector3Dot(a, b))));
+    }
+
+} // namespace
+
 namespace virtualdesktop_openxr {
 
     using namespace virtualdesktop_openxr::log;
@@ -120,14 +162,18 @@ namespace virtualdesktop_openxr {
         }
 
         // Forward the state from the memory mapped file.
-        if (m_bodyState) {
-            std::shared_lock lock(m_bodyStateMutex);
+        if (m_bodyStateSource) {
+            EyesState eyes;
+            readEyesState(m_bodyStateBuffer, eyes);
+            if (isBodyStateStale(BodyStateSection::Eyes)) {
+                eyes.LeftEyeIsValid = eyes.RightEyeIsValid = false;
+            }
 
-            eyeGazes->gaze[xr::Side::Left].gazeConfidence = m_cachedBodyState.LeftEyeConfidence;
-            eyeGazes->gaze[xr::Side::Right].gazeConfidence = m_cachedBodyState.RightEyeConfidence;
+            eyeGazes->gaze[xr::Side::Left].gazeConfidence = eyes.LeftEyeConfidence;
+            eyeGazes->gaze[xr::Side::Right].gazeConfidence = eyes.RightEyeConfidence;
 
-            BodyTracking::Pose leftEyePose = m_cachedBodyState.LeftEyePose;
-            BodyTracking::Pose rightEyePose = m_cachedBodyState.RightEyePose;
+            BodyTracking::Pose leftEyePose = eyes.LeftEyePose;
+            BodyTracking::Pose rightEyePose = eyes.RightEyePose;
             XrPosef eyeGaze[] = {
                 xr::math::Pose::MakePose(
                     XrQuaternionf{leftEyePose.orientation.x,
@@ -142,9 +188,37 @@ namespace virtualdesktop_openxr {
                                   rightEyePose.orientation.w},
                     XrVector3f{rightEyePose.position.x, rightEyePose.position.y, rightEyePose.position.z})};
 
+            // Use the prediction at the requested time when available: both eyes are rotated from the latest sampled
+            // gaze to the predicted gaze, and report the confidence in the prediction.
+            if (eyes.LeftEyeIsValid && eyes.RightEyeIsValid) {
+                GazeModel gaze;
+                {
+                    std::unique_lock lock(m_gazeModelMutex);
+                    gaze = m_gazeModel;
+                }
+                if (gaze.isValid) {
+                    XrVector3f predicted;
+                    const float confidence = gaze.predict(xrTimeToOvrTime(gazeInfo->time), predicted);
+                    const DirectX::XMVECTOR correction =
+                        getRotationBetween(GetGazeDirection(leftEyePose, rightEyePose), predicted);
+                    for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                        StoreXrQuaternion(&eyeGaze[side].orientation,
+                                          DirectX::XMQuaternionNormalize(DirectX::XMQuaternionMultiply(
+                                              LoadXrQuaternion(eyeGaze[side].orientation), correction)));
+                        eyeGazes->gaze[side].gazeConfidence = confidence;
+                    }
+
+                    TraceLoggingWrite(g_traceProvider,
+                                      "xrGetEyeGazesFB_Prediction",
+                                      TLArg(xrTimeToOvrTime(gazeInfo->time) - gaze.time, "PredictionTime"),
+                                      TLArg(gaze.isSaccade, "IsSaccade"),
+                                      TLArg(confidence, "Confidence"));
+                }
+            }
+
             eyeGazes->gaze[xr::Side::Left].isValid = XR_FALSE;
             eyeGazes->gaze[xr::Side::Right].isValid = XR_FALSE;
-            if (m_cachedBodyState.LeftEyeIsValid || m_cachedBodyState.RightEyeIsValid) {
+            if (eyes.LeftEyeIsValid || eyes.RightEyeIsValid) {
                 // TODO: Need optimization here, in all likelyhood, the caller is looking for eye gaze relative to VIEW
                 // space, in which case we are doing 2 back-to-back getHmdPose() that are cancelling each other.
                 Space& xrBaseSpace = *(Space*)gazeInfo->baseSpace;
@@ -154,12 +228,12 @@ namespace virtualdesktop_openxr {
                     Pose::IsPoseValid(
                         locateSpaceToOrigin(xrBaseSpace, gazeInfo->time, baseSpaceToVirtual, nullptr, nullptr))) {
                     // Combine the poses.
-                    if (m_cachedBodyState.LeftEyeIsValid) {
+                    if (eyes.LeftEyeIsValid) {
                         eyeGazes->gaze[xr::Side::Left].gazePose = Pose::Multiply(
                             Pose::Multiply(eyeGaze[xr::Side::Left], headPose), Pose::Invert(baseSpaceToVirtual));
                         eyeGazes->gaze[xr::Side::Left].isValid = XR_TRUE;
                     }
-                    if (m_cachedBodyState.RightEyeIsValid) {
+                    if (eyes.RightEyeIsValid) {
                         eyeGazes->gaze[xr::Side::Right].gazePose = Pose::Multiply(
                             Pose::Multiply(eyeGaze[xr::Side::Right], headPose), Pose::Invert(baseSpaceToVirtual));
                         eyeGazes->gaze[xr::Side::Right].isValid = XR_TRUE;
@@ -172,7 +246,7 @@ namespace virtualdesktop_openxr {
             eyeGazes->gaze[xr::Side::Left].gazePose = eyeGazes->gaze[xr::Side::Right].gazePose = Pose::Identity();
         }
 
-        // We do not do any extrapolation.
+        // Without the gaze prediction, this is the latest sample and we do not do any extrapolation.
         eyeGazes->time = gazeInfo->time;
 
         TraceLoggingWrite(g_traceProvider,
@@ -190,53 +264,54 @@ namespace virtualdesktop_openxr {
 
     bool OpenXrRuntime::getEyeGaze(XrTime time, bool getStateOnly, XrVector3f& unitVector, XrTime& sampleTime) const {
         if (m_eyeTrackingType == EyeTracking::Mmf) {
-            std::shared_lock lock(m_bodyStateMutex);
+            // Use the prediction at the requested time when available.
+            GazeModel gaze;
+            {
+                std::unique_lock lock(m_gazeModelMutex);
+                gaze = m_gazeModel;
+            }
+            if (gaze.isValid && !isBodyStateStale(BodyStateSection::Eyes)) {
+                const float confidence = gaze.predict(xrTimeToOvrTime(time), unitVector);
+                sampleTime = time;
+
+                TraceLoggingWrite(g_traceProvider,
+                                  "VirtualDesktopEyeTracker_Prediction",
+                                  TLArg(xrTimeToOvrTime(time) - gaze.time, "PredictionTime"),
+                                  TLArg(gaze.isSaccade, "IsSaccade"),
+                                  TLArg(confidence, "Confidence"),
+                                  TLArg(xr::ToString(unitVector).c_str(), "Gaze"));
+                return true;
+            }
+
+            EyesState eyes;
+            readEyesState(m_bodyStateBuffer, eyes);
+            if (isBodyStateStale(BodyStateSection::Eyes)) {
+                eyes.LeftEyeIsValid = eyes.RightEyeIsValid = false;
+            }
 
             TraceLoggingWrite(g_traceProvider,
                               "VirtualDesktopEyeTracker",
-                              TLArg(!!m_cachedBodyState.LeftEyeIsValid, "LeftValid"),
-                              TLArg(m_cachedBodyState.LeftEyeConfidence, "LeftConfidence"),
-                              TLArg(!!m_cachedBodyState.RightEyeIsValid, "RightValid"),
-                              TLArg(m_cachedBodyState.RightEyeConfidence, "RightConfidence"));
+                              TLArg(!!eyes.LeftEyeIsValid, "LeftValid"),
+                              TLArg(eyes.LeftEyeConfidence, "LeftConfidence"),
+                              TLArg(!!eyes.RightEyeIsValid, "RightValid"),
+                              TLArg(eyes.RightEyeConfidence, "RightConfidence"));
 
-            if (!(m_cachedBodyState.LeftEyeIsValid && m_cachedBodyState.RightEyeIsValid)) {
+            if (!(eyes.LeftEyeIsValid && eyes.RightEyeIsValid)) {
                 return false;
             }
-            if (!(m_cachedBodyState.LeftEyeConfidence > 0.5f && m_cachedBodyState.RightEyeConfidence > 0.5f)) {
+            if (!(eyes.LeftEyeConfidence > 0.5f && eyes.RightEyeConfidence > 0.5f)) {
                 return false;
             }
 
-            BodyTracking::Pose leftEyePose = m_cachedBodyState.LeftEyePose;
-            BodyTracking::Pose rightEyePose = m_cachedBodyState.RightEyePose;
-            XrPosef eyeGaze[] = {
-                xr::math::Pose::MakePose(
-                    XrQuaternionf{leftEyePose.orientation.x,
-                                  leftEyePose.orientation.y,
-                                  leftEyePose.orientation.z,
-                                  leftEyePose.orientation.w},
-                    XrVector3f{leftEyePose.position.x, leftEyePose.position.y, leftEyePose.position.z}),
-                xr::math::Pose::MakePose(
-                    XrQuaternionf{rightEyePose.orientation.x,
-                                  rightEyePose.orientation.y,
-                                  rightEyePose.orientation.z,
-                                  rightEyePose.orientation.w},
-                    XrVector3f{rightEyePose.position.x, rightEyePose.position.y, rightEyePose.position.z})};
+            unitVector = GetGazeDirection(eyes.LeftEyePose, eyes.RightEyePose);
 
             TraceLoggingWrite(g_traceProvider,
                               "VirtualDesktopEyeTracker",
-                              TLArg(xr::ToString(eyeGaze[xr::Side::Left]).c_str(), "LeftGazePose"),
-                              TLArg(xr::ToString(eyeGaze[xr::Side::Right]).c_str(), "RightGazePose"));
-
-            // Average the poses from both eyes.
-            const auto gaze =
-                xr::math::LoadXrPose(xr::math::Pose::Slerp(eyeGaze[xr::Side::Left], eyeGaze[xr::Side::Right], 0.5f));
-            const auto gazeProjectedPoint =
-                DirectX::XMVector3Transform(DirectX::XMVectorSet(0.f, 0.f, -1.f, 1.f), gaze);
-
-            unitVector = xr::math::Normalize(
-                {gazeProjectedPoint.m128_f32[0], gazeProjectedPoint.m128_f32[1], gazeProjectedPoint.m128_f32[2]});
+                              TLArg(xr::ToString(unitVector).c_str(), "Gaze"));
 
-            sampleTime = time;
+            // Report when the gaze was last updated by the producer.
+            const double updateTime = m_bodyStateBuffer.lastUpdateTime(BodyStateSection::Eyes);
+            sampleTime = updateTime > 0 ? std::min(ovrTimeToXrTime(updateTime), time) : time;
 
         } else if (m_eyeTrackingType == EyeTracking::Simulated) {
             XrVector2f point{0.5f, 0.5f};
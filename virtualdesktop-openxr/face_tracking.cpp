@@ -30,6 +30,82 @@
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_FB_face_tracking
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_FB_face_tracking2
 
+namespace {
+
+    using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
+
+    // A contiguous run of expressions copied from the body state into an application-facing expression set.
+    struct FaceExpressionRun {
+        uint32_t source;
+        uint32_t destination;
+        uint32_t count;
+    };
+
+    // The XR_FB_face_tracking expressions are the first ones of XR_FB_face_tracking2, which is what Virtual Desktop
+    // sends us.
+    constexpr FaceExpressionRun FaceExpressionSetFB[] = {{0, 0, XR_FACE_EXPRESSION_COUNT_FB}};
+    constexpr FaceExpressionRun FaceExpressionSet2FB[] = {{0, 0, XR_FACE_EXPRESSION2_COUNT_FB}};
+
+    struct FaceExpressionsState {
+        bool isValid;
+        bool isEyeFollowingBlendshapesValid;
+        float confidences[BodyTracking::ConfidenceCount];
+    };
+
+    void blendFaceExpressions(const float* older, const float* newer, float t, uint32_t count, float* weights) {
+        using namespace DirectX;
+
+        // Weights are not extrapolated beyond their valid range.
+        const XMVECTOR vt = XMVectorReplicate(t);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const XMVECTOR weight = XMVectorSaturate(
+                XMVectorLerpV(XMLoadFloat4((const XMFLOAT4*)&older[i]), XMLoadFloat4((const XMFLOAT4*)&newer[i]), vt));
+            XMStoreFloat4((XMFLOAT4*)&weights[i], weight);
+        }
+        for (; i < count; i++) {
+            weights[i] = std::clamp(older[i] + (newer[i] - older[i]) * t, 0.f, 1.f);
+        }
+    }
+
+    // Read the face expressions resolved at the requested time (in OVR time) and remapped into an expression set.
+    template <size_t RunCount>
+    void readFaceExpressionsAt(const BodyStateBuffer& buffer,
+                               double time,
+                               double maxExtrapolation,
+                               const FaceExpressionRun (&runs)[RunCount],
+                               float* weights,
+                               FaceExpressionsState& face) {
+        const auto blend = [&](const BodyTracking::BodyStateV2& older,
+                               double olderTime,
+                               const BodyTracking::BodyStateV2& newer,
+                               double newerTime) {
+            face.isValid = newer.FaceIsValid;
+            face.isEyeFollowingBlendshapesValid = newer.IsEyeFollowingBlendshapesValid;
+            std::copy_n(newer.ExpressionConfidences, BodyTracking::ConfidenceCount, face.confidences);
+
+            // Only blend with the older snapshot when the face was tracked in both.
+            const float t =
+                older.FaceIsValid ? GetBodyStateBlendFactor(olderTime, newerTime, time, maxExtrapolation) : 1.f;
+            for (const auto& run : runs) {
+                if (t == 1.f) {
+                    std::copy_n(&newer.ExpressionWeights[run.source], run.count, &weights[run.destination]);
+                } else {
+                    blendFaceExpressions(&older.ExpressionWeights[run.source],
+                                         &newer.ExpressionWeights[run.source],
+                                         t,
+                                         run.count,
+                                         &weights[run.destination]);
+                }
+            }
+        };
+
+        buffer.readAt(BodyStateSection::Face, time, blend);
+    }
+
+} // namespace
+
 namespace virtualdesktop_openxr {
 
     using namespace virtualdesktop_openxr::log;
@@ -130,19 +206,22 @@ namespace virtualdesktop_openxr {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
-        // Forward the state from the memory mapped file.
-        if (m_bodyState) {
-            std::shared_lock lock(m_bodyStateMutex);
-
-            for (uint32_t i = 0; i < XR_FACE_EXPRESSION_COUNT_FB; i++) {
-                expressionWeights->weights[i] = m_cachedBodyState.ExpressionWeights[i];
-            }
-            for (uint32_t i = 0; i < XR_FACE_CONFIDENCE_COUNT_FB; i++) {
-                expressionWeights->confidences[i] = m_cachedBodyState.ExpressionConfidences[i];
-            }
-            expressionWeights->status.isValid = m_cachedBodyState.FaceIsValid ? XR_TRUE : XR_FALSE;
+        // Forward the state from the memory mapped file, interpolated at the requested time.
+        if (m_bodyStateSource) {
+            FaceExpressionsState face;
+            readFaceExpressionsAt(m_bodyStateBuffer,
+                                  xrTimeToOvrTime(expressionInfo->time),
+                                  m_bodyStateMaxExtrapolation,
+                                  FaceExpressionSetFB,
+                                  expressionWeights->weights,
+                                  face);
+            std::copy_n(face.confidences, XR_FACE_CONFIDENCE_COUNT_FB, expressionWeights->confidences);
+            expressionWeights->status.isValid = face.isValid ? XR_TRUE : XR_FALSE;
             expressionWeights->status.isEyeFollowingBlendshapesValid =
-                m_cachedBodyState.IsEyeFollowingBlendshapesValid ? XR_TRUE : XR_FALSE;
+                face.isEyeFollowingBlendshapesValid ? XR_TRUE : XR_FALSE;
+            if (isBodyStateStale(BodyStateSection::Face)) {
+                expressionWeights->status.isValid = expressionWeights->status.isEyeFollowingBlendshapesValid = XR_FALSE;
+            }
         } else {
             for (uint32_t i = 0; i < XR_FACE_EXPRESSION_COUNT_FB; i++) {
                 expressionWeights->weights[i] = 0.f;
@@ -153,7 +232,7 @@ namespace virtualdesktop_openxr {
             expressionWeights->status.isValid = expressionWeights->status.isEyeFollowingBlendshapesValid = XR_FALSE;
         }
 
-        // We do not do any extrapolation.
+        // The weights are resolved at the requested time.
         expressionWeights->time = expressionInfo->time;
 
         TraceLoggingWrite(
@@ -275,19 +354,22 @@ namespace virtualdesktop_openxr {
 
         const FaceTracker& xrFaceTracker = *(FaceTracker*)faceTracker;
 
-        // Forward the state from the memory mapped file.
-        if (m_bodyState) {
-            std::shared_lock lock(m_bodyStateMutex);
-
-            for (uint32_t i = 0; i < XR_FACE_EXPRESSION2_COUNT_FB; i++) {
-                expressionWeights->weights[i] = m_cachedBodyState.ExpressionWeights[i];
-            }
-            for (uint32_t i = 0; i < XR_FACE_CONFIDENCE2_COUNT_FB; i++) {
-                expressionWeights->confidences[i] = m_cachedBodyState.ExpressionConfidences[i];
-            }
-            expressionWeights->isValid = m_cachedBodyState.FaceIsValid ? XR_TRUE : XR_FALSE;
+        // Forward the state from the memory mapped file, interpolated at the requested time.
+        if (m_bodyStateSource) {
+            FaceExpressionsState face;
+            readFaceExpressionsAt(m_bodyStateBuffer,
+                                  xrTimeToOvrTime(expressionInfo->time),
+                                  m_bodyStateMaxExtrapolation,
+                                  FaceExpressionSet2FB,
+                                  expressionWeights->weights,
+                                  face);
+            std::copy_n(face.confidences, XR_FACE_CONFIDENCE2_COUNT_FB, expressionWeights->confidences);
+            expressionWeights->isValid = face.isValid ? XR_TRUE : XR_FALSE;
             expressionWeights->isEyeFollowingBlendshapesValid =
-                m_cachedBodyState.IsEyeFollowingBlendshapesValid ? XR_TRUE : XR_FALSE;
+                face.isEyeFollowingBlendshapesValid ? XR_TRUE : XR_FALSE;
+            if (isBodyStateStale(BodyStateSection::Face)) {
+                expressionWeights->isValid = expressionWeights->isEyeFollowingBlendshapesValid = XR_FALSE;
+            }
         } else {
             for (uint32_t i = 0; i < XR_FACE_EXPRESSION2_COUNT_FB; i++) {
                 expressionWeights->weights[i] = 0.f;
@@ -300,7 +382,7 @@ namespace virtualdesktop_openxr {
         expressionWeights->dataSource = xrFaceTracker.canUseVisualSource ? XR_FACE_TRACKING_DATA_SOURCE2_VISUAL_FB
                                                                          : XR_FACE_TRACKING_DATA_SOURCE2_AUDIO_FB;
 
-        // We do not do any extrapolation.
+        // The weights are resolved at the requested time.
         expressionWeights->time = expressionInfo->time;
 
         TraceLoggingWrite(
@@ -120,7 +120,7 @@ namespace virtualdesktop_openxr {
             }
 
             if (m_needStartAsyncSubmissionThread) {
-                m_terminateAsyncThread = false;
+                m_asyncSubmissionQueue.reset();
                 m_asyncSubmissionThread = std::thread([&]() { asyncSubmissionThread(); });
                 m_needStartAsyncSubmissionThread = false;
             }
@@ -135,7 +135,8 @@ namespace virtualdesktop_openxr {
                 lock.lock();
                 TraceLoggingWriteStop(waitToBeginFrame, "OVR_WaitToBeginFrame");
             } else {
-                waitForAsyncSubmissionIdle(m_useRunningStart);
+                waitForAsyncSubmissionIdle(m_useRunningStart, m_asyncSubmissionQueue.getDepth() - 1);
+                m_lastFrameWaitedTime = std::chrono::high_resolution_clock::now();
                 TraceLoggingWrite(g_traceProvider, "AcquiredFrame", TLArg(ovrFrameId, "FrameId"));
             }
 
@@ -152,6 +153,9 @@ namespace virtualdesktop_openxr {
                               TLArg(predictedDisplayTime - now, "PhotonTime"),
                               TLArg(waitTimer.query(), "WaitDurationUs"));
 
+            m_lastWaitFrameTime = now;
+            m_lastWaitFramePredictedDisplayTime = predictedDisplayTime;
+
             // Setup the app frame for use and the next frame for this call.
             frameState->predictedDisplayTime = ovrTimeToXrTime(predictedDisplayTime);
 
@@ -296,6 +300,35 @@ namespace virtualdesktop_openxr {
                     g_traceProvider, "OVR_AswStatus", TLArg(isAsyncReprojectionActive, "AsyncReprojectionActive"));
             }
 
+            // Start the telemetry record for this frame. It is completed and published in xrEndFrame().
+            if (m_frameTelemetry.isOpen()) {
+                FrameTelemetryRecord& record = m_frameTelemetryRecord;
+                record = {};
+                record.frameId = ovrFrameId;
+                record.waitFrameTime = m_lastWaitFrameTime;
+                record.beginFrameTime = ovr_GetTimeInSeconds();
+                record.predictedDisplayTime = m_lastWaitFramePredictedDisplayTime;
+                record.appCpuTimeUs = (uint32_t)m_lastCpuFrameTimeUs;
+                record.appGpuTimeUs = (uint32_t)m_lastGpuFrameTimeUs;
+                if (stats.FrameStatsCount > 0) {
+                    record.appMotionToPhotonLatency = stats.FrameStats[0].AppMotionToPhotonLatency;
+                    record.compositorCpuTime = stats.FrameStats[0].CompositorCpuElapsedTime;
+                    record.compositorGpuTime = stats.FrameStats[0].CompositorGpuElapsedTime;
+                    record.appDroppedFrameCount = stats.FrameStats[0].AppDroppedFrameCount;
+                    record.compositorDroppedFrameCount = stats.FrameStats[0].CompositorDroppedFrameCount;
+                }
+                record.isAsyncReprojectionActive = isAsyncReprojectionActive;
+            }
+
+            // Sample the counters for XR_META_performance_metrics, so that queries do not need to synchronize with the
+            // frame loop.
+            if (m_performanceMetricsEnabled) {
+                const bool hasGpuFrameTime = m_gpuTimerApp[m_currentTimerIndex] && m_frameCompleted >= k_numGpuTimers;
+                const std::optional<uint64_t> gpuFrameTimeUs =
+                    hasGpuFrameTime ? std::make_optional(m_lastGpuFrameTimeUs) : std::nullopt;
+                m_performanceMetrics.publish(SamplePerformanceMetrics(stats, m_lastCpuFrameTimeUs, gpuFrameTimeUs));
+            }
+
             if (isAsyncReprojectionActive) {
                 m_predictedFrameDuration = m_idealFrameDuration * 2.f;
             } else {
@@ -356,12 +389,12 @@ namespace virtualdesktop_openxr {
                 m_gpuTimerApp[m_currentTimerIndex]->stop();
             }
 
-            // Make sure the previous frame finished submission.
+            // Make sure the previous frames finished submission.
             if (m_useAsyncSubmission) {
-                waitForAsyncSubmissionIdle();
+                waitForAsyncSubmissionHandoff();
 
-                // From this point, we know that the asynchronous thread is waiting, and we may use the submission
-                // context.
+                // From this point, we know that the asynchronous thread is not submitting, and we may use the
+                // submission context.
             }
 
             // Serializes the app work between D3D12/Vulkan and D3D11.
@@ -390,24 +423,99 @@ namespace virtualdesktop_openxr {
                 m_gpuTimerPrecomposition[m_currentTimerIndex]->start();
             }
 
-            std::set<std::pair<ovrTextureSwapChain, uint32_t>> committedSwapchainImages;
+            // Identify this call for the purpose of committing each swapchain image only once.
+            m_commitFrameId++;
 
             bool isProj0SRGB = false;
             bool isFirstProjectionLayer = true;
 
-            // Construct the list of layers.
-            std::vector<ovrLayer_Union> layersAllocator;
-            layersAllocator.reserve(frameEndInfo->layerCount + 1);
-            for (uint32_t i = 0; i < frameEndInfo->layerCount; i++) {
-                if (!frameEndInfo->layers[i]) {
-                    return XR_ERROR_LAYER_INVALID;
-                }
-
+            // Resolve the spaces of all layers up-front, with a single acquisition of the lock. Layers commonly share
+            // the same space, and all the views of a projection layer share the space of the layer.
+            struct LayerSpace {
+                XrSpace space{XR_NULL_HANDLE};
+                bool isViewSpace{false};
+                XrPosef poseInSpace{};
+                bool isLocated{false};
+                XrPosef pose{};
+
+                // The motion controller driving the space, for late-latching.
+                ovrTrackedDeviceType controller{ovrTrackedDevice_None};
+                ovrPosef controllerPose{};
+            };
+            LayerSpace layerSpaces[ovrMaxLayerCount];
+            uint32_t numLayerSpaces = 0;
+            const LayerSpace* spaceForLayer[ovrMaxLayerCount]{};
+            {
                 std::shared_lock lock3(m_actionsAndSpacesMutex);
 
-                if (!m_spaces.count(frameEndInfo->layers[i]->space)) {
-                    return XR_ERROR_HANDLE_INVALID;
+                for (uint32_t i = 0; i < frameEndInfo->layerCount; i++) {
+                    if (!frameEndInfo->layers[i]) {
+                        return XR_ERROR_LAYER_INVALID;
+                    }
+
+                    const XrSpace space = frameEndInfo->layers[i]->space;
+                    if (!m_spaces.count(space)) {
+                        return XR_ERROR_HANDLE_INVALID;
+                    }
+                    const Space& xrSpace = *(Space*)space;
+
+                    LayerSpace* layerSpace = nullptr;
+                    for (uint32_t j = 0; j < numLayerSpaces; j++) {
+                        if (layerSpaces[j].space == space) {
+                            layerSpace = &layerSpaces[j];
+                            break;
+                        }
+                    }
+                    if (!layerSpace) {
+                        layerSpace = &layerSpaces[numLayerSpaces++];
+                        layerSpace->space = space;
+                        layerSpace->isViewSpace = xrSpace.referenceType == XR_REFERENCE_SPACE_TYPE_VIEW;
+                        layerSpace->poseInSpace = xrSpace.poseInSpace;
+                    }
+
+                    // Quad, cylinder and cube layers in view space are head-locked and do not need to be located.
+                    const bool needLocate = frameEndInfo->layers[i]->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION ||
+                                            !layerSpace->isViewSpace;
+                    if (needLocate && !layerSpace->isLocated) {
+                        // Quad and cylinder layers placed relative to a motion controller can be late-latched by the
+                        // asynchronous submission thread. Record the pose of the controller from the same sample as
+                        // the location of the space, so that the correction only accounts for the motion since.
+                        std::optional<XrPosef> controllerPose;
+                        const bool canLateLatch = m_useLateLatching && m_useAsyncSubmission;
+                        locateSpace(xrSpace,
+                                    *m_originSpace,
+                                    frameEndInfo->displayTime,
+                                    layerSpace->pose,
+                                    nullptr,
+                                    nullptr,
+                                    canLateLatch ? &controllerPose : nullptr);
+                        layerSpace->isLocated = true;
+
+                        const int side = controllerPose ? getLateLatchingController(xrSpace) : -1;
+                        if (side >= 0) {
+                            layerSpace->controller = side == 0 ? ovrTrackedDevice_LTouch : ovrTrackedDevice_RTouch;
+                            layerSpace->controllerPose = xrPoseToOvrPose(controllerPose.value());
+                        }
+                    }
+
+                    spaceForLayer[i] = layerSpace;
                 }
+            }
+
+            // Construct the list of layers. With asynchronous submission, we build them in place in the next frame of
+            // the queue, which is not visible to the asynchronous thread until we push it. The storage is reused from
+            // frame to frame.
+            auto& layersAllocator =
+                m_useAsyncSubmission ? m_asyncSubmissionQueue.getNextFrame().layers : m_layersForSubmission;
+            layersAllocator.clear();
+            layersAllocator.reserve(ovrMaxLayerCount);
+            std::vector<LateLatchedLayer>* lateLatchedLayers = nullptr;
+            if (m_useAsyncSubmission) {
+                lateLatchedLayers = &m_asyncSubmissionQueue.getNextFrame().lateLatchedLayers;
+                lateLatchedLayers->clear();
+            }
+            for (uint32_t i = 0; i < frameEndInfo->layerCount; i++) {
+                const LayerSpace& layerSpace = *spaceForLayer[i];
 
                 layersAllocator.push_back({});
                 auto* layer = &layersAllocator.back();
@@ -486,8 +594,7 @@ namespace virtualdesktop_openxr {
                         prepareAndCommitSwapchainImage(xrSwapchain,
                                                        i,
                                                        proj->views[viewIndex].subImage.imageArrayIndex,
-                                                       frameEndInfo->layers[i]->layerFlags,
-                                                       committedSwapchainImages);
+                                                       frameEndInfo->layers[i]->layerFlags);
                         layer->EyeFov.ColorTexture[viewIndex] =
                             xrSwapchain.ovrSwapchain[proj->views[viewIndex].subImage.imageArrayIndex];
 
@@ -502,10 +609,8 @@ namespace virtualdesktop_openxr {
                             proj->views[viewIndex].subImage.imageRect.extent.height;
 
                         // Fill out pose and FOV information.
-                        XrPosef layerPose;
-                        locateSpace(*(Space*)proj->space, *m_originSpace, frameEndInfo->displayTime, layerPose);
                         layer->EyeFov.RenderPose[viewIndex] =
-                            xrPoseToOvrPose(Pose::Multiply(proj->views[viewIndex].pose, layerPose));
+                            xrPoseToOvrPose(Pose::Multiply(proj->views[viewIndex].pose, layerSpace.pose));
 
                         XrFovf fov = proj->views[viewIndex].fov;
                         layer->EyeFov.Fov[viewIndex].DownTan = -tan(fov.angleDown);
@@ -556,15 +661,11 @@ namespace virtualdesktop_openxr {
                                         return XR_ERROR_VALIDATION_FAILURE;
                                     }
 
-                                    // Fill out depth buffer information.
-                                    prepareAndCommitSwapchainImage(
-                                        xrDepthSwapchain,
-                                        i,
-                                        depth->subImage.imageArrayIndex,
-                                        XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT /* Not applicable for depth
-                                                                                             */
-                                        ,
-                                        committedSwapchainImages);
+                                    // Fill out depth buffer information (composition flags are not applicable).
+                                    prepareAndCommitSwapchainImage(xrDepthSwapchain,
+                                                                   i,
+                                                                   depth->subImage.imageArrayIndex,
+                                                                   XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT);
                                     layer->EyeFovDepth.DepthTexture[viewIndex] =
                                         xrDepthSwapchain.ovrSwapchain[depth->subImage.imageArrayIndex];
 
@@ -673,11 +774,8 @@ namespace virtualdesktop_openxr {
                     }
 
                     // Fill out color buffer information.
-                    prepareAndCommitSwapchainImage(xrSwapchain,
-                                                   i,
-                                                   quad->subImage.imageArrayIndex,
-                                                   frameEndInfo->layers[i]->layerFlags,
-                                                   committedSwapchainImages);
+                    prepareAndCommitSwapchainImage(
+                        xrSwapchain, i, quad->subImage.imageArrayIndex, frameEndInfo->layers[i]->layerFlags);
                     layer->Quad.ColorTexture = xrSwapchain.ovrSwapchain[quad->subImage.imageArrayIndex];
 
                     if (!isValidSwapchainRect(xrSwapchain.ovrDesc, quad->subImage.imageRect)) {
@@ -688,18 +786,17 @@ namespace virtualdesktop_openxr {
                     layer->Quad.Viewport.Size.w = quad->subImage.imageRect.extent.width;
                     layer->Quad.Viewport.Size.h = quad->subImage.imageRect.extent.height;
 
-                    if (!m_spaces.count(quad->space)) {
-                        return XR_ERROR_HANDLE_INVALID;
-                    }
-                    Space& xrSpace = *(Space*)quad->space;
-
                     // Fill out pose and quad information.
-                    if (xrSpace.referenceType != XR_REFERENCE_SPACE_TYPE_VIEW) {
-                        XrPosef layerPose;
-                        locateSpace(*(Space*)quad->space, *m_originSpace, frameEndInfo->displayTime, layerPose);
-                        layer->Quad.QuadPoseCenter = xrPoseToOvrPose(Pose::Multiply(quad->pose, layerPose));
+                    if (!layerSpace.isViewSpace) {
+                        layer->Quad.QuadPoseCenter = xrPoseToOvrPose(Pose::Multiply(quad->pose, layerSpace.pose));
+                        if (lateLatchedLayers && layerSpace.controller != ovrTrackedDevice_None) {
+                            lateLatchedLayers->push_back({(uint32_t)(layersAllocator.size() - 1),
+                                                          layerSpace.controller,
+                                                          layerSpace.controllerPose});
+                        }
                     } else {
-                        layer->Quad.QuadPoseCenter = xrPoseToOvrPose(Pose::Multiply(quad->pose, xrSpace.poseInSpace));
+                        layer->Quad.QuadPoseCenter =
+                            xrPoseToOvrPose(Pose::Multiply(quad->pose, layerSpace.poseInSpace));
                         layer->Header.Flags |= ovrLayerFlag_HeadLocked;
                     }
 
@@ -752,27 +849,19 @@ namespace virtualdesktop_openxr {
                     }
 
                     // Fill out color buffer information.
-                    prepareAndCommitSwapchainImage(
-                        xrSwapchain, i, 0, frameEndInfo->layers[i]->layerFlags, committedSwapchainImages);
+                    prepareAndCommitSwapchainImage(xrSwapchain, i, 0, frameEndInfo->layers[i]->layerFlags);
                     layer->Cube.CubeMapTexture = xrSwapchain.ovrSwapchain[0];
 
-                    if (!m_spaces.count(cube->space)) {
-                        return XR_ERROR_HANDLE_INVALID;
-                    }
-                    Space& xrSpace = *(Space*)cube->space;
-
                     // Fill out the rotation.
-                    if (xrSpace.referenceType != XR_REFERENCE_SPACE_TYPE_VIEW) {
-                        XrPosef layerPose;
-                        locateSpace(*(Space*)cube->space, *m_originSpace, frameEndInfo->displayTime, layerPose);
+                    if (!layerSpace.isViewSpace) {
                         layer->Cube.Orientation =
-                            xrPoseToOvrPose(
-                                Pose::Multiply(Pose::MakePose(cube->orientation, XrVector3f{0, 0, 0}), layerPose))
+                            xrPoseToOvrPose(Pose::Multiply(Pose::MakePose(cube->orientation, XrVector3f{0, 0, 0}),
+                                                           layerSpace.pose))
                                 .Orientation;
                     } else {
                         layer->Cube.Orientation =
                             xrPoseToOvrPose(Pose::Multiply(Pose::MakePose(cube->orientation, XrVector3f{0, 0, 0}),
-                                                           xrSpace.poseInSpace))
+                                                           layerSpace.poseInSpace))
                                 .Orientation;
                         layer->Header.Flags |= ovrLayerFlag_HeadLocked;
                     }
@@ -793,10 +882,7 @@ namespace virtualdesktop_openxr {
 
             // Update the FPS counter.
             const auto now = ovr_GetTimeInSeconds();
-            m_frameTimes.push_back(now);
-            while (now - m_frameTimes.front() >= 1.0) {
-                m_frameTimes.pop_front();
-            }
+            m_fpsCounter.addFrame(now);
 
             // Inform Virtual Desktop of the measured application GPU work duration.
             // Ignore return code since this is a non-standard option.
@@ -807,11 +893,12 @@ namespace virtualdesktop_openxr {
             // Submit the layers to OVR.
             const long long ovrFrameId = m_frameBegun - 1;
             if (!m_useAsyncSubmission) {
-                std::vector<ovrLayerHeader*> layers;
+                ovrLayerHeader* layers[ovrMaxLayerCount];
+                uint32_t numLayers = 0;
                 for (auto& layer : layersAllocator) {
-                    layers.push_back(&layer.Header);
+                    layers[numLayers++] = &layer.Header;
 
-                    if (layers.size() == ovrMaxLayerCount) {
+                    if (numLayers == ovrMaxLayerCount) {
                         ErrorLog("Too many layers in this frame (%u)\n", layersAllocator.size());
                         break;
                     }
@@ -821,15 +908,14 @@ namespace virtualdesktop_openxr {
                 TraceLoggingWriteStart(endFrame,
                                        "OVR_EndFrame",
                                        TLArg(ovrFrameId, "FrameId"),
-                                       TLArg(layers.size(), "NumLayers"),
-                                       TLArg(m_frameTimes.size(), "Fps"),
+                                       TLArg(numLayers, "NumLayers"),
+                                       TLArg(m_fpsCounter.fps(), "Fps"),
                                        TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"));
                 ovrViewScaleDesc scaleDesc{};
                 scaleDesc.HmdToEyePose[xr::StereoView::Left] = m_cachedEyeInfo[xr::StereoView::Left].HmdToEyePose;
                 scaleDesc.HmdToEyePose[xr::StereoView::Right] = m_cachedEyeInfo[xr::StereoView::Right].HmdToEyePose;
                 scaleDesc.HmdSpaceToWorldScaleInMeters = 1.f;
-                CHECK_OVRCMD(
-                    ovr_EndFrame(m_ovrSession, ovrFrameId, &scaleDesc, layers.data(), (unsigned int)layers.size()));
+                CHECK_OVRCMD(ovr_EndFrame(m_ovrSession, ovrFrameId, &scaleDesc, layers, numLayers));
                 TraceLoggingWriteStop(endFrame, "OVR_EndFrame");
             }
 
@@ -854,18 +940,57 @@ namespace virtualdesktop_openxr {
                 TraceLoggingWrite(g_traceProvider,
                                   "SubmitLayers",
                                   TLArg(ovrFrameId, "FrameId"),
-                                  TLArg(m_frameTimes.size(), "Fps"),
+                                  TLArg(m_fpsCounter.fps(), "Fps"),
                                   TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"));
 
-                std::unique_lock lock(m_asyncSubmissionMutex);
-                m_layersForAsyncSubmission = layersAllocator;
+                // When no frame is in flight, the last slot opened by OVR is the one for this frame. Otherwise, the
+                // frame is early and will wait for its slot.
+                if (m_useRunningStart) {
+                    const auto now = std::chrono::high_resolution_clock::now();
+                    const double appFrameTime = std::chrono::duration<double>(now - m_lastFrameWaitedTime).count();
+                    const std::chrono::high_resolution_clock::time_point lastWaitToBeginFrameTime(
+                        std::chrono::high_resolution_clock::duration(
+                            m_lastWaitToBeginFrameTime.load(std::memory_order_acquire)));
+                    const double submitTime =
+                        m_asyncSubmissionQueue.getFramesInFlight() == 0
+                            ? std::chrono::duration<double>(now - lastWaitToBeginFrameTime).count()
+                            : 0.0;
+                    const bool isMissed = m_runningStart.update(appFrameTime, submitTime, m_predictedFrameDuration);
+                    TraceLoggingWrite(g_traceProvider,
+                                      "RunningStart_Update",
+                                      TLArg(ovrFrameId, "FrameId"),
+                                      TLArg(appFrameTime * 1e6, "AppFrameTimeUs"),
+                                      TLArg(submitTime * 1e6, "SubmitTimeUs"),
+                                      TLArg(isMissed, "Missed"),
+                                      TLArg(m_runningStart.getMeanFrameTime() * 1e6, "MeanAppFrameTimeUs"),
+                                      TLArg(m_runningStart.getFrameTimeDeviation() * 1e6, "AppFrameTimeDeviationUs"),
+                                      TLArg(m_runningStart.getRunningStart() * 1e6, "RunningStartUs"));
+                }
+
+                m_asyncSubmissionQueue.getNextFrame().frameId = ovrFrameId;
+                m_asyncSubmissionQueue.getNextFrame().displayTime = xrTimeToOvrTime(frameEndInfo->displayTime);
+                m_asyncSubmissionQueue.push();
 
-                m_asyncSubmissionCondVar.notify_all();
+                TraceLoggingWrite(g_traceProvider,
+                                  "AsyncSubmission_Queue",
+                                  TLArg(ovrFrameId, "FrameId"),
+                                  TLArg(m_asyncSubmissionQueue.getFramesInFlight(), "FramesInFlight"));
 
                 // From this point, we know that the asynchronous thread may be executing, and we shall not use the
                 // submission context.
             }
 
+            if (m_frameTelemetry.isOpen()) {
+                FrameTelemetryRecord& record = m_frameTelemetryRecord;
+                record.endFrameTime = now;
+                record.layerCount = frameEndInfo->layerCount;
+                if (m_useAsyncSubmission) {
+                    record.runningStartUs = m_useRunningStart ? (uint32_t)(m_runningStart.getRunningStart() * 1e6) : 0;
+                    record.framesInFlight = m_asyncSubmissionQueue.getFramesInFlight();
+                }
+                m_frameTelemetry.publish(record);
+            }
+
             m_frameCompleted = m_frameBegun;
             updateSessionState();
 
@@ -892,9 +1017,11 @@ namespace virtualdesktop_openxr {
         SetThreadPriority(GetCurrentThread(),
                           getSetting("async_submission_priority").value_or(THREAD_PRIORITY_TIME_CRITICAL));
 
-        std::optional<long long> lastWaitedFrameId;
         while (true) {
-            const long long ovrFrameId = m_frameCompleted;
+            // Begin the slot for the oldest frame not yet submitted, or for the next frame the app will complete.
+            const long long ovrFrameId = m_asyncSubmissionQueue.hasPendingFrame()
+                                             ? m_asyncSubmissionQueue.getPendingFrame().frameId
+                                             : m_frameCompleted;
             {
                 TraceLocalActivity(waitToBeginFrame);
                 TraceLoggingWriteStart(waitToBeginFrame, "OVR_WaitToBeginFrame", TLArg(ovrFrameId, "FrameId"));
@@ -910,7 +1037,8 @@ namespace virtualdesktop_openxr {
                     CHECK_OVRCMD(result);
                 }
             }
-            m_lastWaitToBeginFrameTime = std::chrono::high_resolution_clock::now();
+            m_lastWaitToBeginFrameTime.store(std::chrono::high_resolution_clock::now().time_since_epoch().count(),
+                                             std::memory_order_release);
 
             {
                 TraceLocalActivity(beginFrame);
@@ -919,68 +1047,130 @@ namespace virtualdesktop_openxr {
                 TraceLoggingWriteStop(beginFrame, "OVR_BeginFrame");
             }
 
-            {
-                std::unique_lock lock(m_asyncSubmissionMutex);
-
-                // Mark us as ready to accept a new frame.
-                m_layersForAsyncSubmission.clear();
-                m_asyncSubmissionCondVar.notify_all();
+            // Retire the previous frame and mark us as ready to accept a new frame.
+            m_asyncSubmissionQueue.retire();
 
-                // Wait for the frame.
-                m_asyncSubmissionCondVar.wait(
-                    lock, [&] { return m_terminateAsyncThread || !m_layersForAsyncSubmission.empty(); });
-            }
-            if (m_terminateAsyncThread) {
+            // Wait for the frame.
+            auto* const frame = m_asyncSubmissionQueue.waitForPendingFrame();
+            if (!frame) {
                 break;
             }
 
             {
-                std::vector<ovrLayerHeader*> layers;
-                for (auto& layer : m_layersForAsyncSubmission) {
-                    layers.push_back(&layer.Header);
+                // Sample the controllers as late as possible, right before the compositor needs the frame.
+                lateLatchLayers(frame->layers, frame->lateLatchedLayers, frame->displayTime);
+
+                ovrLayerHeader* layers[ovrMaxLayerCount];
+                uint32_t numLayers = 0;
+                for (auto& layer : frame->layers) {
+                    layers[numLayers++] = &layer.Header;
 
-                    if (layers.size() == ovrMaxLayerCount) {
-                        ErrorLog("Too many layers in this frame (%u)\n", m_layersForAsyncSubmission.size());
+                    if (numLayers == ovrMaxLayerCount) {
+                        ErrorLog("Too many layers in this frame (%u)\n", frame->layers.size());
                         break;
                     }
                 }
 
                 TraceLocalActivity(endFrame);
                 TraceLoggingWriteStart(
-                    endFrame, "OVR_EndFrame", TLArg(ovrFrameId, "FrameId"), TLArg(layers.size(), "NumLayers"));
+                    endFrame, "OVR_EndFrame", TLArg(ovrFrameId, "FrameId"), TLArg(numLayers, "NumLayers"));
                 ovrViewScaleDesc scaleDesc{};
                 scaleDesc.HmdToEyePose[xr::StereoView::Left] = m_cachedEyeInfo[xr::StereoView::Left].HmdToEyePose;
                 scaleDesc.HmdToEyePose[xr::StereoView::Right] = m_cachedEyeInfo[xr::StereoView::Right].HmdToEyePose;
                 scaleDesc.HmdSpaceToWorldScaleInMeters = 1.f;
-                CHECK_OVRCMD(
-                    ovr_EndFrame(m_ovrSession, ovrFrameId, &scaleDesc, layers.data(), (unsigned int)layers.size()));
+                CHECK_OVRCMD(ovr_EndFrame(m_ovrSession, ovrFrameId, &scaleDesc, layers, numLayers));
                 TraceLoggingWriteStop(endFrame, "OVR_EndFrame");
             }
+
+            // Hand the submission context and the swapchain images back to xrEndFrame().
+            m_asyncSubmissionQueue.markSubmitted();
         }
 
         TraceLoggingWriteStop(local, "AsyncSubmissionThread");
     }
 
-    void OpenXrRuntime::waitForAsyncSubmissionIdle(bool doRunningStart) {
+    void OpenXrRuntime::waitForAsyncSubmissionIdle(bool doRunningStart, uint32_t maxFramesInFlight) {
         TraceLocalActivity(waitToBeginFrame);
-        TraceLoggingWriteStart(waitToBeginFrame, "WaitForAsyncSubmissionIdle", TLArg(doRunningStart, "DoRunningStart"));
-
-        std::unique_lock lock(m_asyncSubmissionMutex);
+        TraceLoggingWriteStart(waitToBeginFrame,
+                               "WaitForAsyncSubmissionIdle",
+                               TLArg(doRunningStart, "DoRunningStart"),
+                               TLArg(maxFramesInFlight, "MaxFramesInFlight"));
 
         bool wokeUpEarly = false;
         if (doRunningStart) {
-            constexpr double RunningStart = 0.002;
-            const auto timeout =
-                m_lastWaitToBeginFrameTime + std::chrono::duration<double>(m_predictedFrameDuration - RunningStart);
-
-            wokeUpEarly =
-                !m_asyncSubmissionCondVar.wait_until(lock, timeout, [&] { return m_layersForAsyncSubmission.empty(); });
+            const double runningStart = m_runningStart.getRunningStart();
+            const std::chrono::high_resolution_clock::time_point lastWaitToBeginFrameTime(
+                std::chrono::high_resolution_clock::duration(
+                    m_lastWaitToBeginFrameTime.load(std::memory_order_acquire)));
+            const auto timeout = lastWaitToBeginFrameTime +
+                                 std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                                     std::chrono::duration<double>(m_predictedFrameDuration - runningStart));
+
+            wokeUpEarly = !m_asyncSubmissionQueue.waitForFramesInFlight(maxFramesInFlight, timeout);
         } else {
-            m_asyncSubmissionCondVar.wait(lock, [&] { return m_layersForAsyncSubmission.empty(); });
+            m_asyncSubmissionQueue.waitForFramesInFlight(maxFramesInFlight);
         }
 
-        TraceLoggingWriteStop(
-            waitToBeginFrame, "WaitForAsyncSubmissionIdle", TLArg(wokeUpEarly, "WokeUpForRunningStart"));
+        TraceLoggingWriteStop(waitToBeginFrame,
+                              "WaitForAsyncSubmissionIdle",
+                              TLArg(wokeUpEarly, "WokeUpForRunningStart"),
+                              TLArg(doRunningStart ? m_runningStart.getRunningStart() * 1e6 : 0.0, "RunningStartUs"));
+    }
+
+    void OpenXrRuntime::waitForAsyncSubmissionHandoff() {
+        TraceLocalActivity(waitHandoff);
+        TraceLoggingWriteStart(waitHandoff, "WaitForAsyncSubmissionHandoff");
+
+        // The submission context and the swapchain images are shared with the frames that are not submitted yet, and
+        // the queue must have room for the new frame.
+        m_asyncSubmissionQueue.waitForHandoff();
+
+        TraceLoggingWriteStop(waitHandoff,
+                              "WaitForAsyncSubmissionHandoff",
+                              TLArg(m_asyncSubmissionQueue.getFramesInFlight(), "FramesInFlight"));
+    }
+
+    // Move the layers placed relative to a motion controller along with the latest pose of the controller. The
+    // compositor already corrects the head motion for all layers, but it does not know about the controllers.
+    void OpenXrRuntime::lateLatchLayers(std::vector<ovrLayer_Union>& layers,
+                                        const std::vector<LateLatchedLayer>& lateLatchedLayers,
+                                        double displayTime) {
+        std::optional<ovrPosef> latestControllerPoses[xr::Side::Count];
+        for (const auto& lateLatchedLayer : lateLatchedLayers) {
+            const int side = lateLatchedLayer.device == ovrTrackedDevice_LTouch ? 0 : 1;
+            if (!latestControllerPoses[side]) {
+                ovrTrackedDeviceType controller = lateLatchedLayer.device;
+                ovrPoseStatef state{};
+                if (!OVR_SUCCESS(ovr_GetDevicePoses(m_ovrSession, &controller, 1, displayTime, &state))) {
+                    continue;
+                }
+                latestControllerPoses[side] = state.ThePose;
+            }
+
+            XrPosef correction;
+            float angle, distance;
+            const bool isCorrected = GetLateLatchingCorrection(ovrPoseToXrPose(lateLatchedLayer.devicePose),
+                                                               ovrPoseToXrPose(latestControllerPoses[side].value()),
+                                                               m_lateLatchingEnvelope,
+                                                               correction,
+                                                               angle,
+                                                               distance);
+            TraceLoggingWrite(g_traceProvider,
+                              "LateLatching",
+                              TLArg(lateLatchedLayer.layerIndex, "LayerIndex"),
+                              TLArg(side == 0 ? "Left" : "Right", "Side"),
+                              TLArg(angle, "Angle"),
+                              TLArg(distance, "Distance"),
+                              TLArg(isCorrected, "IsCorrected"));
+            if (!isCorrected) {
+                continue;
+            }
+
+            // The Quad part of Cylinder is equivalent (see xrEndFrame()).
+            ovrLayer_Union& layer = layers[lateLatchedLayer.layerIndex];
+            layer.Quad.QuadPoseCenter =
+                xrPoseToOvrPose(Pose::Multiply(ovrPoseToXrPose(layer.Quad.QuadPoseCenter), correction));
+        }
     }
 
 } // namespace virtualdesktop_openxr
@@ -0,0 +1,307 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Per-frame statistics published in shared memory for external tools (see the FrameTelemetryReader tool).
+    //
+    // The layout is part of the contract with the readers: any change must bump FrameTelemetryVersion. The shared
+    // memory starts with a FrameTelemetryHeader followed by FrameTelemetryCapacity FrameTelemetrySlot. The writer
+    // increments the header's writeIndex after filling the slot at (writeIndex % FrameTelemetryCapacity). Each slot is
+    // protected by a sequence number that is odd while the slot is being written.
+    //
+    // The shared memory outlives the writer while readers keep it open. A new writer takes it over when the previous
+    // one closed it (processId is 0) or exited, and restarts the writeIndex from 0.
+    constexpr wchar_t FrameTelemetryName[] = L"VirtualDesktopOpenXR.FrameTelemetry";
+    constexpr wchar_t FrameTelemetryWriterMutexName[] = L"VirtualDesktopOpenXR.FrameTelemetryWriter";
+    constexpr uint32_t FrameTelemetryMagic = 0x52584456; // "VDXR"
+    constexpr uint32_t FrameTelemetryVersion = 1;
+    constexpr uint32_t FrameTelemetryCapacity = 256;
+
+    struct FrameTelemetryRecord {
+        uint64_t frameId;
+
+        // OVR times, in seconds.
+        double waitFrameTime;
+        double beginFrameTime;
+        double endFrameTime;
+        double predictedDisplayTime;
+
+        // Application timings, in microseconds. The GPU time is measured with a few frames of latency.
+        uint32_t appCpuTimeUs;
+        uint32_t appGpuTimeUs;
+
+        // Asynchronous submission state.
+        uint32_t runningStartUs;
+        uint32_t framesInFlight;
+
+        // Compositor statistics from ovr_GetPerfStats(), in seconds and cumulative frame counts.
+        float appMotionToPhotonLatency;
+        float compositorCpuTime;
+        float compositorGpuTime;
+        uint32_t appDroppedFrameCount;
+        uint32_t compositorDroppedFrameCount;
+        uint32_t isAsyncReprojectionActive;
+
+        uint32_t layerCount;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(FrameTelemetryRecord) == 88);
+
+    struct FrameTelemetrySlot {
+        std::atomic<uint32_t> sequence;
+        uint32_t reserved;
+        uint64_t index;
+        FrameTelemetryRecord record;
+    };
+    static_assert(sizeof(FrameTelemetrySlot) == 104);
+
+    struct FrameTelemetryHeader {
+        // Written last, once the rest of the header is valid.
+        std::atomic<uint32_t> magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t slotSize;
+        uint32_t capacity;
+        // The writer, or 0 when the writer closed the shared memory.
+        std::atomic<uint32_t> processId;
+        char applicationName[64];
+        std::atomic<uint64_t> writeIndex;
+    };
+    static_assert(sizeof(FrameTelemetryHeader) == 96);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free);
+
+    // The writer side of the shared memory.
+    class FrameTelemetry {
+      public:
+        ~FrameTelemetry() {
+            close();
+        }
+
+        bool open(const std::string& applicationName) {
+            close();
+
+            // Serialize the claim on the shared memory between the runtimes of concurrent applications.
+            wil::unique_handle writerMutex(CreateMutex(nullptr, false, FrameTelemetryWriterMutexName));
+            if (!writerMutex) {
+                return false;
+            }
+            const DWORD waitResult = WaitForSingleObject(writerMutex.get(), 1000);
+            if (waitResult != WAIT_OBJECT_0 && waitResult != WAIT_ABANDONED) {
+                return false;
+            }
+            auto releaseMutex = MakeScopeGuard([&] { ReleaseMutex(writerMutex.get()); });
+
+            constexpr size_t Size = sizeof(FrameTelemetryHeader) + FrameTelemetryCapacity * sizeof(FrameTelemetrySlot);
+            wil::unique_handle file(
+                CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)Size, FrameTelemetryName));
+            if (!file) {
+                return false;
+            }
+            const bool alreadyExists = GetLastError() == ERROR_ALREADY_EXISTS;
+
+            void* const view = MapViewOfFile(file.get(), FILE_MAP_ALL_ACCESS, 0, 0, Size);
+            if (!view) {
+                return false;
+            }
+
+            FrameTelemetryHeader* const header = reinterpret_cast<FrameTelemetryHeader*>(view);
+            if (alreadyExists && header->magic.load(std::memory_order_acquire) == FrameTelemetryMagic &&
+                isOtherProcessRunning(header->processId.load(std::memory_order_relaxed))) {
+                // Another application is publishing.
+                UnmapViewOfFile(view);
+                return false;
+            }
+
+            m_file = std::move(file);
+            m_header = header;
+            m_slots = reinterpret_cast<FrameTelemetrySlot*>(reinterpret_cast<uint8_t*>(view) +
+                                                            sizeof(FrameTelemetryHeader));
+
+            // A new mapping is zero-initialized. When taking over the mapping from a previous writer, invalidate the
+            // header while it is rewritten, and the slots so that readers do not mistake the old records for new ones.
+            m_header->magic.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            if (alreadyExists) {
+                for (uint32_t i = 0; i < FrameTelemetryCapacity; i++) {
+                    FrameTelemetrySlot& slot = m_slots[i];
+                    // The previous writer may have exited in the middle of an update.
+                    if (!(slot.sequence.load(std::memory_order_relaxed) & 1)) {
+                        slot.sequence.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    std::atomic_thread_fence(std::memory_order_release);
+                    slot.index = UINT64_MAX;
+                    slot.sequence.fetch_add(1, std::memory_order_release);
+                }
+            }
+
+            m_header->version = FrameTelemetryVersion;
+            m_header->headerSize = sizeof(FrameTelemetryHeader);
+            m_header->slotSize = sizeof(FrameTelemetrySlot);
+            m_header->capacity = FrameTelemetryCapacity;
+            m_header->processId.store(GetCurrentProcessId(), std::memory_order_relaxed);
+            strncpy_s(m_header->applicationName, applicationName.c_str(), _TRUNCATE);
+            m_header->writeIndex.store(0, std::memory_order_relaxed);
+            m_header->magic.store(FrameTelemetryMagic, std::memory_order_release);
+
+            return true;
+        }
+
+        void close() {
+            if (m_header) {
+                // Let the next writer take over, even if readers keep the shared memory alive.
+                m_header->processId.store(0, std::memory_order_release);
+                UnmapViewOfFile(m_header);
+                m_header = nullptr;
+                m_slots = nullptr;
+            }
+            m_file.reset();
+        }
+
+        bool isOpen() const {
+            return m_header;
+        }
+
+        void publish(const FrameTelemetryRecord& record) {
+            if (!m_header) {
+                return;
+            }
+
+            const uint64_t index = m_header->writeIndex.load(std::memory_order_relaxed);
+            FrameTelemetrySlot& slot = m_slots[index % FrameTelemetryCapacity];
+
+            slot.sequence.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.index = index;
+            slot.record = record;
+            slot.sequence.fetch_add(1, std::memory_order_release);
+
+            m_header->writeIndex.store(index + 1, std::memory_order_release);
+        }
+
+      private:
+        static bool isOtherProcessRunning(uint32_t processId) {
+            if (!processId || processId == GetCurrentProcessId()) {
+                return false;
+            }
+
+            wil::unique_handle process(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, false, processId));
+            DWORD exitCode;
+            return process && GetExitCodeProcess(process.get(), &exitCode) && exitCode == STILL_ACTIVE;
+        }
+
+        wil::unique_handle m_file;
+        FrameTelemetryHeader* m_header{nullptr};
+        FrameTelemetrySlot* m_slots{nullptr};
+    };
+
+    // The reader side of the shared memory.
+    class FrameTelemetryReader {
+      public:
+        enum class Result {
+            Success,
+            // The slot is being written.
+            Busy,
+            // The slot was overwritten before it could be read.
+            Overwritten,
+        };
+
+        ~FrameTelemetryReader() {
+            close();
+        }
+
+        bool open() {
+            close();
+
+            wil::unique_handle file(OpenFileMapping(FILE_MAP_READ, false, FrameTelemetryName));
+            if (!file) {
+                return false;
+            }
+
+            void* const view = MapViewOfFile(file.get(), FILE_MAP_READ, 0, 0, 0);
+            if (!view) {
+                return false;
+            }
+
+            m_file = std::move(file);
+            m_header = reinterpret_cast<const FrameTelemetryHeader*>(view);
+            m_slots = reinterpret_cast<const FrameTelemetrySlot*>(reinterpret_cast<const uint8_t*>(view) +
+                                                                  sizeof(FrameTelemetryHeader));
+
+            return true;
+        }
+
+        void close() {
+            if (m_header) {
+                UnmapViewOfFile(m_header);
+                m_header = nullptr;
+                m_slots = nullptr;
+            }
+            m_file.reset();
+        }
+
+        // Whether a writer initialized the shared memory with a layout that this reader understands. This may change
+        // when a new writer takes over.
+        bool isValid() const {
+            return m_header->magic.load(std::memory_order_acquire) == FrameTelemetryMagic &&
+                   m_header->version == FrameTelemetryVersion &&
+                   m_header->headerSize == sizeof(FrameTelemetryHeader) &&
+                   m_header->slotSize == sizeof(FrameTelemetrySlot) && m_header->capacity == FrameTelemetryCapacity;
+        }
+
+        const FrameTelemetryHeader& getHeader() const {
+            return *m_header;
+        }
+
+        uint64_t getWriteIndex() const {
+            return m_header->writeIndex.load(std::memory_order_acquire);
+        }
+
+        Result read(uint64_t index, FrameTelemetryRecord& record) const {
+            const FrameTelemetrySlot& slot = m_slots[index % FrameTelemetryCapacity];
+
+            const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                return Result::Busy;
+            }
+            const uint64_t slotIndex = slot.index;
+            record = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                return Result::Busy;
+            }
+
+            return slotIndex == index ? Result::Success : Result::Overwritten;
+        }
+
+      private:
+        wil::unique_handle m_file;
+        const FrameTelemetryHeader* m_header{nullptr};
+        const FrameTelemetrySlot* m_slots{nullptr};
+    };
+
+} // namespace virtualdesktop_openxr::utils
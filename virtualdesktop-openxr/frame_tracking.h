@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Count the frames submitted over periods of one second. Unlike a list of frame timestamps, this does not allocate
+    // memory in the frame loop.
+    class FpsCounter {
+      public:
+        static constexpr double Period = 1.0;
+
+        void addFrame(double time) {
+            m_periodFrameCount++;
+            if (time - m_periodStartTime >= Period) {
+                m_fps = m_periodFrameCount;
+                m_periodStartTime = time;
+                m_periodFrameCount = 0;
+            }
+        }
+
+        void reset() {
+            m_periodStartTime = 0.0;
+            m_periodFrameCount = m_fps = 0;
+        }
+
+        // The number of frames during the last complete period.
+        uint32_t fps() const {
+            return m_fps;
+        }
+
+      private:
+        double m_periodStartTime{0.0};
+        uint32_t m_periodFrameCount{0};
+        uint32_t m_fps{0};
+    };
+
+    // Remember which slices of a swapchain were committed during an xrEndFrame() call, so that each slice is only
+    // committed once per call. Each call is identified by a new (non-zero) id, therefore nothing needs to be reset
+    // between calls.
+    class SwapchainCommitTracker {
+      public:
+        void addSlice() {
+            m_lastCommittedFrame.push_back(0);
+        }
+
+        bool isCommitted(uint32_t slice, uint64_t frameId) const {
+            return m_lastCommittedFrame[slice] == frameId;
+        }
+
+        void markCommitted(uint32_t slice, uint64_t frameId) {
+            m_lastCommittedFrame[slice] = frameId;
+        }
+
+      private:
+        std::vector<uint64_t> m_lastCommittedFrame;
+    };
+
+} // namespace virtualdesktop_openxr::utils
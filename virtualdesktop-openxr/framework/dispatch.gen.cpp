@@ -1802,6 +1802,90 @@ namespace RUNTIME_NAMESPACE {
 		return result;
 	}
 
+	XrResult XRAPI_CALL xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance, uint32_t counterPathCapacityInput, uint32_t* counterPathCountOutput, XrPath* counterPaths) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrEnumeratePerformanceMetricsCounterPathsMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrEnumeratePerformanceMetricsCounterPathsMETA(instance, counterPathCapacityInput, counterPathCountOutput, counterPaths);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrEnumeratePerformanceMetricsCounterPathsMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrEnumeratePerformanceMetricsCounterPathsMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrEnumeratePerformanceMetricsCounterPathsMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrEnumeratePerformanceMetricsCounterPathsMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrSetPerformanceMetricsStateMETA(XrSession session, const XrPerformanceMetricsStateMETA* state) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrSetPerformanceMetricsStateMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrSetPerformanceMetricsStateMETA(session, state);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrSetPerformanceMetricsStateMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrSetPerformanceMetricsStateMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrSetPerformanceMetricsStateMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrSetPerformanceMetricsStateMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrGetPerformanceMetricsStateMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrGetPerformanceMetricsStateMETA(session, state);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrGetPerformanceMetricsStateMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrGetPerformanceMetricsStateMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrGetPerformanceMetricsStateMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrGetPerformanceMetricsStateMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrQueryPerformanceMetricsCounterMETA(XrSession session, XrPath counterPath, XrPerformanceMetricsCounterMETA* counter) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrQueryPerformanceMetricsCounterMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrQueryPerformanceMetricsCounterMETA(session, counterPath, counter);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrQueryPerformanceMetricsCounterMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrQueryPerformanceMetricsCounterMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrQueryPerformanceMetricsCounterMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrQueryPerformanceMetricsCounterMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 	XrResult XRAPI_CALL xrCreateFaceTracker2FB(XrSession session, const XrFaceTrackerCreateInfo2FB* createInfo, XrFaceTracker2FB* faceTracker) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateFaceTracker2FB");
@@ -2131,6 +2215,18 @@ namespace RUNTIME_NAMESPACE {
 		else if (has_XR_FB_eye_tracking_social && apiName == "xrGetEyeGazesFB") {
 			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrGetEyeGazesFB);
 		}
+		else if (has_XR_META_performance_metrics && apiName == "xrEnumeratePerformanceMetricsCounterPathsMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrEnumeratePerformanceMetricsCounterPathsMETA);
+		}
+		else if (has_XR_META_performance_metrics && apiName == "xrSetPerformanceMetricsStateMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrSetPerformanceMetricsStateMETA);
+		}
+		else if (has_XR_META_performance_metrics && apiName == "xrGetPerformanceMetricsStateMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrGetPerformanceMetricsStateMETA);
+		}
+		else if (has_XR_META_performance_metrics && apiName == "xrQueryPerformanceMetricsCounterMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrQueryPerformanceMetricsCounterMETA);
+		}
 		else if (has_XR_FB_face_tracking2 && apiName == "xrCreateFaceTracker2FB") {
 			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrCreateFaceTracker2FB);
 		}
@@ -2229,6 +2325,9 @@ namespace RUNTIME_NAMESPACE {
 		else if (extensionName == "XR_HTCX_vive_tracker_interaction") {
 			has_XR_HTCX_vive_tracker_interaction = true;
 		}
+		else if (extensionName == "XR_META_performance_metrics") {
+			has_XR_META_performance_metrics = true;
+		}
 
 	}
 
@@ -127,6 +127,10 @@ namespace RUNTIME_NAMESPACE {
 		virtual XrResult xrCreateEyeTrackerFB(XrSession session, const XrEyeTrackerCreateInfoFB* createInfo, XrEyeTrackerFB* eyeTracker) = 0;
 		virtual XrResult xrDestroyEyeTrackerFB(XrEyeTrackerFB eyeTracker) = 0;
 		virtual XrResult xrGetEyeGazesFB(XrEyeTrackerFB eyeTracker, const XrEyeGazesInfoFB* gazeInfo, XrEyeGazesFB* eyeGazes) = 0;
+		virtual XrResult xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance, uint32_t counterPathCapacityInput, uint32_t* counterPathCountOutput, XrPath* counterPaths) = 0;
+		virtual XrResult xrSetPerformanceMetricsStateMETA(XrSession session, const XrPerformanceMetricsStateMETA* state) = 0;
+		virtual XrResult xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) = 0;
+		virtual XrResult xrQueryPerformanceMetricsCounterMETA(XrSession session, XrPath counterPath, XrPerformanceMetricsCounterMETA* counter) = 0;
 		virtual XrResult xrCreateFaceTracker2FB(XrSession session, const XrFaceTrackerCreateInfo2FB* createInfo, XrFaceTracker2FB* faceTracker) = 0;
 		virtual XrResult xrDestroyFaceTracker2FB(XrFaceTracker2FB faceTracker) = 0;
 		virtual XrResult xrGetFaceExpressionWeights2FB(XrFaceTracker2FB faceTracker, const XrFaceExpressionInfo2FB* expressionInfo, XrFaceExpressionWeights2FB* expressionWeights) = 0;
@@ -163,6 +167,7 @@ namespace RUNTIME_NAMESPACE {
 		bool has_XR_META_body_tracking_full_body{false};
 		bool has_XR_META_body_tracking_fidelity{false};
 		bool has_XR_HTCX_vive_tracker_interaction{false};
+		bool has_XR_META_performance_metrics{false};
 
 
 	};
@@ -0,0 +1,220 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // The combined gaze direction of both eyes.
+    static inline XrVector3f GetGazeDirection(const BodyTracking::Pose& leftEyePose,
+                                              const BodyTracking::Pose& rightEyePose) {
+        const auto toXrPose = [](const BodyTracking::Pose& pose) {
+            return xr::math::Pose::MakePose(
+                XrQuaternionf{pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w},
+                XrVector3f{pose.position.x, pose.position.y, pose.position.z});
+        };
+
+        // Average the poses from both eyes.
+        const auto gaze =
+            xr::math::LoadXrPose(xr::math::Pose::Slerp(toXrPose(leftEyePose), toXrPose(rightEyePose), 0.5f));
+        const auto gazeProjectedPoint = DirectX::XMVector3Transform(DirectX::XMVectorSet(0.f, 0.f, -1.f, 1.f), gaze);
+
+        return xr::math::Normalize(
+            {gazeProjectedPoint.m128_f32[0], gazeProjectedPoint.m128_f32[1], gazeProjectedPoint.m128_f32[2]});
+    }
+
+    // Rotate the gaze by the angular velocity (rad/s) over the duration.
+    static inline DirectX::XMVECTOR RotateGaze(DirectX::FXMVECTOR gaze, DirectX::FXMVECTOR angularVelocity, float dt) {
+        const float speed = DirectX::XMVectorGetX(DirectX::XMVector3Length(angularVelocity));
+        if (speed * dt <= FLT_EPSILON) {
+            return gaze;
+        }
+        return DirectX::XMVector3Rotate(
+            gaze,
+            DirectX::XMQuaternionRotationNormal(DirectX::XMVectorScale(angularVelocity, 1.f / speed), speed * dt));
+    }
+
+    struct GazePredictionParameters {
+        float saccadeVelocity;  // rad/s, to enter a saccade
+        float fixationVelocity; // rad/s, to return to a fixation
+        float fixationCutoff;   // Hz, smoothing during fixations
+        double maxPrediction;   // seconds
+    };
+
+    // The gaze as of the latest sample, which readers extrapolate to the time they need.
+    struct GazeModel {
+        bool isValid{false};
+        bool isSaccade{false};
+        double time{0};
+        double maxPrediction{0};
+        float confidence{0};
+        DirectX::XMFLOAT3 direction{0.f, 0.f, -1.f};
+        // Rotation axis scaled by the angular speed (rad/s).
+        DirectX::XMFLOAT3 angularVelocity{};
+
+        // Returns the confidence in the predicted direction. The confidence decreases with the prediction horizon, and
+        // is lower during saccades, where the eye motion is ballistic but short-lived.
+        float predict(double atTime, XrVector3f& predicted) const {
+            const float dt = (float)std::clamp(atTime - time, 0.0, maxPrediction);
+            const DirectX::XMVECTOR gaze =
+                RotateGaze(DirectX::XMLoadFloat3(&direction), DirectX::XMLoadFloat3(&angularVelocity), dt);
+            DirectX::XMStoreFloat3((DirectX::XMFLOAT3*)&predicted, DirectX::XMVector3Normalize(gaze));
+
+            const float horizon = maxPrediction > 0 ? (float)(dt / maxPrediction) : 0.f;
+            return confidence * (1.f - 0.5f * horizon) * (isSaccade ? 0.5f : 1.f);
+        }
+    };
+
+    // Velocity-based classification of the eye motion (I-VT) with hysteresis. Fixations are smoothed, while saccades
+    // are passed through unfiltered so they are not lagged. In both cases, the angular velocity is used to extrapolate
+    // the gaze.
+    class GazePredictor {
+      public:
+        explicit GazePredictor(const GazePredictionParameters& parameters) : m_parameters(parameters) {
+            m_model.maxPrediction = parameters.maxPrediction;
+        }
+
+        void reset() {
+            m_model.isValid = m_model.isSaccade = false;
+            m_model.angularVelocity = {};
+        }
+
+        const GazeModel& update(double time, const XrVector3f& sample, float confidence) {
+            const DirectX::XMVECTOR direction = xr::math::LoadXrVector3(sample);
+            if (!m_model.isValid) {
+                DirectX::XMStoreFloat3(&m_model.direction, direction);
+                m_lastSample = m_model.direction;
+                m_model.angularVelocity = {};
+                m_model.isSaccade = false;
+                m_model.isValid = true;
+                m_model.time = time;
+                m_model.confidence = confidence;
+                return m_model;
+            }
+
+            const float dt = (float)(time - m_model.time);
+            if (dt <= 0.f) {
+                return m_model;
+            }
+
+            score(time, direction);
+
+            // Instantaneous angular velocity since the previous sample.
+            const DirectX::XMVECTOR lastSample = DirectX::XMLoadFloat3(&m_lastSample);
+            const DirectX::XMVECTOR axis = DirectX::XMVector3Cross(lastSample, direction);
+            const float sinAngle = DirectX::XMVectorGetX(DirectX::XMVector3Length(axis));
+            const float cosAngle = DirectX::XMVectorGetX(DirectX::XMVector3Dot(lastSample, direction));
+            const float speed = std::atan2(sinAngle, cosAngle) / dt;
+            const DirectX::XMVECTOR omega = sinAngle > FLT_EPSILON
+                                                ? DirectX::XMVectorScale(axis, speed / sinAngle)
+                                                : DirectX::XMVectorZero();
+
+            const bool wasSaccade = m_model.isSaccade;
+            m_model.isSaccade =
+                m_model.isSaccade ? speed > m_parameters.fixationVelocity : speed > m_parameters.saccadeVelocity;
+            if (m_model.isSaccade || wasSaccade) {
+                // The smoothing restarts from the first sample after a saccade.
+                DirectX::XMStoreFloat3(&m_model.direction, direction);
+                DirectX::XMStoreFloat3(&m_model.angularVelocity, omega);
+            } else {
+                // Advance the smoothed gaze by its own motion before blending in the sample, so that smooth pursuits
+                // are not lagged behind.
+                const float r = 2.f * (float)M_PI * m_parameters.fixationCutoff * dt;
+                const float alpha = r / (r + 1.f);
+                const DirectX::XMVECTOR advanced = RotateGaze(
+                    DirectX::XMLoadFloat3(&m_model.direction), DirectX::XMLoadFloat3(&m_model.angularVelocity), dt);
+                DirectX::XMStoreFloat3(
+                    &m_model.direction,
+                    DirectX::XMVector3Normalize(DirectX::XMVectorLerp(advanced, direction, alpha)));
+                DirectX::XMStoreFloat3(
+                    &m_model.angularVelocity,
+                    DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&m_model.angularVelocity), omega, alpha));
+            }
+
+            DirectX::XMStoreFloat3(&m_lastSample, direction);
+            m_model.time = time;
+            m_model.confidence = confidence;
+
+            return m_model;
+        }
+
+        const GazeModel& getModel() const {
+            return m_model;
+        }
+
+        // Error of the gaze predicted from the previous sample against the actual sample, compared to simply reusing
+        // the previous sample. This is used to evaluate the prediction (for example on a replayed recording).
+        uint64_t getScoredSampleCount() const {
+            return m_scoredSampleCount;
+        }
+
+        double getMeanPredictionError() const {
+            return m_scoredSampleCount ? m_totalPredictionError / m_scoredSampleCount : 0.0;
+        }
+
+        double getMeanHoldError() const {
+            return m_scoredSampleCount ? m_totalHoldError / m_scoredSampleCount : 0.0;
+        }
+
+        float getMaxPredictionError() const {
+            return m_maxPredictionError;
+        }
+
+        uint64_t getSaccadeSampleCount() const {
+            return m_saccadeSampleCount;
+        }
+
+      private:
+        static float angleBetween(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b) {
+            return DirectX::XMVectorGetX(DirectX::XMVector3AngleBetweenNormals(a, b));
+        }
+
+        void score(double time, DirectX::FXMVECTOR direction) {
+            XrVector3f predicted;
+            m_model.predict(time, predicted);
+            const float predictionError = angleBetween(xr::math::LoadXrVector3(predicted), direction);
+            m_totalPredictionError += predictionError;
+            m_maxPredictionError = std::max(m_maxPredictionError, predictionError);
+            m_totalHoldError += angleBetween(DirectX::XMLoadFloat3(&m_lastSample), direction);
+            m_scoredSampleCount++;
+            if (m_model.isSaccade) {
+                m_saccadeSampleCount++;
+            }
+        }
+
+        const GazePredictionParameters m_parameters;
+        GazeModel m_model;
+        DirectX::XMFLOAT3 m_lastSample{0.f, 0.f, -1.f};
+
+        uint64_t m_scoredSampleCount{0};
+        uint64_t m_saccadeSampleCount{0};
+        double m_totalPredictionError{0};
+        double m_totalHoldError{0};
+        float m_maxPredictionError{0};
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include <hand_simulation.h>
+
+#include "BodyState.h"
+#include "utils.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Constant per-joint parameters for the conversion from SteamVR bones to OpenXR joints.
+    struct BoneConversionTable {
+        // Extra rotation to convert from what SteamVR expects to what OpenXR expects.
+        XrQuaternionf correction[xr::Side::Count][XR_HAND_JOINT_COUNT_EXT];
+        float radius[XR_HAND_JOINT_COUNT_EXT];
+    };
+
+    inline const BoneConversionTable& getBoneConversionTable() {
+        static const BoneConversionTable table = [] {
+            using namespace xr::math;
+
+            BoneConversionTable table{};
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                const XrQuaternionf jointCorrection =
+                    Pose::Orientation({(side == xr::Side::Left) ? 0.f : (float)M_PI, (float)-M_PI_2, (float)M_PI})
+                        .orientation;
+                const XrQuaternionf wristCorrection =
+                    Pose::Orientation({(float)M_PI, 0.f, (side == xr::Side::Left) ? (float)-M_PI_2 : (float)M_PI_2})
+                        .orientation;
+                for (uint32_t i = 0; i < XR_HAND_JOINT_COUNT_EXT; i++) {
+                    table.correction[side][i] = i != XR_HAND_JOINT_WRIST_EXT ? jointCorrection : wristCorrection;
+                }
+            }
+
+            for (uint32_t i = 0; i < XR_HAND_JOINT_COUNT_EXT; i++) {
+                switch (i) {
+                case XR_HAND_JOINT_PALM_EXT:
+                case XR_HAND_JOINT_WRIST_EXT:
+                case XR_HAND_JOINT_INDEX_METACARPAL_EXT:
+                case XR_HAND_JOINT_INDEX_PROXIMAL_EXT:
+                case XR_HAND_JOINT_MIDDLE_METACARPAL_EXT:
+                case XR_HAND_JOINT_MIDDLE_PROXIMAL_EXT:
+                case XR_HAND_JOINT_RING_METACARPAL_EXT:
+                case XR_HAND_JOINT_RING_PROXIMAL_EXT:
+                case XR_HAND_JOINT_LITTLE_METACARPAL_EXT:
+                case XR_HAND_JOINT_LITTLE_PROXIMAL_EXT:
+                    table.radius[i] = 0.016f;
+                    break;
+
+                default:
+                    table.radius[i] = 0.008f;
+                    break;
+                }
+            }
+            return table;
+        }();
+        return table;
+    }
+
+    // Convert the bones of the SteamVR hand skeleton into OpenXR hand joints, relative to the base pose.
+    inline void convertSteamVRBonesToFingerJoints(uint32_t side,
+                                                  const XrPosef& basePose,
+                                                  BodyTracking::FingerJointState* joints,
+                                                  const vr::VRBoneTransform_t* bones) {
+        using namespace xr::math;
+
+        const auto vrPoseToXrPose = [](const vr::VRBoneTransform_t& vrPose) {
+            XrPosef xrPose;
+            xrPose.position.x = vrPose.position.v[0];
+            xrPose.position.y = vrPose.position.v[1];
+            xrPose.position.z = vrPose.position.v[2];
+            xrPose.orientation.x = vrPose.orientation.x;
+            xrPose.orientation.y = vrPose.orientation.y;
+            xrPose.orientation.z = vrPose.orientation.z;
+            xrPose.orientation.w = vrPose.orientation.w;
+
+            return xrPose;
+        };
+
+        const auto xrPoseToBodyTrackingPose = [](const XrPosef& xrPose) {
+            BodyTracking::Pose bodyTrackingPose;
+            bodyTrackingPose.position.x = xrPose.position.x;
+            bodyTrackingPose.position.y = xrPose.position.y;
+            bodyTrackingPose.position.z = xrPose.position.z;
+            bodyTrackingPose.orientation.x = xrPose.orientation.x;
+            bodyTrackingPose.orientation.y = xrPose.orientation.y;
+            bodyTrackingPose.orientation.z = xrPose.orientation.z;
+            bodyTrackingPose.orientation.w = xrPose.orientation.w;
+            return bodyTrackingPose;
+        };
+
+        const BoneConversionTable& conversion = getBoneConversionTable();
+
+        // We must apply the transforms in order of the bone structure:
+        // https://github.com/ValveSoftware/openvr/wiki/Hand-Skeleton#bone-structure
+        XrVector3f barycenter{};
+        XrPosef accumulatedPose = basePose;
+        XrPosef wristPose;
+        for (uint32_t i = 0; i <= eBone_PinkyFinger4; i++) {
+            accumulatedPose = Pose::Multiply(vrPoseToXrPose(bones[i]), accumulatedPose);
+            joints[i].Radius = conversion.radius[i];
+
+            // Palm is estimated after this loop. The correction is a pure rotation, so it leaves the position as-is.
+            if (i != XR_HAND_JOINT_PALM_EXT) {
+                XrPosef correctedPose = accumulatedPose;
+                StoreXrQuaternion(&correctedPose.orientation,
+                                  DirectX::XMQuaternionMultiply(LoadXrQuaternion(conversion.correction[side][i]),
+                                                                LoadXrQuaternion(accumulatedPose.orientation)));
+                joints[i].Pose = xrPoseToBodyTrackingPose(correctedPose);
+            }
+
+            switch (i) {
+            case XR_HAND_JOINT_WRIST_EXT:
+                wristPose = accumulatedPose;
+                break;
+
+            case XR_HAND_JOINT_INDEX_METACARPAL_EXT:
+            case XR_HAND_JOINT_INDEX_PROXIMAL_EXT:
+            case XR_HAND_JOINT_MIDDLE_METACARPAL_EXT:
+            case XR_HAND_JOINT_MIDDLE_PROXIMAL_EXT:
+            case XR_HAND_JOINT_RING_METACARPAL_EXT:
+            case XR_HAND_JOINT_RING_PROXIMAL_EXT:
+            case XR_HAND_JOINT_LITTLE_METACARPAL_EXT:
+            case XR_HAND_JOINT_LITTLE_PROXIMAL_EXT:
+                barycenter = barycenter + accumulatedPose.position;
+                break;
+
+            // Reset to the wrist base pose once we reach the tip.
+            case XR_HAND_JOINT_THUMB_TIP_EXT:
+            case XR_HAND_JOINT_INDEX_TIP_EXT:
+            case XR_HAND_JOINT_MIDDLE_TIP_EXT:
+            case XR_HAND_JOINT_RING_TIP_EXT:
+            case XR_HAND_JOINT_LITTLE_TIP_EXT:
+                accumulatedPose = wristPose;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        // SteamVR doesn't have palm, we compute the barycenter of the metacarpal and proximal for
+        // index/middle/ring/little fingers.
+        barycenter = barycenter / 8.0f;
+        joints[XR_HAND_JOINT_PALM_EXT].Pose = xrPoseToBodyTrackingPose(
+            Pose::MakePose(joints[XR_HAND_JOINT_MIDDLE_METACARPAL_EXT].Pose.orientation, barycenter));
+    }
+
+} // namespace virtualdesktop_openxr::utils
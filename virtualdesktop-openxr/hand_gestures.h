@@ -0,0 +1,217 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // A boolean gesture driven by an analog value, with separate engage and release thresholds to avoid flickering
+    // around a single threshold.
+    class GestureLatch {
+      public:
+        GestureLatch(float engageThreshold, float releaseThreshold)
+            : m_engageThreshold(engageThreshold), m_releaseThreshold(releaseThreshold) {
+        }
+
+        bool update(float value) {
+            m_isActive = m_isActive ? value > m_releaseThreshold : value > m_engageThreshold;
+            return m_isActive;
+        }
+
+        void reset() {
+            m_isActive = false;
+        }
+
+        bool isActive() const {
+            return m_isActive;
+        }
+
+      private:
+        const float m_engageThreshold;
+        const float m_releaseThreshold;
+        bool m_isActive{false};
+    };
+
+    struct HandGestures {
+        // Analog values in [0, 1].
+        float pinchValue{0};
+        float grabValue{0};
+        float pointValue{0};
+        float systemValue{0};
+
+        bool isPinching{false};
+        bool isGrabbing{false};
+        bool isPointing{false};
+        // The index tip of the other hand touching the palm of this hand.
+        bool isSystemGesture{false};
+    };
+
+    // Detect gestures from the hand joints. The gestures only advance when new hand data is published, so that
+    // repeated queries for the same body state update do not skew the hysteresis.
+    class HandGestureEngine {
+      public:
+        static constexpr uint32_t FingerCount = 4;
+
+        // Returns true when the gestures were re-evaluated.
+        bool update(uint64_t generation,
+                    bool leftHandActive,
+                    const BodyTracking::FingerJointState* leftJoints,
+                    bool rightHandActive,
+                    const BodyTracking::FingerJointState* rightJoints) {
+            if (m_isValid && generation == m_generation && leftHandActive == m_isHandActive[xr::Side::Left] &&
+                rightHandActive == m_isHandActive[xr::Side::Right]) {
+                return false;
+            }
+
+            const BodyTracking::FingerJointState* joints[xr::Side::Count] = {leftJoints, rightJoints};
+            const bool isHandActive[xr::Side::Count] = {leftHandActive, rightHandActive};
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                const uint32_t otherSide = side ^ 1;
+                if (isHandActive[side]) {
+                    updateHand(side, joints[side], isHandActive[otherSide] ? joints[otherSide] : nullptr);
+                } else {
+                    resetHand(side);
+                }
+            }
+
+            m_generation = generation;
+            m_isHandActive[xr::Side::Left] = leftHandActive;
+            m_isHandActive[xr::Side::Right] = rightHandActive;
+            m_isValid = true;
+
+            return true;
+        }
+
+        const HandGestures& getGestures(uint32_t side) const {
+            return m_gestures[side];
+        }
+
+        // Proximity in [0, 1] between the tips of the index/middle/ring/little fingers and a reference joint, computed
+        // for the 4 fingers at once.
+        static DirectX::XMVECTOR computeFingerTipsProximity(const BodyTracking::FingerJointState* joints,
+                                                            const BodyTracking::FingerJointState& reference,
+                                                            float nearDistance,
+                                                            float farDistance) {
+            using namespace DirectX;
+
+            static constexpr XrHandJointEXT FingerTips[FingerCount] = {XR_HAND_JOINT_INDEX_TIP_EXT,
+                                                                       XR_HAND_JOINT_MIDDLE_TIP_EXT,
+                                                                       XR_HAND_JOINT_RING_TIP_EXT,
+                                                                       XR_HAND_JOINT_LITTLE_TIP_EXT};
+            const auto& t0 = joints[FingerTips[0]];
+            const auto& t1 = joints[FingerTips[1]];
+            const auto& t2 = joints[FingerTips[2]];
+            const auto& t3 = joints[FingerTips[3]];
+
+            // Structure-of-arrays layout: one lane per finger.
+            const XMVECTOR dx = XMVectorSubtract(
+                XMVectorSet(t0.Pose.position.x, t1.Pose.position.x, t2.Pose.position.x, t3.Pose.position.x),
+                XMVectorReplicate(reference.Pose.position.x));
+            const XMVECTOR dy = XMVectorSubtract(
+                XMVectorSet(t0.Pose.position.y, t1.Pose.position.y, t2.Pose.position.y, t3.Pose.position.y),
+                XMVectorReplicate(reference.Pose.position.y));
+            const XMVECTOR dz = XMVectorSubtract(
+                XMVectorSet(t0.Pose.position.z, t1.Pose.position.z, t2.Pose.position.z, t3.Pose.position.z),
+                XMVectorReplicate(reference.Pose.position.z));
+            const XMVECTOR radii = XMVectorAdd(XMVectorSet(t0.Radius, t1.Radius, t2.Radius, t3.Radius),
+                                               XMVectorReplicate(reference.Radius));
+
+            // Distance between the joints, minus the radii.
+            const XMVECTOR distance = XMVectorSubtract(
+                XMVectorSqrt(XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)))),
+                radii);
+
+            const XMVECTOR nearVector = XMVectorReplicate(nearDistance);
+            return XMVectorSubtract(
+                g_XMOne,
+                XMVectorDivide(XMVectorSubtract(XMVectorClamp(distance, nearVector, XMVectorReplicate(farDistance)),
+                                                nearVector),
+                               XMVectorReplicate(farDistance - nearDistance)));
+        }
+
+      private:
+        // Fingers touching.
+        static constexpr float TouchNearDistance = 0.01f;
+        static constexpr float TouchFarDistance = 0.03f;
+
+        // Fingers curled into the palm.
+        static constexpr float CurlNearDistance = 0.01f;
+        static constexpr float CurlFarDistance = 0.06f;
+
+        void updateHand(uint32_t side,
+                        const BodyTracking::FingerJointState* joints,
+                        const BodyTracking::FingerJointState* otherJoints) {
+            DirectX::XMFLOAT4 pinch;
+            DirectX::XMStoreFloat4(&pinch,
+                                   computeFingerTipsProximity(
+                                       joints, joints[XR_HAND_JOINT_THUMB_TIP_EXT], TouchNearDistance, TouchFarDistance));
+            DirectX::XMFLOAT4 curl;
+            DirectX::XMStoreFloat4(
+                &curl,
+                computeFingerTipsProximity(joints, joints[XR_HAND_JOINT_PALM_EXT], CurlNearDistance, CurlFarDistance));
+
+            HandGestures& gestures = m_gestures[side];
+            gestures.pinchValue = pinch.x;
+            gestures.grabValue = (curl.y + curl.z + curl.w) / 3.f;
+            gestures.pointValue = std::min(1.f - curl.x, gestures.grabValue);
+            gestures.systemValue = 0.f;
+            if (otherJoints) {
+                DirectX::XMFLOAT4 touch;
+                DirectX::XMStoreFloat4(&touch,
+                                       computeFingerTipsProximity(otherJoints,
+                                                                  joints[XR_HAND_JOINT_PALM_EXT],
+                                                                  TouchNearDistance,
+                                                                  TouchFarDistance));
+                gestures.systemValue = touch.x;
+            }
+
+            gestures.isPinching = m_pinch[side].update(gestures.pinchValue);
+            gestures.isGrabbing = m_grab[side].update(gestures.grabValue);
+            gestures.isPointing = m_point[side].update(gestures.pointValue);
+            gestures.isSystemGesture = m_system[side].update(gestures.systemValue);
+        }
+
+        void resetHand(uint32_t side) {
+            m_gestures[side] = {};
+            m_pinch[side].reset();
+            m_grab[side].reset();
+            m_point[side].reset();
+            m_system[side].reset();
+        }
+
+        bool m_isValid{false};
+        uint64_t m_generation{0};
+        bool m_isHandActive[xr::Side::Count]{};
+
+        HandGestures m_gestures[xr::Side::Count];
+        GestureLatch m_pinch[xr::Side::Count]{{0.9f, 0.7f}, {0.9f, 0.7f}};
+        GestureLatch m_grab[xr::Side::Count]{{0.8f, 0.6f}, {0.8f, 0.6f}};
+        GestureLatch m_point[xr::Side::Count]{{0.8f, 0.6f}, {0.8f, 0.6f}};
+        GestureLatch m_system[xr::Side::Count]{{0.9f, 0.7f}, {0.9f, 0.7f}};
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include <hand_simulation.h>
+
+namespace virtualdesktop_openxr::utils {
+
+    // Precomputed bone transforms of the hand simulation. The simulation is sampled on a regular grid of index and grip
+    // curls, for each of the 3 thumb positions, and bilinearly interpolated in between.
+    class HandSimulationTable {
+      public:
+        static constexpr uint32_t CurlSteps = 11;
+        static constexpr uint32_t ThumbStates = 3;
+
+        static constexpr float getThumbCurl(uint32_t thumbState) {
+            return thumbState * 0.5f;
+        }
+
+        // Returns the largest position (in meters) and angle (in radians) error against the simulation, measured in
+        // the middle of each cell of the grid.
+        std::pair<float, float> build(MyHandSimulation& simulation, vr::ETrackedControllerRole role) {
+            m_bones.resize(ThumbStates * CurlSteps * CurlSteps * eBone_Count);
+            for (uint32_t thumb = 0; thumb < ThumbStates; thumb++) {
+                for (uint32_t index = 0; index < CurlSteps; index++) {
+                    for (uint32_t grip = 0; grip < CurlSteps; grip++) {
+                        simulate(simulation,
+                                 role,
+                                 thumb,
+                                 (float)index / (CurlSteps - 1),
+                                 (float)grip / (CurlSteps - 1),
+                                 entry(thumb, index, grip));
+                    }
+                }
+            }
+
+            float maxPositionError = 0.f;
+            float maxAngleError = 0.f;
+            vr::VRBoneTransform_t expected[eBone_Count];
+            vr::VRBoneTransform_t actual[eBone_Count];
+            for (uint32_t thumb = 0; thumb < ThumbStates; thumb++) {
+                for (uint32_t index = 0; index < CurlSteps - 1; index++) {
+                    for (uint32_t grip = 0; grip < CurlSteps - 1; grip++) {
+                        const float indexCurl = (index + 0.5f) / (CurlSteps - 1);
+                        const float gripCurl = (grip + 0.5f) / (CurlSteps - 1);
+                        simulate(simulation, role, thumb, indexCurl, gripCurl, expected);
+                        computeSkeletonTransforms(thumb, indexCurl, gripCurl, actual);
+                        for (uint32_t i = 0; i < eBone_Count; i++) {
+                            const DirectX::XMVECTOR positionError =
+                                DirectX::XMVectorSubtract(loadPosition(expected[i]), loadPosition(actual[i]));
+                            maxPositionError = std::max(
+                                maxPositionError, DirectX::XMVectorGetX(DirectX::XMVector3Length(positionError)));
+                            const float cosHalfAngle = std::abs(DirectX::XMVectorGetX(DirectX::XMVector4Dot(
+                                loadOrientation(expected[i]), loadOrientation(actual[i]))));
+                            maxAngleError = std::max(maxAngleError, 2.f * std::acos(std::min(cosHalfAngle, 1.f)));
+                        }
+                    }
+                }
+            }
+
+            return {maxPositionError, maxAngleError};
+        }
+
+        bool isBuilt() const {
+            return !m_bones.empty();
+        }
+
+        void computeSkeletonTransforms(uint32_t thumbState,
+                                       float indexCurl,
+                                       float gripCurl,
+                                       vr::VRBoneTransform_t* bones) const {
+            // Locate the cell of the grid and the weights of its 4 corners.
+            const float x = std::clamp(indexCurl, 0.f, 1.f) * (CurlSteps - 1);
+            const float y = std::clamp(gripCurl, 0.f, 1.f) * (CurlSteps - 1);
+            const uint32_t x0 = std::min((uint32_t)x, CurlSteps - 2);
+            const uint32_t y0 = std::min((uint32_t)y, CurlSteps - 2);
+            const float tx = x - x0;
+            const float ty = y - y0;
+
+            const vr::VRBoneTransform_t* const corners[] = {entry(thumbState, x0, y0),
+                                                            entry(thumbState, x0 + 1, y0),
+                                                            entry(thumbState, x0, y0 + 1),
+                                                            entry(thumbState, x0 + 1, y0 + 1)};
+            const float weights[] = {(1 - tx) * (1 - ty), tx * (1 - ty), (1 - tx) * ty, tx * ty};
+
+            for (uint32_t i = 0; i < eBone_Count; i++) {
+                DirectX::XMVECTOR position = DirectX::XMVectorZero();
+                DirectX::XMVECTOR orientation = DirectX::XMVectorZero();
+                const DirectX::XMVECTOR reference = loadOrientation(corners[0][i]);
+                for (uint32_t j = 0; j < std::size(corners); j++) {
+                    const DirectX::XMVECTOR weight = DirectX::XMVectorReplicate(weights[j]);
+                    position = DirectX::XMVectorMultiplyAdd(loadPosition(corners[j][i]), weight, position);
+
+                    // Keep all the quaternions in the same hemisphere before blending them.
+                    DirectX::XMVECTOR cornerOrientation = loadOrientation(corners[j][i]);
+                    if (DirectX::XMVectorGetX(DirectX::XMVector4Dot(cornerOrientation, reference)) < 0.f) {
+                        cornerOrientation = DirectX::XMVectorNegate(cornerOrientation);
+                    }
+                    orientation = DirectX::XMVectorMultiplyAdd(cornerOrientation, weight, orientation);
+                }
+                orientation = DirectX::XMQuaternionNormalize(orientation);
+
+                bones[i].position = {DirectX::XMVectorGetX(position),
+                                     DirectX::XMVectorGetY(position),
+                                     DirectX::XMVectorGetZ(position),
+                                     corners[0][i].position.v[3]};
+                bones[i].orientation = {DirectX::XMVectorGetW(orientation),
+                                        DirectX::XMVectorGetX(orientation),
+                                        DirectX::XMVectorGetY(orientation),
+                                        DirectX::XMVectorGetZ(orientation)};
+            }
+        }
+
+      private:
+        static void simulate(MyHandSimulation& simulation,
+                             vr::ETrackedControllerRole role,
+                             uint32_t thumbState,
+                             float indexCurl,
+                             float gripCurl,
+                             vr::VRBoneTransform_t* bones) {
+            MyFingerCurls curls{};
+            curls.thumb = getThumbCurl(thumbState);
+            curls.index = indexCurl;
+            curls.middle = curls.ring = curls.pinky = gripCurl;
+            simulation.ComputeSkeletonTransforms(role, curls, {}, bones);
+        }
+
+        static DirectX::XMVECTOR loadPosition(const vr::VRBoneTransform_t& bone) {
+            return DirectX::XMVectorSet(bone.position.v[0], bone.position.v[1], bone.position.v[2], 0.f);
+        }
+
+        static DirectX::XMVECTOR loadOrientation(const vr::VRBoneTransform_t& bone) {
+            return DirectX::XMVectorSet(bone.orientation.x, bone.orientation.y, bone.orientation.z, bone.orientation.w);
+        }
+
+        vr::VRBoneTransform_t* entry(uint32_t thumbState, uint32_t index, uint32_t grip) {
+            return &m_bones[((thumbState * CurlSteps + index) * CurlSteps + grip) * eBone_Count];
+        }
+
+        const vr::VRBoneTransform_t* entry(uint32_t thumbState, uint32_t index, uint32_t grip) const {
+            return &m_bones[((thumbState * CurlSteps + index) * CurlSteps + grip) * eBone_Count];
+        }
+
+        std::vector<vr::VRBoneTransform_t> m_bones;
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -32,102 +32,70 @@
 namespace {
 
     using namespace virtualdesktop_openxr;
+    using namespace virtualdesktop_openxr::utils;
     using namespace xr::math;
 
-    void convertSteamVRBonesToFingerJoints(uint32_t side,
-                                           const XrPosef& basePose,
-                                           BodyTracking::FingerJointState* joints,
-                                           vr::VRBoneTransform_t* bones) {
-        const auto vrPoseToXrPose = [](const vr::VRBoneTransform_t& vrPose) {
-            XrPosef xrPose;
-            xrPose.position.x = vrPose.position.v[0];
-            xrPose.position.y = vrPose.position.v[1];
-            xrPose.position.z = vrPose.position.v[2];
-            xrPose.orientation.x = vrPose.orientation.x;
-            xrPose.orientation.y = vrPose.orientation.y;
-            xrPose.orientation.z = vrPose.orientation.z;
-            xrPose.orientation.w = vrPose.orientation.w;
-
-            return xrPose;
-        };
-
-        const auto xrPoseToBodyTrackingPose = [](const XrPosef& xrPose) {
-            BodyTracking::Pose bodyTrackingPose;
-            bodyTrackingPose.position.x = xrPose.position.x;
-            bodyTrackingPose.position.y = xrPose.position.y;
-            bodyTrackingPose.position.z = xrPose.position.z;
-            bodyTrackingPose.orientation.x = xrPose.orientation.x;
-            bodyTrackingPose.orientation.y = xrPose.orientation.y;
-            bodyTrackingPose.orientation.z = xrPose.orientation.z;
-            bodyTrackingPose.orientation.w = xrPose.orientation.w;
-            return bodyTrackingPose;
-        };
-
-        // We must apply the transforms in order of the bone structure:
-        // https://github.com/ValveSoftware/openvr/wiki/Hand-Skeleton#bone-structure
-        XrVector3f barycenter{};
-        XrPosef accumulatedPose = basePose;
-        XrPosef wristPose;
-        for (uint32_t i = 0; i <= eBone_PinkyFinger4; i++) {
-            accumulatedPose = Pose::Multiply(vrPoseToXrPose(bones[i]), accumulatedPose);
-
-            // Palm is estimated after this loop.
-            if (i != XR_HAND_JOINT_PALM_EXT) {
-                // We need extra rotations to convert from what SteamVR expects to what OpenXR expects.
-                XrPosef correctedPose;
-                if (i != XR_HAND_JOINT_WRIST_EXT) {
-                    correctedPose = Pose::Multiply(
-                        Pose::Orientation({(side == xr::Side::Left) ? 0.f : (float)M_PI, (float)-M_PI_2, (float)M_PI}),
-                        accumulatedPose);
-                } else {
-                    correctedPose = Pose::Multiply(
-                        Pose::Orientation(
-                            {(float)M_PI, 0.f, (side == xr::Side::Left) ? (float)-M_PI_2 : (float)M_PI_2}),
-                        accumulatedPose);
-                }
-                joints[i].Pose = xrPoseToBodyTrackingPose(correctedPose);
-            }
-
-            switch (i) {
-            case XR_HAND_JOINT_WRIST_EXT:
-                joints[i].Radius = 0.016f;
-                wristPose = accumulatedPose;
-                break;
-
-            case XR_HAND_JOINT_INDEX_METACARPAL_EXT:
-            case XR_HAND_JOINT_INDEX_PROXIMAL_EXT:
-            case XR_HAND_JOINT_MIDDLE_METACARPAL_EXT:
-            case XR_HAND_JOINT_MIDDLE_PROXIMAL_EXT:
-            case XR_HAND_JOINT_RING_METACARPAL_EXT:
-            case XR_HAND_JOINT_RING_PROXIMAL_EXT:
-            case XR_HAND_JOINT_LITTLE_METACARPAL_EXT:
-            case XR_HAND_JOINT_LITTLE_PROXIMAL_EXT:
-                joints[i].Radius = 0.016f;
-                barycenter = barycenter + accumulatedPose.position;
-                break;
-
-            // Reset to the wrist base pose once we reach the tip.
-            case XR_HAND_JOINT_THUMB_TIP_EXT:
-            case XR_HAND_JOINT_INDEX_TIP_EXT:
-            case XR_HAND_JOINT_MIDDLE_TIP_EXT:
-            case XR_HAND_JOINT_RING_TIP_EXT:
-            case XR_HAND_JOINT_LITTLE_TIP_EXT:
-                joints[i].Radius = 0.008f;
-                accumulatedPose = wristPose;
-                break;
+    // The subset of the body state needed for hand tracking.
+    struct HandsState {
+        bool LeftHandActive;
+        bool RightHandActive;
+        BodyTracking::FingerJointState LeftHandJointStates[BodyTracking::HandJointCount];
+        BodyTracking::FingerJointState RightHandJointStates[BodyTracking::HandJointCount];
+        BodyTracking::HandTrackingAimState LeftAimState;
+        BodyTracking::HandTrackingAimState RightAimState;
+    };
+
+    uint64_t readHandsState(const BodyStateBuffer& buffer, HandsState& hands) {
+        return buffer.read([&](const BodyTracking::BodyStateV2& state) {
+            hands.LeftHandActive = state.LeftHandActive;
+            hands.RightHandActive = state.RightHandActive;
+            std::copy_n(state.LeftHandJointStates, BodyTracking::HandJointCount, hands.LeftHandJointStates);
+            std::copy_n(state.RightHandJointStates, BodyTracking::HandJointCount, hands.RightHandJointStates);
+            hands.LeftAimState = state.LeftAimState;
+            hands.RightAimState = state.RightAimState;
+        });
+    }
 
-            default:
-                joints[i].Radius = 0.008f;
-                break;
-            }
+    void blendFingerJoints(const BodyTracking::FingerJointState* older,
+                           const BodyTracking::FingerJointState* newer,
+                           float t,
+                           BodyTracking::FingerJointState* joints) {
+        // Velocities are not extrapolated.
+        const float velocityT = std::min(t, 1.f);
+        for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+            joints[i].Pose = InterpolateBodyTrackingPose(older[i].Pose, newer[i].Pose, t);
+            joints[i].Radius = newer[i].Radius;
+            joints[i].AngularVelocity =
+                InterpolateBodyTrackingVector(older[i].AngularVelocity, newer[i].AngularVelocity, velocityT);
+            joints[i].LinearVelocity =
+                InterpolateBodyTrackingVector(older[i].LinearVelocity, newer[i].LinearVelocity, velocityT);
         }
+    }
+
+    // Read the hands state resolved at the requested time (in OVR time).
+    uint64_t readHandsStateAt(const BodyStateBuffer& buffer, double time, double maxExtrapolation, HandsState& hands) {
+        const auto blend = [&](const BodyTracking::BodyStateV2& older,
+                               double olderTime,
+                               const BodyTracking::BodyStateV2& newer,
+                               double newerTime) {
+            const float t = GetBodyStateBlendFactor(olderTime, newerTime, time, maxExtrapolation);
+
+            // Only blend with the older snapshot when the hand was tracked in both.
+            hands.LeftHandActive = newer.LeftHandActive;
+            hands.RightHandActive = newer.RightHandActive;
+            blendFingerJoints(older.LeftHandActive ? older.LeftHandJointStates : newer.LeftHandJointStates,
+                              newer.LeftHandJointStates,
+                              t,
+                              hands.LeftHandJointStates);
+            blendFingerJoints(older.RightHandActive ? older.RightHandJointStates : newer.RightHandJointStates,
+                              newer.RightHandJointStates,
+                              t,
+                              hands.RightHandJointStates);
+            hands.LeftAimState = newer.LeftAimState;
+            hands.RightAimState = newer.RightAimState;
+        };
 
-        // SteamVR doesn't have palm, we compute the barycenter of the metacarpal and proximal for
-        // index/middle/ring/little fingers.
-        barycenter = barycenter / 8.0f;
-        joints[XR_HAND_JOINT_PALM_EXT].Radius = 0.016f;
-        joints[XR_HAND_JOINT_PALM_EXT].Pose = xrPoseToBodyTrackingPose(
-            Pose::MakePose(joints[XR_HAND_JOINT_MIDDLE_METACARPAL_EXT].Pose.orientation, barycenter));
+        return buffer.readAt(BodyStateSection::Hands, time, blend);
     }
 
 } // namespace
@@ -206,6 +174,21 @@ namespace virtualdesktop_openxr {
             }
         }
 
+        // Precompute the hand simulation the first time it is needed.
+        if (xrHandTracker.useHandJointsSimulation && !m_handSimulationTable[xrHandTracker.side].isBuilt() &&
+            getSetting("use_hand_simulation_table").value_or(true)) {
+            TraceLocalActivity(build);
+            TraceLoggingWriteStart(build, "HandSimulationTable_Build", TLArg(xrHandTracker.side, "Side"));
+            const auto error = m_handSimulationTable[xrHandTracker.side].build(
+                m_handSimulation[xrHandTracker.side],
+                xrHandTracker.side == xr::Side::Left ? vr::TrackedControllerRole_LeftHand
+                                                     : vr::TrackedControllerRole_RightHand);
+            TraceLoggingWriteStop(build,
+                                  "HandSimulationTable_Build",
+                                  TLArg(error.first, "MaxPositionError"),
+                                  TLArg(error.second, "MaxAngleError"));
+        }
+
         *handTracker = (XrHandTrackerEXT)&xrHandTracker;
 
         // Maintain a list of known trackers for validation.
@@ -290,32 +273,89 @@ namespace virtualdesktop_openxr {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
-        const HandTracker& xrHandTracker = *(HandTracker*)handTracker;
+        HandTracker& xrHandTracker = *(HandTracker*)handTracker;
 
         Space& xrBaseSpace = *(Space*)locateInfo->baseSpace;
 
         XrPosef baseSpaceToVirtual = Pose::Identity();
-        const auto flags = locateSpaceToOrigin(xrBaseSpace, locateInfo->time, baseSpaceToVirtual, nullptr, nullptr);
+        XrSpaceVelocity baseSpaceToVirtualVelocity{XR_TYPE_SPACE_VELOCITY};
+        const auto flags = locateSpaceToOrigin(xrBaseSpace,
+                                               locateInfo->time,
+                                               baseSpaceToVirtual,
+                                               velocities ? &baseSpaceToVirtualVelocity : nullptr,
+                                               nullptr);
+
+        // Repeated queries for the same time and base space, with no new body state, yield the same joints. The base
+        // space is part of the key as it was located for this query, so that a base space that lost tracking since the
+        // joints were cached is not reported as valid.
+        const bool isCacheable = m_bodyStateSource && xrHandTracker.useOpticalTracking &&
+                                 !isBodyStateStale(BodyStateSection::Hands);
+        if (isCacheable) {
+            std::unique_lock cacheLock(xrHandTracker.cacheMutex);
+            const HandJointsCache::Entry* cached =
+                xrHandTracker.cache.lookup({locateInfo->time,
+                                            locateInfo->baseSpace,
+                                            flags,
+                                            baseSpaceToVirtual,
+                                            m_bodyStateBuffer.generation()},
+                                           velocities != nullptr,
+                                           has_XR_FB_hand_tracking_aim && aimState);
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrLocateHandJointsEXT_Cache",
+                              TLArg(!!cached, "Hit"),
+                              TLArg(xrHandTracker.cache.hits(), "HitCount"),
+                              TLArg(xrHandTracker.cache.misses(), "MissCount"));
+
+            if (cached) {
+                locations->isActive = XR_TRUE;
+                std::copy_n(cached->jointLocations, XR_HAND_JOINT_COUNT_EXT, locations->jointLocations);
+                if (velocities) {
+                    std::copy_n(cached->jointVelocities, XR_HAND_JOINT_COUNT_EXT, velocities->jointVelocities);
+                }
+                if (has_XR_FB_hand_tracking_aim && aimState) {
+                    aimState->status = cached->aimState.status;
+                    aimState->aimPose = cached->aimState.aimPose;
+                    aimState->pinchStrengthIndex = cached->aimState.pinchStrengthIndex;
+                    aimState->pinchStrengthMiddle = cached->aimState.pinchStrengthMiddle;
+                    aimState->pinchStrengthRing = cached->aimState.pinchStrengthRing;
+                    aimState->pinchStrengthLittle = cached->aimState.pinchStrengthLittle;
+                }
+                if (has_XR_EXT_hand_tracking_data_source && dataSourceState) {
+                    dataSourceState->isActive = XR_TRUE;
+                    dataSourceState->dataSource = XR_HAND_TRACKING_DATA_SOURCE_UNOBSTRUCTED_EXT;
+                }
+                return XR_SUCCESS;
+            }
+        }
 
         BodyTracking::FingerJointState simulationJointStates[XR_HAND_JOINT_COUNT_EXT];
         BodyTracking::FingerJointState* joints = nullptr;
+        // The cache is keyed on the latest generation of the buffer, read before resolving the joints. A publish racing
+        // with this call only causes a spurious miss on the next query.
+        const uint64_t generation = m_bodyStateBuffer.generation();
+        XrSpaceVelocityFlags jointVelocityFlags =
+            XR_SPACE_VELOCITY_ANGULAR_VALID_BIT | XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
 
         {
-            std::shared_lock lock(m_bodyStateMutex);
+            // Take a private snapshot of the hands state, at the requested time.
+            HandsState hands;
+            readHandsStateAt(m_bodyStateBuffer, xrTimeToOvrTime(locateInfo->time), m_bodyStateMaxExtrapolation, hands);
+            if (isBodyStateStale(BodyStateSection::Hands)) {
+                hands.LeftHandActive = hands.RightHandActive = false;
+            }
 
             // Check the hand state.
             bool needHeightAdjustment = true;
-            if (m_bodyState && xrHandTracker.useOpticalTracking &&
-                ((xrHandTracker.side == xr::Side::Left && m_cachedBodyState.LeftHandActive) ||
-                 m_cachedBodyState.RightHandActive)) {
-                joints = xrHandTracker.side == xr::Side::Left ? m_cachedBodyState.LeftHandJointStates
-                                                              : m_cachedBodyState.RightHandJointStates;
+            if (m_bodyStateSource && xrHandTracker.useOpticalTracking &&
+                (xrHandTracker.side == xr::Side::Left ? hands.LeftHandActive : hands.RightHandActive)) {
+                joints = xrHandTracker.side == xr::Side::Left ? hands.LeftHandJointStates : hands.RightHandJointStates;
 
                 TraceLoggingWrite(g_traceProvider,
                                   "xrLocateHandJointsEXT",
                                   TLArg(xrHandTracker.side == xr::Side::Left ? "Left" : "Right", "Side"),
-                                  TLArg(xrHandTracker.side == xr::Side::Left ? !!m_cachedBodyState.LeftHandActive
-                                                                             : !!m_cachedBodyState.RightHandActive,
+                                  TLArg(xrHandTracker.side == xr::Side::Left ? !!hands.LeftHandActive
+                                                                             : !!hands.RightHandActive,
                                         "HandActive"),
                                   TLArg(xr::ToString(joints[XR_HAND_JOINT_PALM_EXT].Pose).c_str(), "Palm"),
                                   TLArg(xr::ToString(joints[XR_HAND_JOINT_WRIST_EXT].Pose).c_str(), "Wrist"),
@@ -334,39 +374,77 @@ namespace virtualdesktop_openxr {
 
             } else if (xrHandTracker.useHandJointsSimulation) {
                 XrPosef basePose = Pose::Identity();
-                const auto flags2 = getControllerPose(xrHandTracker.side, locateInfo->time, basePose, nullptr);
+                XrSpaceVelocity controllerVelocity{XR_TYPE_SPACE_VELOCITY};
+                const auto flags2 = getControllerPose(
+                    xrHandTracker.side, locateInfo->time, basePose, velocities ? &controllerVelocity : nullptr);
 
                 TraceLoggingWrite(g_traceProvider,
                                   "xrLocateHandJointsEXT",
                                   TLArg(xrHandTracker.side == xr::Side::Left ? "Left" : "Right", "Side"),
-                                  TLArg(!!m_cachedBodyState.LeftHandActive, "LeftHandActive"),
-                                  TLArg(!!m_cachedBodyState.RightHandActive, "RightHandActive"),
+                                  TLArg(!!hands.LeftHandActive, "LeftHandActive"),
+                                  TLArg(!!hands.RightHandActive, "RightHandActive"),
                                   TLArg(flags2, "ControllerLocationFlags"));
 
                 if (Pose::IsPoseValid(flags2)) {
                     // Use hand simulation.
                     const uint32_t side = xrHandTracker.side == xr::Side::Left ? 0 : 1;
                     vr::VRBoneTransform_t bones[eBone_Count];
-                    MyFingerCurls curls{};
                     const bool touchA = xrHandTracker.side == xr::Side::Left
                                             ? (m_cachedInputState.Touches & ovrButton_X)
                                             : (m_cachedInputState.Touches & ovrButton_A);
                     const bool touchB = xrHandTracker.side == xr::Side::Left
                                             ? (m_cachedInputState.Touches & ovrButton_Y)
                                             : (m_cachedInputState.Touches & ovrButton_B);
-                    curls.thumb = touchB ? 1.f : touchA ? 0.5f : 0.f;
-                    curls.index = m_cachedInputState.IndexTrigger[side];
-                    curls.middle = curls.ring = curls.pinky = m_cachedInputState.HandTrigger[side];
-                    m_handSimulation[side].ComputeSkeletonTransforms(xrHandTracker.side == xr::Side::Left
-                                                                         ? vr::TrackedControllerRole_LeftHand
-                                                                         : vr::TrackedControllerRole_RightHand,
-                                                                     curls,
-                                                                     {},
-                                                                     bones);
+                    const uint32_t thumbState = touchB ? 2 : touchA ? 1 : 0;
+                    if (m_handSimulationTable[side].isBuilt()) {
+                        m_handSimulationTable[side].computeSkeletonTransforms(thumbState,
+                                                                              m_cachedInputState.IndexTrigger[side],
+                                                                              m_cachedInputState.HandTrigger[side],
+                                                                              bones);
+                    } else {
+                        MyFingerCurls curls{};
+                        curls.thumb = HandSimulationTable::getThumbCurl(thumbState);
+                        curls.index = m_cachedInputState.IndexTrigger[side];
+                        curls.middle = curls.ring = curls.pinky = m_cachedInputState.HandTrigger[side];
+                        m_handSimulation[side].ComputeSkeletonTransforms(xrHandTracker.side == xr::Side::Left
+                                                                             ? vr::TrackedControllerRole_LeftHand
+                                                                             : vr::TrackedControllerRole_RightHand,
+                                                                         curls,
+                                                                         {},
+                                                                         bones);
+                    }
                     convertSteamVRBonesToFingerJoints(xrHandTracker.side,
                                                       Pose::Multiply(m_controllerHandPose[side], basePose),
                                                       simulationJointStates,
                                                       bones);
+
+                    // The simulated hand moves rigidly with the controller. Without the angular velocity, we cannot
+                    // compute the tangential velocity of the joints.
+                    jointVelocityFlags = velocities ? controllerVelocity.velocityFlags : 0;
+                    if (!(jointVelocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)) {
+                        jointVelocityFlags &= ~XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+                    }
+                    const DirectX::XMVECTOR controllerAngularVelocity =
+                        LoadXrVector3(controllerVelocity.angularVelocity);
+                    const DirectX::XMVECTOR controllerLinearVelocity = LoadXrVector3(controllerVelocity.linearVelocity);
+                    for (uint32_t i = 0; i < XR_HAND_JOINT_COUNT_EXT; i++) {
+                        BodyTracking::FingerJointState& joint = simulationJointStates[i];
+                        joint.AngularVelocity = joint.LinearVelocity = {};
+                        if (jointVelocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
+                            const DirectX::XMVECTOR leverArm = DirectX::XMVectorSubtract(
+                                DirectX::XMVectorSet(
+                                    joint.Pose.position.x, joint.Pose.position.y, joint.Pose.position.z, 0.f),
+                                LoadXrVector3(basePose.position));
+                            DirectX::XMStoreFloat3(
+                                (DirectX::XMFLOAT3*)&joint.LinearVelocity,
+                                DirectX::XMVectorAdd(controllerLinearVelocity,
+                                                     DirectX::XMVector3Cross(controllerAngularVelocity, leverArm)));
+                        }
+                        if (jointVelocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
+                            DirectX::XMStoreFloat3((DirectX::XMFLOAT3*)&joint.AngularVelocity,
+                                                   controllerAngularVelocity);
+                        }
+                    }
                     joints = simulationJointStates;
                     needHeightAdjustment = false;
 
@@ -431,12 +509,22 @@ namespace virtualdesktop_openxr {
                 locations->jointLocations[i].radius = joints[i].Radius;
 
                 if (velocities) {
-                    velocities->jointVelocities[i].angularVelocity = {
+                    // The joints velocities are expressed in the same frame as the joints poses. Bring them into the
+                    // base space, accounting for the motion of the base space itself.
+                    XrSpaceVelocity jointVelocity{XR_TYPE_SPACE_VELOCITY};
+                    jointVelocity.angularVelocity = {
                         joints[i].AngularVelocity.x, joints[i].AngularVelocity.y, joints[i].AngularVelocity.z};
-                    velocities->jointVelocities[i].linearVelocity = {
+                    jointVelocity.linearVelocity = {
                         joints[i].LinearVelocity.x, joints[i].LinearVelocity.y, joints[i].LinearVelocity.z};
-                    velocities->jointVelocities[i].velocityFlags =
-                        XR_SPACE_VELOCITY_ANGULAR_VALID_BIT | XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+                    jointVelocity.velocityFlags = jointVelocityFlags;
+                    jointVelocity = Velocity::Relative(Pose::Multiply(poseOfJoint, jointsToVirtual),
+                                                       jointVelocity,
+                                                       baseSpaceToVirtual,
+                                                       baseSpaceToVirtualVelocity);
+
+                    velocities->jointVelocities[i].angularVelocity = jointVelocity.angularVelocity;
+                    velocities->jointVelocities[i].linearVelocity = jointVelocity.linearVelocity;
+                    velocities->jointVelocities[i].velocityFlags = jointVelocity.velocityFlags;
 
                     TraceLoggingWrite(
                         g_traceProvider,
@@ -459,9 +547,8 @@ namespace virtualdesktop_openxr {
             }
 
             if (has_XR_FB_hand_tracking_aim && aimState) {
-                const BodyTracking::HandTrackingAimState& aim = xrHandTracker.side == xr::Side::Left
-                                                                    ? m_cachedBodyState.LeftAimState
-                                                                    : m_cachedBodyState.RightAimState;
+                const BodyTracking::HandTrackingAimState& aim =
+                    xrHandTracker.side == xr::Side::Left ? hands.LeftAimState : hands.RightAimState;
 
                 aimState->status = aim.AimStatus;
                 aimState->aimPose = Pose::Multiply(
@@ -488,69 +575,80 @@ namespace virtualdesktop_openxr {
             }
         }
 
+        if (isCacheable && joints != simulationJointStates) {
+            std::unique_lock cacheLock(xrHandTracker.cacheMutex);
+            HandJointsCache::Entry& cache = xrHandTracker.cache.store(
+                {locateInfo->time, locateInfo->baseSpace, flags, baseSpaceToVirtual, generation});
+            std::copy_n(locations->jointLocations, XR_HAND_JOINT_COUNT_EXT, cache.jointLocations);
+            cache.hasVelocities = velocities != nullptr;
+            if (velocities) {
+                std::copy_n(velocities->jointVelocities, XR_HAND_JOINT_COUNT_EXT, cache.jointVelocities);
+            }
+            cache.hasAimState = has_XR_FB_hand_tracking_aim && aimState;
+            if (cache.hasAimState) {
+                cache.aimState.status = aimState->status;
+                cache.aimState.aimPose = aimState->aimPose;
+                cache.aimState.pinchStrengthIndex = aimState->pinchStrengthIndex;
+                cache.aimState.pinchStrengthMiddle = aimState->pinchStrengthMiddle;
+                cache.aimState.pinchStrengthRing = aimState->pinchStrengthRing;
+                cache.aimState.pinchStrengthLittle = aimState->pinchStrengthLittle;
+            }
+        }
+
         return XR_SUCCESS;
     }
 
     // Detect hand gestures and convert them into controller inputs.
     void OpenXrRuntime::processHandGestures(uint32_t side) {
-        std::shared_lock lock(m_bodyStateMutex);
+        HandsState hands;
+        const uint64_t generation = readHandsState(m_bodyStateBuffer, hands);
+        if (!m_bodyStateSource || isBodyStateStale(BodyStateSection::Hands)) {
+            hands.LeftHandActive = hands.RightHandActive = false;
+        }
 
-        if (m_bodyState &&
-            ((side == xr::Side::Left && m_cachedBodyState.LeftHandActive) || m_cachedBodyState.RightHandActive)) {
-            const BodyTracking::FingerJointState* joints =
-                side == xr::Side::Left ? m_cachedBodyState.LeftHandJointStates : m_cachedBodyState.RightHandJointStates;
+        // Gestures are only re-evaluated once per body state update, regardless of how many times they are queried.
+        if (m_handGestures.update(generation,
+                                  hands.LeftHandActive,
+                                  hands.LeftHandJointStates,
+                                  hands.RightHandActive,
+                                  hands.RightHandJointStates)) {
+            for (uint32_t i = 0; i < xr::Side::Count; i++) {
+                const HandGestures& gestures = m_handGestures.getGestures(i);
+                TraceLoggingWrite(g_traceProvider,
+                                  "HandGestures_Update",
+                                  TLArg(i == xr::Side::Left ? "Left" : "Right", "Side"),
+                                  TLArg(generation, "Generation"),
+                                  TLArg(gestures.pinchValue, "PinchValue"),
+                                  TLArg(gestures.grabValue, "GrabValue"),
+                                  TLArg(gestures.pointValue, "PointValue"),
+                                  TLArg(gestures.systemValue, "SystemValue"),
+                                  TLArg(gestures.isPinching, "Pinching"),
+                                  TLArg(gestures.isGrabbing, "Grabbing"),
+                                  TLArg(gestures.isPointing, "Pointing"),
+                                  TLArg(gestures.isSystemGesture, "SystemGesture"));
+            }
+        }
+
+        if (m_bodyStateSource && (side == xr::Side::Left ? hands.LeftHandActive : hands.RightHandActive)) {
             const bool otherJointsValid =
-                side == xr::Side::Left ? m_cachedBodyState.LeftHandActive : m_cachedBodyState.RightHandActive;
-            const BodyTracking::FingerJointState* otherJoints =
-                side == xr::Side::Left ? m_cachedBodyState.RightHandJointStates : m_cachedBodyState.LeftHandJointStates;
+                side == xr::Side::Left ? hands.RightHandActive : hands.LeftHandActive;
             const BodyTracking::HandTrackingAimState& aimState =
-                side == xr::Side::Left ? m_cachedBodyState.LeftAimState : m_cachedBodyState.RightAimState;
+                side == xr::Side::Left ? hands.LeftAimState : hands.RightAimState;
+            const HandGestures& gestures = m_handGestures.getGestures(side);
 
-            TraceLoggingWrite(
-                g_traceProvider,
-                "HandGestures",
-                TLArg(side == xr::Side::Left ? "Left" : "Right", "Side"),
-                TLArg(otherJointsValid, "OtherHandActive"),
-                TLArg(aimState.PinchStrengthIndex, "PinchStrengthIndex"),
-                TLArg(xr::ToString(joints[XR_HAND_JOINT_PALM_EXT].Pose).c_str(), "Palm"),
-                TLArg(xr::ToString(otherJoints[XR_HAND_JOINT_INDEX_TIP_EXT].Pose).c_str(), "OtherHandIndexTip"));
-
-            const auto jointActionValue = [](const BodyTracking::FingerJointState& joint1,
-                                             const BodyTracking::FingerJointState& joint2) {
-                static constexpr float NearDistance = 0.01f;
-                static constexpr float FarDistance = 0.03f;
-
-                // Compute the distance between the two joints, and subtract the radii.
-                const float distance = std::max(
-                    Length(XrVector3f{joint1.Pose.position.x, joint1.Pose.position.y, joint1.Pose.position.z} -
-                           XrVector3f{joint2.Pose.position.x, joint2.Pose.position.y, joint2.Pose.position.z}) -
-                        joint1.Radius - joint2.Radius,
-                    0.f);
-
-                return 1.f -
-                       (std::clamp(distance, NearDistance, FarDistance) - NearDistance) / (FarDistance - NearDistance);
-            };
-            static constexpr float Threshold = 0.9f;
+            TraceLoggingWrite(g_traceProvider,
+                              "HandGestures",
+                              TLArg(side == xr::Side::Left ? "Left" : "Right", "Side"),
+                              TLArg(otherJointsValid, "OtherHandActive"),
+                              TLArg(aimState.PinchStrengthIndex, "PinchStrengthIndex"),
+                              TLArg(gestures.isSystemGesture, "SystemGesture"));
 
             // Pinch.
             m_cachedInputState.IndexTrigger[side] = aimState.PinchStrengthIndex;
 
-            if (otherJointsValid) {
-                // Y.
-                if (side == xr::Side::Left) {
-                    if (jointActionValue(joints[XR_HAND_JOINT_PALM_EXT], otherJoints[XR_HAND_JOINT_INDEX_TIP_EXT]) >
-                        Threshold) {
-                        m_cachedInputState.Buttons |= ovrButton_Y;
-                    }
-                }
-
-                // B.
-                if (side == xr::Side::Right) {
-                    if (jointActionValue(joints[XR_HAND_JOINT_PALM_EXT], otherJoints[XR_HAND_JOINT_INDEX_TIP_EXT]) >
-                        Threshold) {
-                        m_cachedInputState.Buttons |= ovrButton_B;
-                    }
-                }
+            // Y/B when touching the palm with the index of the other hand.
+            if (gestures.isSystemGesture) {
+                m_cachedInputState.Buttons |= side == xr::Side::Left ? ovrButton_Y : ovrButton_B;
             }
 
             TraceLoggingWrite(
@@ -568,19 +666,22 @@ namespace virtualdesktop_openxr {
             TraceLoggingWrite(g_traceProvider,
                               "HandGestures",
                               TLArg(side == xr::Side::Left ? "Left" : "Right", "Side"),
-                              TLArg(!!m_cachedBodyState.LeftHandActive, "LeftHandActive"),
-                              TLArg(!!m_cachedBodyState.RightHandActive, "RightHandActive"));
+                              TLArg(!!hands.LeftHandActive, "LeftHandActive"),
+                              TLArg(!!hands.RightHandActive, "RightHandActive"));
         }
     }
 
     // Get the pinch pose (replacing aim pose).
     bool OpenXrRuntime::getPinchPose(int side, const XrPosef& controllerPose, XrPosef& pose) const {
-        std::shared_lock lock(m_bodyStateMutex);
+        HandsState hands;
+        readHandsState(m_bodyStateBuffer, hands);
+        if (isBodyStateStale(BodyStateSection::Hands)) {
+            hands.LeftHandActive = hands.RightHandActive = false;
+        }
 
-        if (m_bodyState &&
-            ((side == xr::Side::Left && m_cachedBodyState.LeftHandActive) || m_cachedBodyState.RightHandActive)) {
+        if (m_bodyStateSource && (side == xr::Side::Left ? hands.LeftHandActive : hands.RightHandActive)) {
             const BodyTracking::HandTrackingAimState& aimState =
-                side == xr::Side::Left ? m_cachedBodyState.LeftAimState : m_cachedBodyState.RightAimState;
+                side == xr::Side::Left ? hands.LeftAimState : hands.RightAimState;
             const bool isAimValid = aimState.AimStatus & XR_HAND_TRACKING_AIM_VALID_BIT_FB;
 
             TraceLoggingWrite(g_traceProvider,
@@ -613,8 +714,8 @@ namespace virtualdesktop_openxr {
             TraceLoggingWrite(g_traceProvider,
                               "PinchPose",
                               TLArg(side == xr::Side::Left ? "Left" : "Right", "Side"),
-                              TLArg(!!m_cachedBodyState.LeftHandActive, "LeftHandActive"),
-                              TLArg(!!m_cachedBodyState.RightHandActive, "RightHandActive"));
+                              TLArg(!!hands.LeftHandActive, "LeftHandActive"),
+                              TLArg(!!hands.RightHandActive, "RightHandActive"));
             return false;
         }
     }
@@ -0,0 +1,172 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Estimate the velocities of the hand joints from their recent poses, for producers that do not report them. A
+    // hand whose producer reports any non-zero velocity is left untouched.
+    class HandVelocityEstimator {
+      public:
+        // Samples further apart than this are not used for differentiation.
+        static constexpr double MaxInterval = 0.1;
+
+        void reset() {
+            for (auto& hand : m_hands) {
+                hand.hasPoses = hand.hasVelocities = false;
+            }
+        }
+
+        void apply(BodyTracking::BodyStateV2& state, double time) {
+            apply(m_hands[xr::Side::Left], state.LeftHandActive, state.LeftHandJointStates, time);
+            apply(m_hands[xr::Side::Right], state.RightHandActive, state.RightHandJointStates, time);
+        }
+
+        // Drop the estimates that are too old to describe the motion of the hands, when the producer stopped sending
+        // updates and apply() is no longer called. Returns whether the state was modified.
+        bool expire(BodyTracking::BodyStateV2& state, double time) {
+            const bool leftExpired = expire(m_hands[xr::Side::Left], state.LeftHandJointStates, time);
+            const bool rightExpired = expire(m_hands[xr::Side::Right], state.RightHandJointStates, time);
+            return leftExpired || rightExpired;
+        }
+
+      private:
+        struct HandHistory {
+            bool hasPoses{false};
+            bool hasVelocities{false};
+            double time{0};
+            BodyTracking::Pose poses[BodyTracking::HandJointCount]{};
+            BodyTracking::Vector3 angularVelocities[BodyTracking::HandJointCount]{};
+            BodyTracking::Vector3 linearVelocities[BodyTracking::HandJointCount]{};
+        };
+
+        static bool hasProducerVelocities(const BodyTracking::FingerJointState* joints) {
+            for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                const auto& angular = joints[i].AngularVelocity;
+                const auto& linear = joints[i].LinearVelocity;
+                if (angular.x || angular.y || angular.z || linear.x || linear.y || linear.z) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static void apply(HandHistory& hand, bool isActive, BodyTracking::FingerJointState* joints, double time) {
+            if (!isActive || hasProducerVelocities(joints)) {
+                hand.hasPoses = hand.hasVelocities = false;
+                return;
+            }
+
+            // Other sections of the body state may have changed without the hand moving. Keep the last estimate, until
+            // it is too old to describe the motion of the hand.
+            bool isSamePose = hand.hasPoses;
+            for (uint32_t i = 0; isSamePose && i < BodyTracking::HandJointCount; i++) {
+                isSamePose = !memcmp(&hand.poses[i], &joints[i].Pose, sizeof(BodyTracking::Pose));
+            }
+
+            const double dt = time - hand.time;
+            if (!isSamePose) {
+                if (hand.hasPoses && dt > 0 && dt <= MaxInterval) {
+                    estimate(hand, joints, (float)dt);
+                } else {
+                    hand.hasVelocities = false;
+                }
+                for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                    hand.poses[i] = joints[i].Pose;
+                }
+                hand.time = time;
+                hand.hasPoses = true;
+            } else if (dt > MaxInterval) {
+                // The hand stopped moving (or the producer stalled).
+                hand.hasVelocities = false;
+            }
+
+            if (hand.hasVelocities) {
+                for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                    joints[i].AngularVelocity = hand.angularVelocities[i];
+                    joints[i].LinearVelocity = hand.linearVelocities[i];
+                }
+            }
+        }
+
+        static bool expire(HandHistory& hand, BodyTracking::FingerJointState* joints, double time) {
+            if (!hand.hasVelocities || time - hand.time <= MaxInterval) {
+                return false;
+            }
+
+            hand.hasVelocities = false;
+            for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                joints[i].AngularVelocity = joints[i].LinearVelocity = {};
+            }
+            return true;
+        }
+
+        // Backward differences, blended with the previous estimate to tame the tracking noise.
+        static void estimate(HandHistory& hand, const BodyTracking::FingerJointState* joints, float dt) {
+            using namespace DirectX;
+
+            const float blend = hand.hasVelocities ? 0.5f : 1.f;
+            for (uint32_t i = 0; i < BodyTracking::HandJointCount; i++) {
+                const auto& previous = hand.poses[i];
+                const auto& current = joints[i].Pose;
+
+                const XMVECTOR linear = XMVectorScale(
+                    XMVectorSubtract(XMVectorSet(current.position.x, current.position.y, current.position.z, 0.f),
+                                     XMVectorSet(previous.position.x, previous.position.y, previous.position.z, 0.f)),
+                    1.f / dt);
+
+                // The rotation from the previous to the current orientation, in the reference frame of the poses.
+                const auto& q0 = previous.orientation;
+                const auto& q1 = current.orientation;
+                XMVECTOR delta = XMQuaternionMultiply(XMQuaternionConjugate(XMVectorSet(q0.x, q0.y, q0.z, q0.w)),
+                                                      XMVectorSet(q1.x, q1.y, q1.z, q1.w));
+                if (XMVectorGetW(delta) < 0.f) {
+                    delta = XMVectorNegate(delta);
+                }
+                XMVECTOR axis;
+                float angle;
+                XMQuaternionToAxisAngle(&axis, &angle, delta);
+                const XMVECTOR angular = angle > FLT_EPSILON
+                                             ? XMVectorScale(XMVector3Normalize(axis), angle / dt)
+                                             : XMVectorZero();
+
+                const auto blendInto = [&](BodyTracking::Vector3& estimate, FXMVECTOR value) {
+                    const XMVECTOR blended =
+                        XMVectorLerp(XMVectorSet(estimate.x, estimate.y, estimate.z, 0.f), value, blend);
+                    estimate = {XMVectorGetX(blended), XMVectorGetY(blended), XMVectorGetZ(blended)};
+                };
+                blendInto(hand.linearVelocities[i], linear);
+                blendInto(hand.angularVelocities[i], angular);
+            }
+            hand.hasVelocities = true;
+        }
+
+        HandHistory m_hands[xr::Side::Count];
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -88,10 +88,6 @@ namespace virtualdesktop_openxr {
             xrDestroySession((XrSession)1);
         }
 
-        if (m_bodyState) {
-            UnmapViewOfFile(m_bodyState);
-        }
-
         if (m_ovrSession) {
             ovr_Destroy(m_ovrSession);
         }
@@ -239,6 +235,13 @@ namespace virtualdesktop_openxr {
         // Do this late, since it might rely on extensions being registered.
         initializeRemappingTables();
 
+        if (has_XR_META_performance_metrics) {
+            for (uint32_t i = 0; i < (uint32_t)PerformanceMetricsCounter::Count; i++) {
+                CHECK_XRCMD(xrStringToPath(
+                    XR_NULL_HANDLE, PerformanceMetricsCounters[i].path, &m_performanceMetricsCounterPaths[i]));
+            }
+        }
+
         m_instanceCreated = true;
         *instance = (XrInstance)1;
 
@@ -471,6 +474,9 @@ namespace virtualdesktop_openxr {
         m_extensionsTable.push_back( // Vive Tracker emulation.
             {XR_HTCX_VIVE_TRACKER_INTERACTION_EXTENSION_NAME, XR_HTCX_vive_tracker_interaction_SPEC_VERSION});
 
+        m_extensionsTable.push_back( // Performance counters.
+            {XR_META_PERFORMANCE_METRICS_EXTENSION_NAME, XR_META_performance_metrics_SPEC_VERSION});
+
         // To keep Oculus OpenXR plugin happy.
         m_extensionsTable.push_back({XR_EXT_UUID_EXTENSION_NAME, XR_EXT_uuid_SPEC_VERSION});
         m_extensionsTable.push_back({XR_META_HEADSET_ID_EXTENSION_NAME, XR_META_headset_id_SPEC_VERSION});
@@ -490,6 +496,17 @@ namespace virtualdesktop_openxr {
         return RegGetDword(HKEY_LOCAL_MACHINE, RegPrefix, value);
     }
 
+    // Settings that can be overriden for a specific application, under a sub-key named after its executable.
+    std::optional<int> OpenXrRuntime::getApplicationSetting(const std::string& value) const {
+        if (!m_exeName.empty()) {
+            const auto applicationValue = RegGetDword(HKEY_LOCAL_MACHINE, RegPrefix + "\\" + m_exeName, value);
+            if (applicationValue) {
+                return applicationValue;
+            }
+        }
+        return getSetting(value);
+    }
+
     XrResult XRAPI_CALL xrRequestBodyTrackingFidelityMETA(XrBodyTrackerFB bodyTracker,
                                                           const XrBodyTrackingFidelityMETA fidelity) {
         TraceLocalActivity(local);
@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // What the located hand joints depend on. Two queries with the same key yield the same joints: same time, same base
+    // space located at the same pose and with the same validity, and no body state published in between.
+    struct HandJointsCacheKey {
+        XrTime time{0};
+        XrSpace baseSpace{XR_NULL_HANDLE};
+        XrSpaceLocationFlags baseSpaceFlags{0};
+        XrPosef baseSpacePose{};
+        uint64_t generation{0};
+
+        bool operator==(const HandJointsCacheKey& other) const {
+            return time == other.time && baseSpace == other.baseSpace && baseSpaceFlags == other.baseSpaceFlags &&
+                   !memcmp(&baseSpacePose, &other.baseSpacePose, sizeof(baseSpacePose)) &&
+                   generation == other.generation;
+        }
+    };
+
+    // The last joints located for a hand tracker, reused when the application repeats the same query.
+    class HandJointsCache {
+      public:
+        struct Entry {
+            XrHandJointLocationEXT jointLocations[XR_HAND_JOINT_COUNT_EXT]{};
+            bool hasVelocities{false};
+            XrHandJointVelocityEXT jointVelocities[XR_HAND_JOINT_COUNT_EXT]{};
+            bool hasAimState{false};
+            XrHandTrackingAimStateFB aimState{XR_TYPE_HAND_TRACKING_AIM_STATE_FB};
+        };
+
+        // Returns the cached joints when they were stored under the same key and carry everything the query asks for.
+        const Entry* lookup(const HandJointsCacheKey& key, bool needVelocities, bool needAimState) {
+            const bool isHit = m_isValid && m_key == key && (!needVelocities || m_entry.hasVelocities) &&
+                               (!needAimState || m_entry.hasAimState);
+            if (isHit) {
+                m_hits++;
+            } else {
+                m_misses++;
+            }
+            return isHit ? &m_entry : nullptr;
+        }
+
+        // Replace the cached joints. The caller fills in the returned entry.
+        Entry& store(const HandJointsCacheKey& key) {
+            m_isValid = true;
+            m_key = key;
+            return m_entry;
+        }
+
+        uint64_t hits() const {
+            return m_hits;
+        }
+
+        uint64_t misses() const {
+            return m_misses;
+        }
+
+      private:
+        bool m_isValid{false};
+        HandJointsCacheKey m_key;
+        Entry m_entry;
+        uint64_t m_hits{0};
+        uint64_t m_misses{0};
+    };
+
+    // The converted body skeleton, which only changes when SkeletonChangedCount does.
+    class BodySkeletonCache {
+      public:
+        bool isCurrent(int32_t skeletonChangedCount) const {
+            return m_skeletonChangedCount == skeletonChangedCount;
+        }
+
+        // Replace the cached skeleton. The caller fills in the returned joints.
+        XrBodySkeletonJointFB* store(int32_t skeletonChangedCount) {
+            m_skeletonChangedCount = skeletonChangedCount;
+            return m_joints;
+        }
+
+        const XrBodySkeletonJointFB* joints() const {
+            return m_joints;
+        }
+
+      private:
+        std::optional<int32_t> m_skeletonChangedCount;
+        XrBodySkeletonJointFB m_joints[BodyTracking::FullBodyJointCount]{};
+    };
+
+} // namespace virtualdesktop_openxr::utils
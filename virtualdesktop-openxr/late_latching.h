@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // A quad or cylinder layer placed relative to a motion controller, that can be moved along with the controller
+    // right before the frame is submitted.
+    struct LateLatchedLayer {
+        uint32_t layerIndex;
+        ovrTrackedDeviceType device;
+
+        // The pose of the controller when the layer was placed.
+        ovrPosef devicePose;
+    };
+
+    // Bounds on the correction applied by late-latching. A larger correction is more likely a tracking glitch (eg: the
+    // controller lost and regained tracking) than genuine motion, and the layer is then left where the application
+    // placed it.
+    struct LateLatchingEnvelope {
+        float maxAngle{0.f};    // radians
+        float maxDistance{0.f}; // meters
+    };
+
+    // Compute the correction moving a layer from the previous pose of its controller to the latest one. The correction
+    // is applied with Pose::Multiply(layerPose, correction). Returns false when the correction is outside the envelope.
+    static inline bool GetLateLatchingCorrection(const XrPosef& previousDevicePose,
+                                                 const XrPosef& latestDevicePose,
+                                                 const LateLatchingEnvelope& envelope,
+                                                 XrPosef& correction,
+                                                 float& angle,
+                                                 float& distance) {
+        const XrQuaternionf& q1 = previousDevicePose.orientation;
+        const XrQuaternionf& q2 = latestDevicePose.orientation;
+        const float dot = std::abs(q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w);
+        angle = 2.f * std::acos(std::min(dot, 1.f));
+
+        const XrVector3f& p1 = previousDevicePose.position;
+        const XrVector3f& p2 = latestDevicePose.position;
+        distance = std::sqrt((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y) +
+                             (p2.z - p1.z) * (p2.z - p1.z));
+
+        if (angle > envelope.maxAngle || distance > envelope.maxDistance) {
+            correction = xr::math::Pose::Identity();
+            return false;
+        }
+
+        correction = xr::math::Pose::Multiply(xr::math::Pose::Invert(previousDevicePose), latestDevicePose);
+        return true;
+    }
+
+} // namespace virtualdesktop_openxr::utils
@@ -25,6 +25,7 @@
 // Standard library.
 #define _USE_MATH_DEFINES
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <chrono>
 #include <cmath>
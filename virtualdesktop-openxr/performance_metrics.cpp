@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the necessary support for the XR_META_performance_metrics extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_META_performance_metrics
+
+namespace virtualdesktop_openxr {
+
+    using namespace virtualdesktop_openxr::log;
+    using namespace virtualdesktop_openxr::utils;
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumeratePerformanceMetricsCounterPathsMETA
+    XrResult OpenXrRuntime::xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance,
+                                                                          uint32_t counterPathCapacityInput,
+                                                                          uint32_t* counterPathCountOutput,
+                                                                          XrPath* counterPaths) {
+        TraceLoggingWrite(g_traceProvider,
+                          "xrEnumeratePerformanceMetricsCounterPathsMETA",
+                          TLXArg(instance, "Instance"),
+                          TLArg(counterPathCapacityInput, "CounterPathCapacityInput"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_instanceCreated || instance != (XrInstance)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        const uint32_t counterCount = (uint32_t)PerformanceMetricsCounter::Count;
+        if (counterPathCapacityInput && counterPathCapacityInput < counterCount) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+
+        *counterPathCountOutput = counterCount;
+        TraceLoggingWrite(g_traceProvider,
+                          "xrEnumeratePerformanceMetricsCounterPathsMETA",
+                          TLArg(*counterPathCountOutput, "CounterPathCountOutput"));
+
+        if (counterPathCapacityInput && counterPaths) {
+            for (uint32_t i = 0; i < counterCount; i++) {
+                counterPaths[i] = m_performanceMetricsCounterPaths[i];
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrEnumeratePerformanceMetricsCounterPathsMETA",
+                                  TLArg(PerformanceMetricsCounters[i].path, "CounterPath"));
+            }
+        }
+
+        return XR_SUCCESS;
+    }
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrSetPerformanceMetricsStateMETA
+    XrResult OpenXrRuntime::xrSetPerformanceMetricsStateMETA(XrSession session,
+                                                             const XrPerformanceMetricsStateMETA* state) {
+        if (state->type != XR_TYPE_PERFORMANCE_METRICS_STATE_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrSetPerformanceMetricsStateMETA",
+                          TLXArg(session, "Session"),
+                          TLArg(!!state->enabled, "Enabled"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        // Do not report values sampled during a previous period of activity. The counters will be valid again after
+        // the next call to xrBeginFrame().
+        if (state->enabled && !m_performanceMetricsEnabled.exchange(true)) {
+            m_performanceMetrics.reset();
+        } else if (!state->enabled) {
+            m_performanceMetricsEnabled = false;
+        }
+
+        return XR_SUCCESS;
+    }
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetPerformanceMetricsStateMETA
+    XrResult OpenXrRuntime::xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) {
+        if (state->type != XR_TYPE_PERFORMANCE_METRICS_STATE_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider, "xrGetPerformanceMetricsStateMETA", TLXArg(session, "Session"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        state->enabled = m_performanceMetricsEnabled ? XR_TRUE : XR_FALSE;
+
+        TraceLoggingWrite(g_traceProvider, "xrGetPerformanceMetricsStateMETA", TLArg(!!state->enabled, "Enabled"));
+
+        return XR_SUCCESS;
+    }
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrQueryPerformanceMetricsCounterMETA
+    XrResult OpenXrRuntime::xrQueryPerformanceMetricsCounterMETA(XrSession session,
+                                                                 XrPath counterPath,
+                                                                 XrPerformanceMetricsCounterMETA* counter) {
+        if (counter->type != XR_TYPE_PERFORMANCE_METRICS_COUNTER_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrQueryPerformanceMetricsCounterMETA",
+                          TLXArg(session, "Session"),
+                          TLArg(counterPath, "CounterPath"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        if (!m_performanceMetricsEnabled) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        // The counter paths were created with the instance, so we do not need to take any lock here.
+        const auto it = std::find(std::cbegin(m_performanceMetricsCounterPaths),
+                                  std::cend(m_performanceMetricsCounterPaths),
+                                  counterPath);
+        if (counterPath == XR_NULL_PATH || it == std::cend(m_performanceMetricsCounterPaths)) {
+            return XR_ERROR_PATH_UNSUPPORTED;
+        }
+
+        m_performanceMetrics.read(
+            (PerformanceMetricsCounter)std::distance(std::cbegin(m_performanceMetricsCounterPaths), it), *counter);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrQueryPerformanceMetricsCounterMETA",
+                          TLArg(counter->counterFlags, "CounterFlags"),
+                          TLArg((int)counter->counterUnit, "CounterUnit"),
+                          TLArg(counter->uintValue, "UintValue"),
+                          TLArg(counter->floatValue, "FloatValue"));
+
+        return XR_SUCCESS;
+    }
+
+} // namespace virtualdesktop_openxr
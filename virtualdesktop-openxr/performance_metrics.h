@@ -0,0 +1,165 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // The counters exposed through XR_META_performance_metrics.
+    enum class PerformanceMetricsCounter : uint32_t {
+        AppCpuFrameTime = 0,
+        AppGpuFrameTime,
+        AppMotionToPhotonLatency,
+        CompositorCpuFrameTime,
+        CompositorGpuFrameTime,
+        CompositorDroppedFrameCount,
+        CompositorSpacewarpMode,
+        Count
+    };
+
+    struct PerformanceMetricsCounterDescription {
+        const char* path;
+        XrPerformanceMetricsCounterUnitMETA unit;
+        bool isFloat;
+    };
+
+    // Paths and units of each counter, in the order of PerformanceMetricsCounter.
+    constexpr PerformanceMetricsCounterDescription
+        PerformanceMetricsCounters[(uint32_t)PerformanceMetricsCounter::Count] = {
+            {"/perfmetrics_meta/app/cpu_frametime", XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META, true},
+            {"/perfmetrics_meta/app/gpu_frametime", XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META, true},
+            {"/perfmetrics_meta/app/motion_to_photon_latency",
+             XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+             true},
+            {"/perfmetrics_meta/compositor/cpu_frametime", XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META, true},
+            {"/perfmetrics_meta/compositor/gpu_frametime", XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META, true},
+            {"/perfmetrics_meta/compositor/dropped_frame_count",
+             XR_PERFORMANCE_METRICS_COUNTER_UNIT_GENERIC_META,
+             false},
+            {"/perfmetrics_meta/compositor/spacewarp_mode", XR_PERFORMANCE_METRICS_COUNTER_UNIT_GENERIC_META, false},
+        };
+
+    // The values of all counters for one frame. Invalid counters (eg: no GPU timer or no compositor statistics yet)
+    // are reported without any valid value.
+    struct PerformanceMetricsSnapshot {
+        bool isValid[(uint32_t)PerformanceMetricsCounter::Count]{};
+        float floatValues[(uint32_t)PerformanceMetricsCounter::Count]{};
+        uint32_t uintValues[(uint32_t)PerformanceMetricsCounter::Count]{};
+
+        void set(PerformanceMetricsCounter counter, float value) {
+            isValid[(uint32_t)counter] = true;
+            floatValues[(uint32_t)counter] = value;
+        }
+
+        void set(PerformanceMetricsCounter counter, uint32_t value) {
+            isValid[(uint32_t)counter] = true;
+            uintValues[(uint32_t)counter] = value;
+        }
+    };
+
+    // Build the snapshot of the counters from the runtime's own timers and the LibOVR statistics. The application CPU
+    // and GPU times are in microseconds, and appGpuTimeUs is ignored when there is no GPU timer.
+    static inline PerformanceMetricsSnapshot
+    SamplePerformanceMetrics(const ovrPerfStats& stats, uint64_t appCpuTimeUs, std::optional<uint64_t> appGpuTimeUs) {
+        PerformanceMetricsSnapshot snapshot;
+        snapshot.set(PerformanceMetricsCounter::AppCpuFrameTime, appCpuTimeUs / 1e3f);
+        if (appGpuTimeUs) {
+            snapshot.set(PerformanceMetricsCounter::AppGpuFrameTime, appGpuTimeUs.value() / 1e3f);
+        }
+
+        // The most recent statistics come first.
+        if (stats.FrameStatsCount > 0) {
+            const ovrPerfStatsPerCompositorFrame& frameStats = stats.FrameStats[0];
+            snapshot.set(PerformanceMetricsCounter::AppMotionToPhotonLatency,
+                         frameStats.AppMotionToPhotonLatency * 1e3f);
+            snapshot.set(PerformanceMetricsCounter::CompositorCpuFrameTime,
+                         frameStats.CompositorCpuElapsedTime * 1e3f);
+            snapshot.set(PerformanceMetricsCounter::CompositorGpuFrameTime,
+                         frameStats.CompositorGpuElapsedTime * 1e3f);
+            snapshot.set(PerformanceMetricsCounter::CompositorDroppedFrameCount,
+                         (uint32_t)std::max(frameStats.CompositorDroppedFrameCount, 0));
+            snapshot.set(PerformanceMetricsCounter::CompositorSpacewarpMode,
+                         (uint32_t)(frameStats.AswIsActive ? 1 : 0));
+        }
+
+        return snapshot;
+    }
+
+    // Publication of the latest snapshot from the frame thread to any thread querying the counters.
+    // Each counter is packed with its validity into a single word, so that a query is one atomic load and never waits
+    // on the frame thread. Counters are queried one at a time, therefore there is no need to keep them consistent with
+    // each other.
+    class PerformanceMetricsBuffer {
+      public:
+        // Writer side (single thread only).
+        void publish(const PerformanceMetricsSnapshot& snapshot) {
+            for (uint32_t i = 0; i < (uint32_t)PerformanceMetricsCounter::Count; i++) {
+                uint32_t bits = 0;
+                if (PerformanceMetricsCounters[i].isFloat) {
+                    memcpy(&bits, &snapshot.floatValues[i], sizeof(bits));
+                } else {
+                    bits = snapshot.uintValues[i];
+                }
+                m_counters[i].store((snapshot.isValid[i] ? ValidBit : 0) | bits, std::memory_order_relaxed);
+            }
+        }
+
+        void reset() {
+            for (auto& counter : m_counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Reader side (any thread).
+        void read(PerformanceMetricsCounter counter, XrPerformanceMetricsCounterMETA& value) const {
+            const PerformanceMetricsCounterDescription& description = PerformanceMetricsCounters[(uint32_t)counter];
+            const uint64_t packed = m_counters[(uint32_t)counter].load(std::memory_order_relaxed);
+            const uint32_t bits = (uint32_t)packed;
+
+            value.counterUnit = description.unit;
+            value.counterFlags = 0;
+            value.uintValue = 0;
+            value.floatValue = 0.f;
+            if (!(packed & ValidBit)) {
+                return;
+            }
+
+            value.counterFlags = XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META;
+            if (description.isFloat) {
+                memcpy(&value.floatValue, &bits, sizeof(bits));
+                value.counterFlags |= XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META;
+            } else {
+                value.uintValue = bits;
+                value.counterFlags |= XR_PERFORMANCE_METRICS_COUNTER_UINT_VALUE_VALID_BIT_META;
+            }
+        }
+
+      private:
+        static constexpr uint64_t ValidBit = 1ull << 32;
+
+        std::atomic<uint64_t> m_counters[(uint32_t)PerformanceMetricsCounter::Count]{};
+    };
+
+} // namespace virtualdesktop_openxr::utils
@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Learn how long the application takes between waking up from xrWaitFrame() and handing off its layers, and pick
+    // the smallest running start that lets it submit before the compositor's next slot. A smaller running start means
+    // the application samples its poses closer to display time.
+    class RunningStartController {
+      public:
+        // Initial and fallback value, matching the historical constant.
+        static constexpr double DefaultRunningStart = 0.002;
+
+        // Exponential smoothing of the application frame time statistics.
+        static constexpr double Alpha = 0.05;
+
+        // How many standard deviations of the application frame time to cover.
+        static constexpr double Deviations = 3.0;
+
+        // Extra margin to absorb thread wake-up latency.
+        static constexpr double Guard = 0.0005;
+
+        // Shrink by at most this fraction of the distance to the target per frame.
+        static constexpr double ShrinkRate = 0.05;
+
+        // Do not shrink for this many frames after a missed frame.
+        static constexpr uint32_t MissHoldFrames = 90;
+
+        void configure(bool isAdaptive, double minRunningStart, double maxRunningStart) {
+            maxRunningStart = std::max(maxRunningStart, minRunningStart);
+            if (isAdaptive != m_isAdaptive || minRunningStart != m_minRunningStart ||
+                maxRunningStart != m_maxRunningStart) {
+                m_isAdaptive = isAdaptive;
+                m_minRunningStart = minRunningStart;
+                m_maxRunningStart = maxRunningStart;
+                reset();
+            }
+        }
+
+        void reset() {
+            m_runningStart = m_isAdaptive ? std::clamp(DefaultRunningStart, m_minRunningStart, m_maxRunningStart)
+                                          : DefaultRunningStart;
+            m_numSamples = 0;
+            m_meanFrameTime = m_varianceFrameTime = 0;
+            m_holdFrames = 0;
+            m_numFrames = m_numMissedFrames = 0;
+        }
+
+        // appFrameTime: time between the application waking up and submitting its layers.
+        // submitTime: time between the compositor opening the slot for these layers and their submission.
+        // Returns whether the frame was submitted too late for the compositor.
+        bool update(double appFrameTime, double submitTime, double frameDuration) {
+            const bool isMissed = submitTime > frameDuration;
+            m_numFrames++;
+            if (isMissed) {
+                m_numMissedFrames++;
+            }
+
+            if (!m_isAdaptive) {
+                return isMissed;
+            }
+
+            // Outliers (eg: loading screens) would poison the statistics for a long time.
+            appFrameTime = std::min(appFrameTime, 2 * frameDuration);
+            if (m_numSamples++ == 0) {
+                m_meanFrameTime = appFrameTime;
+                m_varianceFrameTime = 0;
+            } else {
+                const double delta = appFrameTime - m_meanFrameTime;
+                m_meanFrameTime += Alpha * delta;
+                m_varianceFrameTime = (1 - Alpha) * (m_varianceFrameTime + Alpha * delta * delta);
+            }
+
+            // The application wakes up at the start of the slot minus the running start, and must submit before the
+            // start of the next slot.
+            const double target = std::clamp(m_meanFrameTime + Deviations * std::sqrt(m_varianceFrameTime) -
+                                                 frameDuration + Guard,
+                                             m_minRunningStart,
+                                             m_maxRunningStart);
+
+            if (isMissed) {
+                // React immediately, and do not try to win back the latency for a while.
+                m_runningStart = std::min(std::max({target, 2 * m_runningStart, m_runningStart + Guard}),
+                                          m_maxRunningStart);
+                m_holdFrames = MissHoldFrames;
+            } else if (target > m_runningStart) {
+                m_runningStart = target;
+            } else if (m_holdFrames > 0) {
+                m_holdFrames--;
+            } else {
+                m_runningStart += ShrinkRate * (target - m_runningStart);
+            }
+
+            return isMissed;
+        }
+
+        double getRunningStart() const {
+            return m_runningStart;
+        }
+
+        double getMeanFrameTime() const {
+            return m_meanFrameTime;
+        }
+
+        double getFrameTimeDeviation() const {
+            return std::sqrt(m_varianceFrameTime);
+        }
+
+        uint64_t getNumFrames() const {
+            return m_numFrames;
+        }
+
+        uint64_t getNumMissedFrames() const {
+            return m_numMissedFrames;
+        }
+
+      private:
+        bool m_isAdaptive{false};
+        double m_minRunningStart{DefaultRunningStart};
+        double m_maxRunningStart{DefaultRunningStart};
+
+        double m_runningStart{DefaultRunningStart};
+        uint64_t m_numSamples{0};
+        double m_meanFrameTime{0};
+        double m_varianceFrameTime{0};
+        uint32_t m_holdFrames{0};
+
+        uint64_t m_numFrames{0};
+        uint64_t m_numMissedFrames{0};
+    };
+
+} // namespace virtualdesktop_openxr::utils
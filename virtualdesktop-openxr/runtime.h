@@ -27,7 +27,24 @@
 #include "utils.h"
 
 #include "BodyState.h"
+#include "body_state_buffer.h"
+#include "body_state_filter.h"
+#include "body_state_recording.h"
+#include "body_state_sources.h"
 #include <hand_simulation.h>
+#include "hand_simulation_table.h"
+#include "hand_bone_conversion.h"
+#include "hand_gestures.h"
+#include "accessibility_remapping.h"
+#include "gaze_prediction.h"
+#include "hand_velocity_estimator.h"
+#include "joints_cache.h"
+#include "running_start.h"
+#include "async_submission_queue.h"
+#include "frame_telemetry.h"
+#include "frame_tracking.h"
+#include "performance_metrics.h"
+#include "late_latching.h"
 #include "trackers.h"
 
 namespace virtualdesktop_openxr {
@@ -289,6 +306,16 @@ namespace virtualdesktop_openxr {
                                                  uint32_t pathCapacityInput,
                                                  uint32_t* pathCountOutput,
                                                  XrViveTrackerPathsHTCX* paths) override;
+        XrResult xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance,
+                                                               uint32_t counterPathCapacityInput,
+                                                               uint32_t* counterPathCountOutput,
+                                                               XrPath* counterPaths) override;
+        XrResult xrSetPerformanceMetricsStateMETA(XrSession session,
+                                                  const XrPerformanceMetricsStateMETA* state) override;
+        XrResult xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) override;
+        XrResult xrQueryPerformanceMetricsCounterMETA(XrSession session,
+                                                      XrPath counterPath,
+                                                      XrPerformanceMetricsCounterMETA* counter) override;
 
       private:
         struct Extension {
@@ -317,6 +344,7 @@ namespace virtualdesktop_openxr {
 
             // Resources needed to resolve MSAA and/or format conversion or alpha correction.
             std::vector<int> lastProcessedIndex;
+            SwapchainCommitTracker commits;
             std::vector<std::vector<ComPtr<ID3D11ShaderResourceView>>> imagesResourceView;
             std::vector<std::vector<ComPtr<ID3D11RenderTargetView>>> renderTargetView;
             ComPtr<ID3D11Texture2D> resolved;
@@ -399,6 +427,11 @@ namespace virtualdesktop_openxr {
             int side;
             bool useOpticalTracking{true};
             bool useHandJointsSimulation{false};
+
+            // The last joints located from the body state, reused when the application repeats the same query before
+            // the body state is updated.
+            std::mutex cacheMutex;
+            HandJointsCache cache;
         };
 
         struct EyeTracker {};
@@ -410,6 +443,10 @@ namespace virtualdesktop_openxr {
         struct BodyTracker {
             bool useFullBody{false};
             XrBodyTrackingFidelityMETA maxFidelity{XR_BODY_TRACKING_FIDELITY_LOW_META};
+
+            // The skeleton only changes when SkeletonChangedCount does.
+            std::mutex skeletonMutex;
+            BodySkeletonCache skeleton;
         };
 
         enum class EyeTracking {
@@ -418,11 +455,21 @@ namespace virtualdesktop_openxr {
             Simulated,
         };
 
+        enum class BodyStateWatcherPolicy {
+            // Copy the body state as soon as it is signaled.
+            Event = 0,
+            // Copy the body state at most at a fixed rate.
+            RateLimited,
+            // Learn the update rate of the producer and pace the copies accordingly.
+            Adaptive,
+        };
+
         // instance.cpp
         void initializeExtensionsTable();
         XrTime ovrTimeToXrTime(double ovrTime) const;
         double xrTimeToOvrTime(XrTime xrTime) const;
         std::optional<int> getSetting(const std::string& value) const;
+        std::optional<int> getApplicationSetting(const std::string& value) const;
 
         // system.cpp
         bool initializeOVR();
@@ -430,8 +477,9 @@ namespace virtualdesktop_openxr {
         void enterVisibleMode();
         bool ensureOVRSession();
         void initializeSystem();
-        void initializeBodyTrackingMmf();
+        void initializeBodyStateSource();
         void bodyStateWatcherThread();
+        bool isBodyStateStale(BodyStateSection section) const;
 
         // session.cpp
         void updateSessionState(bool forceSendEvent = false);
@@ -462,15 +510,20 @@ namespace virtualdesktop_openxr {
                                          XrTime time,
                                          XrPosef& pose,
                                          XrSpaceVelocity* velocity = nullptr,
-                                         XrEyeGazeSampleTimeEXT* gazeSampleTime = nullptr) const;
+                                         XrEyeGazeSampleTimeEXT* gazeSampleTime = nullptr,
+                                         std::optional<XrPosef>* controllerPose = nullptr) const;
         XrSpaceLocationFlags locateSpaceToOrigin(const Space& xrSpace,
                                                  XrTime time,
                                                  XrPosef& pose,
                                                  XrSpaceVelocity* velocity,
-                                                 XrEyeGazeSampleTimeEXT* gazeSampleTime) const;
+                                                 XrEyeGazeSampleTimeEXT* gazeSampleTime,
+                                                 std::optional<XrPosef>* controllerPose = nullptr) const;
         XrSpaceLocationFlags getHmdPose(XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
         XrSpaceLocationFlags getControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
+        XrSpaceLocationFlags
+        getMirroredControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
         XrSpaceLocationFlags getEyeTrackerPose(XrTime time, XrPosef& pose, XrEyeGazeSampleTimeEXT* sampleTime) const;
+        int getLateLatchingController(const Space& xrSpace) const;
 
         // eye_tracking.cpp
         bool getEyeGaze(XrTime time, bool getStateOnly, XrVector3f& unitVector, XrTime& sampleTime) const;
@@ -486,7 +539,11 @@ namespace virtualdesktop_openxr {
 
         // frame.cpp
         void asyncSubmissionThread();
-        void waitForAsyncSubmissionIdle(bool doRunningStart = false);
+        void waitForAsyncSubmissionIdle(bool doRunningStart = false, uint32_t maxFramesInFlight = 0);
+        void waitForAsyncSubmissionHandoff();
+        void lateLatchLayers(std::vector<ovrLayer_Union>& layers,
+                             const std::vector<LateLatchedLayer>& lateLatchedLayers,
+                             double displayTime);
 
         // d3d11_native.cpp
         XrResult initializeD3D11(const XrGraphicsBindingD3D11KHR& d3dBindings);
@@ -499,8 +556,7 @@ namespace virtualdesktop_openxr {
         void prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
                                             uint32_t layerIndex,
                                             uint32_t slice,
-                                            XrCompositionLayerFlags compositionFlags,
-                                            std::set<std::pair<ovrTextureSwapChain, uint32_t>>& committed);
+                                            XrCompositionLayerFlags compositionFlags);
         void ensureSwapchainSliceResources(Swapchain& xrSwapchain, uint32_t slice) const;
         void ensureSwapchainIntermediateResources(Swapchain& xrSwapchain) const;
         void flushD3D11Context();
@@ -574,8 +630,7 @@ namespace virtualdesktop_openxr {
         std::string m_exeName;
         bool m_useApplicationDeviceForSubmission{true};
         EyeTracking m_eyeTrackingType{EyeTracking::None};
-        wil::unique_handle m_bodyStateFile;
-        BodyTracking::BodyStateV2* m_bodyState{nullptr};
+        std::unique_ptr<IBodyStateSource> m_bodyStateSource;
         bool m_supportsHandTracking{false};
         bool m_supportsFaceTracking{false};
         bool m_supportsBodyTracking{false};
@@ -625,6 +680,8 @@ namespace virtualdesktop_openxr {
         Space* m_viewSpace{nullptr};
         std::map<std::string, std::vector<XrActionSuggestedBinding>> m_suggestedBindings;
         bool m_isControllerActive[xr::Side::Count]{false, false};
+        bool m_isControllerEmulated[xr::Side::Count]{false, false};
+        AccessibilityRemapping m_accessibilityRemapping;
         std::string m_cachedControllerType[xr::Side::Count];
         XrPosef m_controllerAimOffset{xr::math::Pose::Identity()};
         XrPosef m_controllerGripOffset{xr::math::Pose::Identity()};
@@ -643,7 +700,13 @@ namespace virtualdesktop_openxr {
         Haptic m_currentVibration[xr::Side::Count];
         bool m_useRunningStart{true};
         bool m_jiggleViewRotations{false};
+        bool m_useLateLatching{false};
+        LateLatchingEnvelope m_lateLatchingEnvelope;
+        double m_bodyStateMaxExtrapolation{0};
+        double m_bodyStateStaleTimeout{0};
         MyHandSimulation m_handSimulation[xr::Side::Count];
+        HandSimulationTable m_handSimulationTable[xr::Side::Count];
+        HandGestureEngine m_handGestures;
 
         // Swapchains and other graphics stuff.
         std::mutex m_swapchainsMutex;
@@ -662,18 +725,19 @@ namespace virtualdesktop_openxr {
         // Async submission thread.
         bool m_useAsyncSubmission{false};
         bool m_needStartAsyncSubmissionThread{false};
-        bool m_terminateAsyncThread{false};
         std::thread m_asyncSubmissionThread;
-        std::mutex m_asyncSubmissionMutex;
-        std::condition_variable m_asyncSubmissionCondVar;
-        std::vector<ovrLayer_Union> m_layersForAsyncSubmission;
-        std::chrono::high_resolution_clock::time_point m_lastWaitToBeginFrameTime{};
+        AsyncSubmissionQueue m_asyncSubmissionQueue;
+        // Written by the async submission thread and read by the app thread, as high_resolution_clock ticks.
+        std::atomic<int64_t> m_lastWaitToBeginFrameTime{0};
+        std::chrono::high_resolution_clock::time_point m_lastFrameWaitedTime{};
+        RunningStartController m_runningStart;
 
         // Body tracking thread.
         bool m_terminateBodyStateThread{false};
         std::thread m_bodyStateWatcherThread;
-        mutable std::shared_mutex m_bodyStateMutex;
-        wil::unique_handle m_bodyStateEvent;
+        BodyStateBuffer m_bodyStateBuffer;
+        mutable std::mutex m_gazeModelMutex;
+        GazeModel m_gazeModel;
 
         // Graphics API interop.
         ComPtr<ID3D11Device5> m_d3d11Device;
@@ -725,17 +789,25 @@ namespace virtualdesktop_openxr {
         uint64_t m_frameWaited{0};
         uint64_t m_frameBegun{0};
         uint64_t m_frameCompleted{0};
+        uint64_t m_commitFrameId{0};
+        std::vector<ovrLayer_Union> m_layersForSubmission;
         uint64_t m_lastCpuFrameTimeUs{0};
         uint64_t m_lastGpuFrameTimeUs{0};
         ovrInputState m_cachedInputState;
-        BodyTracking::BodyStateV2 m_cachedBodyState{};
         XrTime m_lastPredictedDisplayTime{0};
         mutable std::optional<XrPosef> m_lastValidHmdPose;
 
         // Statistics.
         double m_sessionStartTime{0.0};
         uint64_t m_sessionTotalFrameCount{0};
-        std::deque<double> m_frameTimes;
+        FpsCounter m_fpsCounter;
+        double m_lastWaitFrameTime{0.0};
+        double m_lastWaitFramePredictedDisplayTime{0.0};
+        FrameTelemetry m_frameTelemetry;
+        FrameTelemetryRecord m_frameTelemetryRecord{};
+        XrPath m_performanceMetricsCounterPaths[(uint32_t)PerformanceMetricsCounter::Count]{};
+        std::atomic<bool> m_performanceMetricsEnabled{false};
+        PerformanceMetricsBuffer m_performanceMetrics;
         CpuTimer m_frameTimerApp;
         CpuTimer m_renderTimerApp;
         static constexpr uint32_t k_numGpuTimers = 3;
@@ -154,6 +154,14 @@ namespace virtualdesktop_openxr {
         // Read configuration and set up the session accordingly.
         refreshSettings();
 
+        if (getSetting("frame_telemetry").value_or(false)) {
+            if (m_frameTelemetry.open(m_applicationName)) {
+                Log("Publishing frame telemetry\n");
+            } else {
+                ErrorLog("Failed to open the frame telemetry shared memory, is another application publishing?\n");
+            }
+        }
+
         m_sessionCreated = true;
 
         // FIXME: Reset the session and frame state here.
@@ -162,7 +170,7 @@ namespace virtualdesktop_openxr {
         m_sessionState = XR_SESSION_STATE_IDLE;
         updateSessionState(true);
 
-        m_frameTimes.clear();
+        m_fpsCounter.reset();
 
         m_isControllerActive[xr::Side::Left] = m_isControllerActive[xr::Side::Right] = false;
         m_controllerAimPose[xr::Side::Left] = m_controllerGripPose[xr::Side::Left] =
@@ -208,17 +216,24 @@ namespace virtualdesktop_openxr {
         }
 
         if (m_useAsyncSubmission && !m_needStartAsyncSubmissionThread) {
-            {
-                std::unique_lock lock(m_asyncSubmissionMutex);
-
-                m_terminateAsyncThread = true;
-                m_asyncSubmissionCondVar.notify_all();
-            }
+            m_asyncSubmissionQueue.terminate();
             m_asyncSubmissionThread.join();
             m_asyncSubmissionThread = {};
             m_needStartAsyncSubmissionThread = true;
+
+            if (m_useRunningStart && m_runningStart.getNumFrames() > 0) {
+                Log("Running start: %.2fms (app frame time %.2f+/-%.2fms, %llu/%llu missed frames)\n",
+                    m_runningStart.getRunningStart() * 1e3,
+                    m_runningStart.getMeanFrameTime() * 1e3,
+                    m_runningStart.getFrameTimeDeviation() * 1e3,
+                    m_runningStart.getNumMissedFrames(),
+                    m_runningStart.getNumFrames());
+            }
         }
 
+        m_frameTelemetry.close();
+        m_performanceMetricsEnabled = false;
+
         // Shutdown the body state watcher.
         if (m_bodyStateWatcherThread.joinable()) {
             m_terminateBodyStateThread = true;
@@ -332,6 +347,10 @@ namespace virtualdesktop_openxr {
         m_useAsyncSubmission = !m_isHeadless && !m_useApplicationDeviceForSubmission &&
                                !getSetting("quirk_disable_async_submission").value_or(false);
         m_needStartAsyncSubmissionThread = m_useAsyncSubmission;
+        // Depth 2 lets the application render the next frame while the previous one awaits its slot. Larger values are
+        // clamped (see AsyncSubmissionQueue).
+        m_asyncSubmissionQueue.setDepth(std::max(getSetting("async_submission_queue_depth").value_or(1), 1));
+        m_runningStart.reset();
         // Creation of the submission threads is deferred to the first xrWaitFrame() to accomodate OpenComposite quirks.
 
         // Start the body watcher thread.
@@ -507,17 +526,61 @@ namespace virtualdesktop_openxr {
         m_useMirrorWindow = getSetting("mirror_window").value_or(false);
 
         m_useRunningStart = !getSetting("quirk_disable_running_start").value_or(false);
+        const bool useAdaptiveRunningStart = getSetting("adaptive_running_start").value_or(true);
+        const double minRunningStart = std::max(getSetting("running_start_min_us").value_or(500), 0) / 1e6;
+        const double maxRunningStart = std::max(getSetting("running_start_max_us").value_or(6000), 0) / 1e6;
+        {
+            std::unique_lock lock(m_frameMutex);
+            m_runningStart.configure(useAdaptiveRunningStart, minRunningStart, maxRunningStart);
+        }
 
         m_syncGpuWorkInEndFrame = getSetting("quirk_sync_gpu_work_in_end_frame").value_or(false);
 
         m_jiggleViewRotations = getSetting("jiggle_view_rotations").value_or(false);
 
+        m_useLateLatching = getSetting("late_latching").value_or(false);
+        m_lateLatchingEnvelope.maxAngle =
+            OVR::DegreeToRad((float)std::max(getSetting("late_latching_max_angle").value_or(15), 0));
+        m_lateLatchingEnvelope.maxDistance =
+            std::max(getSetting("late_latching_max_distance_mm").value_or(100), 0) / 1000.f;
+
+        m_bodyStateMaxExtrapolation = std::max(getSetting("body_state_max_extrapolation_ms").value_or(10), 0) / 1000.0;
+        m_bodyStateStaleTimeout = std::max(getSetting("body_state_stale_timeout_ms").value_or(0), 0) / 1000.0;
+
+        AccessibilityRemappingSettings accessibility;
+        accessibility.mirrorFromSide =
+            std::clamp(getApplicationSetting("accessibility_mirror_side").value_or(0), 0, 2) - 1;
+        accessibility.deriveOffHandPose = getApplicationSetting("accessibility_derive_off_hand_pose").value_or(false);
+        accessibility.toggleButtons = getApplicationSetting("accessibility_toggle_buttons").value_or(0);
+        accessibility.toggleHandTrigger[xr::Side::Left] =
+            getApplicationSetting("accessibility_toggle_left_grip").value_or(false);
+        accessibility.toggleHandTrigger[xr::Side::Right] =
+            getApplicationSetting("accessibility_toggle_right_grip").value_or(false);
+        for (uint32_t i = 0; i < AccessibilityRemappingSettings::MaxChords; i++) {
+            const std::string prefix = fmt::format("accessibility_chord{}_", i + 1);
+            accessibility.chords[i].button = getApplicationSetting(prefix + "button").value_or(0);
+            accessibility.chords[i].buttons = getApplicationSetting(prefix + "buttons").value_or(0);
+        }
+        {
+            std::unique_lock lock(m_actionsAndSpacesMutex);
+            m_accessibilityRemapping.configure(accessibility);
+        }
+
         TraceLoggingWrite(g_traceProvider,
                           "VDXR_Config",
                           TLArg(m_useMirrorWindow, "MirrorWindow"),
                           TLArg(m_useRunningStart, "UseRunningStart"),
+                          TLArg(useAdaptiveRunningStart, "AdaptiveRunningStart"),
+                          TLArg(minRunningStart, "MinRunningStart"),
+                          TLArg(maxRunningStart, "MaxRunningStart"),
                           TLArg(m_syncGpuWorkInEndFrame, "SyncGpuWorkInEndFrame"),
-                          TLArg(m_jiggleViewRotations, "JiggleViewRotations"));
+                          TLArg(m_jiggleViewRotations, "JiggleViewRotations"),
+                          TLArg(m_bodyStateMaxExtrapolation, "BodyStateMaxExtrapolation"),
+                          TLArg(m_bodyStateStaleTimeout, "BodyStateStaleTimeout"),
+                          TLArg(accessibility.isEnabled(), "AccessibilityRemapping"),
+                          TLArg(accessibility.mirrorFromSide, "AccessibilityMirrorFromSide"),
+                          TLArg(accessibility.deriveOffHandPose, "AccessibilityDeriveOffHandPose"),
+                          TLArg(accessibility.toggleButtons, "AccessibilityToggleButtons"));
     }
 
 } // namespace virtualdesktop_openxr
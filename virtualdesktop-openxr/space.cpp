@@ -379,7 +379,8 @@ namespace virtualdesktop_openxr {
                                                     XrTime time,
                                                     XrPosef& pose,
                                                     XrSpaceVelocity* velocity,
-                                                    XrEyeGazeSampleTimeEXT* gazeSampleTime) const {
+                                                    XrEyeGazeSampleTimeEXT* gazeSampleTime,
+                                                    std::optional<XrPosef>* controllerPose) const {
         XrPosef spaceToVirtual = Pose::Identity();
         XrSpaceVelocity spaceToVirtualVelocity{};
         XrPosef baseSpaceToVirtual = Pose::Identity();
@@ -388,8 +389,12 @@ namespace virtualdesktop_openxr {
         if (xrSpace.referenceType != xrBaseSpace.referenceType ||
             (xrSpace.referenceType == XR_REFERENCE_SPACE_TYPE_MAX_ENUM && xrSpace.action != xrBaseSpace.action &&
              xrSpace.subActionPath != xrBaseSpace.subActionPath)) {
-            flags1 = locateSpaceToOrigin(
-                xrSpace, time, spaceToVirtual, velocity ? &spaceToVirtualVelocity : nullptr, gazeSampleTime);
+            flags1 = locateSpaceToOrigin(xrSpace,
+                                         time,
+                                         spaceToVirtual,
+                                         velocity ? &spaceToVirtualVelocity : nullptr,
+                                         gazeSampleTime,
+                                         controllerPose);
             flags2 = locateSpaceToOrigin(xrBaseSpace,
                                          time,
                                          baseSpaceToVirtual,
@@ -425,16 +430,11 @@ namespace virtualdesktop_openxr {
         // Combine the poses.
         pose = Pose::Multiply(spaceToVirtual, Pose::Invert(baseSpaceToVirtual));
         if (velocity) {
-            velocity->velocityFlags = spaceToVirtualVelocity.velocityFlags & baseSpaceToVirtualVelocity.velocityFlags;
-            if (velocity->velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
-                velocity->angularVelocity =
-                    spaceToVirtualVelocity.angularVelocity - baseSpaceToVirtualVelocity.angularVelocity;
-            }
-            if (velocity->velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
-                // TODO: Does not account for centripetral forces.
-                velocity->linearVelocity =
-                    spaceToVirtualVelocity.linearVelocity - baseSpaceToVirtualVelocity.linearVelocity;
-            }
+            const XrSpaceVelocity relativeVelocity = Velocity::Relative(
+                spaceToVirtual, spaceToVirtualVelocity, baseSpaceToVirtual, baseSpaceToVirtualVelocity);
+            velocity->velocityFlags = relativeVelocity.velocityFlags;
+            velocity->angularVelocity = relativeVelocity.angularVelocity;
+            velocity->linearVelocity = relativeVelocity.linearVelocity;
         }
 
         return locationFlags;
@@ -444,7 +444,8 @@ namespace virtualdesktop_openxr {
                                                             XrTime time,
                                                             XrPosef& pose,
                                                             XrSpaceVelocity* velocity,
-                                                            XrEyeGazeSampleTimeEXT* gazeSampleTime) const {
+                                                            XrEyeGazeSampleTimeEXT* gazeSampleTime,
+                                                            std::optional<XrPosef>* controllerPose) const {
         XrSpaceLocationFlags result = 0;
 
         if (velocity) {
@@ -534,16 +535,31 @@ namespace virtualdesktop_openxr {
                     const int side = getActionSide(fullPath);
                     if ((isGripPose || isAimPose || isPalmPose) && side >= 0) {
                         result = getControllerPose(side, time, pose, velocity);
+                        if (controllerPose && Pose::IsPoseTracked(result) && !m_isControllerEmulated[side]) {
+                            *controllerPose = pose;
+                        }
 
                         // Apply the pose offsets.
                         if (isAimPose) {
                             // Try using the hand tracking first.
                             if (!getPinchPose(side, pose, pose)) {
+                                if (velocity) {
+                                    Velocity::ApplyOffset(pose, m_controllerAimPose[side], *velocity);
+                                }
                                 pose = Pose::Multiply(m_controllerAimPose[side], pose);
+                            } else if (controllerPose) {
+                                // The pose does not come from the controller.
+                                controllerPose->reset();
                             }
                         } else if (isGripPose) {
+                            if (velocity) {
+                                Velocity::ApplyOffset(pose, m_controllerGripPose[side], *velocity);
+                            }
                             pose = Pose::Multiply(m_controllerGripPose[side], pose);
                         } else {
+                            if (velocity) {
+                                Velocity::ApplyOffset(pose, m_controllerPalmPose[side], *velocity);
+                            }
                             pose = Pose::Multiply(m_controllerPalmPose[side], pose);
                         }
 
@@ -555,6 +571,9 @@ namespace virtualdesktop_openxr {
         }
 
         // Apply the offset transform.
+        if (velocity) {
+            Velocity::ApplyOffset(pose, xrSpace.poseInSpace, *velocity);
+        }
         pose = Pose::Multiply(xrSpace.poseInSpace, pose);
 
         return result;
@@ -606,6 +625,10 @@ namespace virtualdesktop_openxr {
 
     XrSpaceLocationFlags
     OpenXrRuntime::getControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const {
+        if (m_isControllerEmulated[side]) {
+            return getMirroredControllerPose(side, time, pose, velocity);
+        }
+
         XrSpaceLocationFlags locationFlags = 0;
         ovrPoseStatef state{};
         ovrTrackedDeviceType controller = side == 0 ? ovrTrackedDevice_LTouch : ovrTrackedDevice_RTouch;
@@ -644,6 +667,74 @@ namespace virtualdesktop_openxr {
         return locationFlags;
     }
 
+    // Derive the pose of an emulated controller from the other controller, mirrored across the headset.
+    XrSpaceLocationFlags
+    OpenXrRuntime::getMirroredControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const {
+        if (velocity) {
+            velocity->velocityFlags = 0;
+        }
+
+        XrPosef otherPose;
+        XrPosef headPose;
+        const XrSpaceLocationFlags locationFlags = getControllerPose(side ^ 1, time, otherPose, nullptr);
+        if (!Pose::IsPoseValid(locationFlags) || !Pose::IsPoseValid(getHmdPose(time, headPose, nullptr))) {
+            pose = Pose::Identity();
+            return 0;
+        }
+
+        // Mirror pose along the X axis of the headset.
+        // https://stackoverflow.com/a/33999726/15056285
+        XrPosef poseInHead = Pose::Multiply(otherPose, Pose::Invert(headPose));
+        poseInHead.position.x = -poseInHead.position.x;
+        poseInHead.orientation.y = -poseInHead.orientation.y;
+        poseInHead.orientation.z = -poseInHead.orientation.z;
+        pose = Pose::Multiply(poseInHead, headPose);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "MirroredControllerPose",
+                          TLArg(side == 0 ? "Left" : "Right", "Side"),
+                          TLArg(xr::ToString(pose).c_str(), "Pose"));
+
+        return locationFlags & (XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT);
+    }
+
+    // Identify the motion controller whose pose drives an action space, so that layers placed in that space can be
+    // late-latched. Returns -1 for any other space, or when the pose does not come straight from the controller (eg:
+    // emulated controller or aim pose from hand tracking). Must be called with m_actionsAndSpacesMutex held.
+    int OpenXrRuntime::getLateLatchingController(const Space& xrSpace) const {
+        if (xrSpace.action == XR_NULL_HANDLE) {
+            return -1;
+        }
+
+        // Pick the same source as locateSpaceToOrigin().
+        const Action& xrAction = *(Action*)xrSpace.action;
+        const std::string& subActionPath = getXrPath(xrSpace.subActionPath);
+        for (const auto& source : xrAction.actionSources) {
+            if (!startsWith(source.first, subActionPath)) {
+                continue;
+            }
+
+            const std::string& fullPath = source.first;
+            if (isActionEyeTracker(fullPath) || getTrackerIndex(fullPath) >= 0) {
+                return -1;
+            }
+
+            const bool isGripPose = endsWith(fullPath, "/input/grip/pose") || endsWith(fullPath, "/input/grip");
+            const bool isAimPose = endsWith(fullPath, "/input/aim/pose") || endsWith(fullPath, "/input/aim");
+            const bool isPalmPose = endsWith(fullPath, "/input/palm_ext/pose") || endsWith(fullPath, "/input/palm_ext");
+            const int side = getActionSide(fullPath);
+            if ((isGripPose || isAimPose || isPalmPose) && side >= 0) {
+                XrPosef pinchPose;
+                if (m_isControllerEmulated[side] || (isAimPose && getPinchPose(side, Pose::Identity(), pinchPose))) {
+                    return -1;
+                }
+                return side;
+            }
+        }
+
+        return -1;
+    }
+
     XrSpaceLocationFlags OpenXrRuntime::getEyeTrackerPose(XrTime time,
                                                           XrPosef& pose,
                                                           XrEyeGazeSampleTimeEXT* sampleTime) const {
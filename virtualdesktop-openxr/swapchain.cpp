@@ -373,6 +373,7 @@ namespace virtualdesktop_openxr {
         CHECK_OVRCMD(ovr_GetTextureSwapChainLength(m_ovrSession, ovrSwapchain, &xrSwapchain.ovrSwapchainLength));
         xrSwapchain.slices.push_back({});
         xrSwapchain.lastProcessedIndex.push_back(-1);
+        xrSwapchain.commits.addSlice();
         xrSwapchain.imagesResourceView.push_back({});
         xrSwapchain.renderTargetView.push_back({});
         xrSwapchain.ovrDesc = desc;
@@ -384,6 +385,7 @@ namespace virtualdesktop_openxr {
             xrSwapchain.ovrSwapchain.push_back(nullptr);
             xrSwapchain.slices.push_back({});
             xrSwapchain.lastProcessedIndex.push_back(-1);
+            xrSwapchain.commits.addSlice();
             xrSwapchain.imagesResourceView.push_back({});
             xrSwapchain.renderTargetView.push_back({});
         }
@@ -0,0 +1,132 @@
+// MIT License
+//
+// Copyright(c) 2022-2024 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "pch.h"
+
+#include "BodyState.h"
+
+namespace virtualdesktop_openxr::utils {
+
+    // Animated hands, eyes and face, for testing the body tracking pipeline without a headset. This is shared between
+    // the runtime's synthetic source and the standalone BodyStateProducer tool.
+    class SyntheticBodyState {
+      public:
+        // Produce the state at the given time (in seconds, any time base).
+        static void animate(BodyTracking::BodyStateV2& state, double time) {
+            const float t = (float)time;
+            const float TwoPi = 2.f * (float)M_PI;
+
+            state.FaceIsValid = 1;
+            state.IsEyeFollowingBlendshapesValid = 0;
+            for (uint32_t i = 0; i < BodyTracking::ExpressionCount; i++) {
+                state.ExpressionWeights[i] = 0.5f + 0.5f * std::sin(TwoPi * 0.3f * t + i * 0.7f);
+            }
+            for (uint32_t i = 0; i < BodyTracking::ConfidenceCount; i++) {
+                state.ExpressionConfidences[i] = 1.f;
+            }
+
+            // Look around slowly.
+            const BodyTracking::Quaternion gaze =
+                rotation(0.3f * std::sin(TwoPi * 0.2f * t), 0.15f * std::sin(TwoPi * 0.13f * t));
+            state.LeftEyeIsValid = state.RightEyeIsValid = 1;
+            state.LeftEyePose = {gaze, {-0.032f, 0.f, 0.f}};
+            state.RightEyePose = {gaze, {0.032f, 0.f, 0.f}};
+            state.LeftEyeConfidence = state.RightEyeConfidence = 1.f;
+
+            // Open and close the hands in front of the user.
+            state.LeftHandActive = state.RightHandActive = 1;
+            const float bob = 0.05f * std::sin(TwoPi * 0.25f * t);
+            animateHand(state.LeftHandJointStates,
+                        state.LeftAimState,
+                        {-0.2f, 1.1f + bob, -0.3f},
+                        -1.f,
+                        0.25f + 0.25f * std::sin(TwoPi * 0.5f * t));
+            animateHand(state.RightHandJointStates,
+                        state.RightAimState,
+                        {0.2f, 1.1f - bob, -0.3f},
+                        1.f,
+                        0.25f + 0.25f * std::sin(TwoPi * 0.5f * t + (float)M_PI));
+        }
+
+      private:
+        static BodyTracking::Quaternion rotation(float yaw, float pitch) {
+            const float cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+            const float cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+            return {cy * sp, sy * cp, -sy * sp, cy * cp};
+        }
+
+        // Lay out a hand with the palm facing down and all fingers curled by the same amount.
+        static void animateHand(BodyTracking::FingerJointState* joints,
+                                BodyTracking::HandTrackingAimState& aimState,
+                                const BodyTracking::Vector3& wristPosition,
+                                float mirror,
+                                float curl) {
+            // Offset of the metacarpal from the wrist, then length of each bone.
+            struct Finger {
+                uint32_t firstJoint;
+                uint32_t jointCount;
+                float offset;
+                float lengths[4];
+            };
+            static constexpr Finger Fingers[] = {
+                {XR_HAND_JOINT_THUMB_METACARPAL_EXT, 4, -0.025f, {0.035f, 0.03f, 0.025f}},
+                {XR_HAND_JOINT_INDEX_METACARPAL_EXT, 5, -0.015f, {0.065f, 0.04f, 0.025f, 0.02f}},
+                {XR_HAND_JOINT_MIDDLE_METACARPAL_EXT, 5, 0.f, {0.065f, 0.045f, 0.03f, 0.02f}},
+                {XR_HAND_JOINT_RING_METACARPAL_EXT, 5, 0.015f, {0.06f, 0.04f, 0.028f, 0.02f}},
+                {XR_HAND_JOINT_LITTLE_METACARPAL_EXT, 5, 0.03f, {0.055f, 0.032f, 0.02f, 0.018f}},
+            };
+
+            joints[XR_HAND_JOINT_WRIST_EXT] = {{rotation(0, 0), wristPosition}, 0.02f, {}, {}};
+            joints[XR_HAND_JOINT_PALM_EXT] = {
+                {rotation(0, 0), {wristPosition.x, wristPosition.y, wristPosition.z - 0.05f}}, 0.02f, {}, {}};
+
+            for (const auto& finger : Fingers) {
+                BodyTracking::Vector3 position{
+                    wristPosition.x + finger.offset * mirror, wristPosition.y, wristPosition.z - 0.01f};
+                float pitch = 0;
+                for (uint32_t i = 0; i < finger.jointCount; i++) {
+                    joints[finger.firstJoint + i] = {{rotation(0, pitch), position}, 0.008f, {}, {}};
+                    if (i + 1 < finger.jointCount) {
+                        // Only the phalanges curl.
+                        if (i > 0) {
+                            pitch -= curl;
+                        }
+                        position.y += std::sin(pitch) * finger.lengths[i];
+                        position.z -= std::cos(pitch) * finger.lengths[i];
+                    }
+                }
+            }
+
+            aimState.AimStatus = XR_HAND_TRACKING_AIM_COMPUTED_BIT_FB | XR_HAND_TRACKING_AIM_VALID_BIT_FB;
+            aimState.AimPose = joints[XR_HAND_JOINT_INDEX_PROXIMAL_EXT].Pose;
+            aimState.PinchStrengthIndex = aimState.PinchStrengthMiddle = aimState.PinchStrengthRing =
+                aimState.PinchStrengthLittle = std::clamp(curl / 0.5f, 0.f, 1.f);
+            if (aimState.PinchStrengthIndex >= 1.f) {
+                aimState.AimStatus |= XR_HAND_TRACKING_AIM_INDEX_PINCHING_BIT_FB;
+            }
+        }
+    };
+
+} // namespace virtualdesktop_openxr::utils
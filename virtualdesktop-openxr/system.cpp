@@ -492,25 +492,32 @@ namespace virtualdesktop_openxr {
 
             // Try initializing the body and eye tracking data through Virtual Desktop.
             if (!m_useOculusRuntime) {
-                initializeBodyTrackingMmf();
+                initializeBodyStateSource();
             }
+            const bool isBodyStateLive = m_bodyStateSource && m_bodyStateSource->isLive();
 
             // We must latch the body tracking capabilities now, as they are not allowed to change later during the
             // lifetime of the system.
             m_eyeTrackingType = EyeTracking::None;
             if (!getSetting("simulate_eye_tracking").value_or(false)) {
-                if (m_bodyState && ovr_GetBool(m_ovrSession, "SupportsEyeTracking", false)) {
+                if (m_bodyStateSource &&
+                    (!isBodyStateLive || ovr_GetBool(m_ovrSession, "SupportsEyeTracking", false))) {
                     m_eyeTrackingType = EyeTracking::Mmf;
                 }
             } else {
                 m_eyeTrackingType = EyeTracking::Simulated;
             }
 
-            if (m_bodyState) {
-                m_supportsHandTracking = ovr_GetBool(m_ovrSession, "SupportsHandTracking", false);
-                m_supportsFaceTracking = ovr_GetBool(m_ovrSession, "SupportsFaceTracking", false);
-                m_supportsBodyTracking = ovr_GetBool(m_ovrSession, "SupportsBodyTracking", false);
-                m_supportsFullBodyTracking = ovr_GetBool(m_ovrSession, "SupportsFullBodyTracking", false);
+            if (m_bodyStateSource) {
+                // A recording or a synthetic source may contain any kind of data.
+                m_supportsHandTracking =
+                    !isBodyStateLive || ovr_GetBool(m_ovrSession, "SupportsHandTracking", false);
+                m_supportsFaceTracking =
+                    !isBodyStateLive || ovr_GetBool(m_ovrSession, "SupportsFaceTracking", false);
+                m_supportsBodyTracking =
+                    !isBodyStateLive || ovr_GetBool(m_ovrSession, "SupportsBodyTracking", false);
+                m_supportsFullBodyTracking =
+                    !isBodyStateLive || ovr_GetBool(m_ovrSession, "SupportsFullBodyTracking", false);
                 m_emulateViveTrackers = ovr_GetBool(m_ovrSession, "EmulateTrackers", false);
                 m_emulateIndexControllers = ovr_GetBool(m_ovrSession, "EmulateIndexControllers", false);
             } else {
@@ -520,7 +527,8 @@ namespace virtualdesktop_openxr {
 
             TraceLoggingWrite(g_traceProvider,
                               "OVR_ExtendedSupport",
-                              TLArg(!!m_bodyState, "HasBodyState"),
+                              TLArg(!!m_bodyStateSource, "HasBodyState"),
+                              TLArg(isBodyStateLive, "IsBodyStateLive"),
                               TLArg((int)m_eyeTrackingType, "EyeTrackingType"),
                               TLArg(m_supportsHandTracking, "SupportsHandTracking"),
                               TLArg(m_supportsFaceTracking, "SupportsFaceTracking"),
@@ -558,20 +566,41 @@ namespace virtualdesktop_openxr {
             m_ovrSession, !m_useOculusRuntime ? ovrTrackingOrigin_FloorLevel : ovrTrackingOrigin_EyeLevel));
     }
 
-    void OpenXrRuntime::initializeBodyTrackingMmf() {
-        *m_bodyStateFile.put() = OpenFileMapping(FILE_MAP_READ, false, L"VirtualDesktop.BodyState");
-        if (!m_bodyStateFile) {
+    void OpenXrRuntime::initializeBodyStateSource() {
+        // Replace the live data with a recording or synthetic data when requested.
+        if (getSetting("replay_body_state").value_or(false)) {
+            const auto path = programData / L"BodyState.vdbs";
+            m_bodyStateSource = ReplayBodyStateSource::open(
+                path, std::max(getSetting("body_state_replay_speed").value_or(100), 1) / 100.0);
+            if (m_bodyStateSource) {
+                Log("Replaying body state from %ls\n", path.wstring().c_str());
+                return;
+            }
+            ErrorLog("Failed to open body state recording %ls\n", path.wstring().c_str());
+        } else if (getSetting("synthetic_body_state").value_or(false)) {
+            Log("Using synthetic body state\n");
+            m_bodyStateSource = std::make_unique<SyntheticBodyStateSource>(
+                std::max(getSetting("synthetic_body_state_rate").value_or(90), 1));
+            return;
+        }
+
+        m_bodyStateSource.reset();
+
+        wil::unique_handle file(OpenFileMapping(FILE_MAP_READ, false, L"VirtualDesktop.BodyState"));
+        if (!file) {
             TraceLoggingWrite(g_traceProvider, "VirtualDesktopBodyTracker_NotAvailable");
             return;
         }
 
-        m_bodyState = reinterpret_cast<BodyTracking::BodyStateV2*>(
-            MapViewOfFile(m_bodyStateFile.get(), FILE_MAP_READ, 0, 0, sizeof(BodyTracking::BodyStateV2)));
-        if (!m_bodyState) {
+        const auto state = reinterpret_cast<const BodyTracking::BodyStateV2*>(
+            MapViewOfFile(file.get(), FILE_MAP_READ, 0, 0, sizeof(BodyTracking::BodyStateV2)));
+        if (!state) {
             TraceLoggingWrite(g_traceProvider, "VirtualDesktopBodyTracker_MappingError_BodyStateV2");
+            return;
         }
 
-        *m_bodyStateEvent.put() = OpenEvent(SYNCHRONIZE, false, L"VirtualDesktop.BodyStateEvent2");
+        wil::unique_handle event(OpenEvent(SYNCHRONIZE, false, L"VirtualDesktop.BodyStateEvent2"));
+        m_bodyStateSource = std::make_unique<MmfBodyStateSource>(std::move(file), state, std::move(event));
     }
 
     void OpenXrRuntime::bodyStateWatcherThread() {
@@ -581,30 +610,282 @@ namespace virtualdesktop_openxr {
         SetThreadPriority(GetCurrentThread(),
                           getSetting("body_state_watcher_priority").value_or(THREAD_PRIORITY_TIME_CRITICAL));
 
+        const auto policy = (BodyStateWatcherPolicy)getSetting("body_state_watcher_policy")
+                                .value_or((int)BodyStateWatcherPolicy::Adaptive);
+        const auto maxRate = std::max(getSetting("body_state_watcher_max_rate").value_or(120), 1);
+        // The producer does not reset the event immediately. We must not wait on it again right away.
+        const auto minGuardTime =
+            std::chrono::microseconds(std::max(getSetting("body_state_watcher_guard_us").value_or(1000), 0));
+        static constexpr auto MaxGuardTime = 5ms;
+
+        const auto toMicroseconds = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        };
+
+        // Optionally record all the updates from the headset, for offline analysis or replay.
+        BodyStateRecorder recorder;
+        if (m_bodyStateSource->isLive() && getSetting("record_body_state").value_or(false)) {
+            const auto path = programData / L"BodyState.vdbs";
+            if (recorder.open(path)) {
+                Log("Recording body state to %ls\n", path.wstring().c_str());
+            } else {
+                ErrorLog("Failed to create body state recording %ls\n", path.wstring().c_str());
+            }
+        }
+
+        // Optional smoothing of the poses. The cutoffs are in hundredths of Hz and beta in thousandths.
+        const auto getFilterParameters = [&](const std::string& prefix) {
+            return OneEuroFilterParameters{
+                std::max(getSetting(prefix + "_filter_min_cutoff").value_or(0), 0) / 100.f,
+                std::max(getSetting(prefix + "_filter_beta").value_or(5000), 0) / 1000.f,
+                std::max(getSetting(prefix + "_filter_derivative_cutoff").value_or(100), 1) / 100.f};
+        };
+        BodyStateFilter filter(getFilterParameters("hand"), getFilterParameters("body"), getFilterParameters("eye"));
+
+        // Optional prediction of the eye gaze. The velocities are in degrees per second and the cutoff in hundredths of
+        // Hz.
+        std::optional<GazePredictor> gazePredictor;
+        if (getSetting("eye_gaze_prediction").value_or(false)) {
+            gazePredictor.emplace(GazePredictionParameters{
+                (float)OVR::DegreeToRad((float)std::max(getSetting("eye_gaze_saccade_velocity").value_or(180), 1)),
+                (float)OVR::DegreeToRad((float)std::max(getSetting("eye_gaze_fixation_velocity").value_or(60), 1)),
+                std::max(getSetting("eye_gaze_fixation_cutoff").value_or(1000), 1) / 100.f,
+                std::max(getSetting("eye_gaze_max_prediction_ms").value_or(30), 0) / 1000.0});
+        }
+
+        // Fill in the hand joints velocities when the producer does not report them.
+        const bool estimateHandVelocities = getSetting("estimate_hand_velocities").value_or(true);
+        HandVelocityEstimator velocityEstimator;
+
+        // Filtering, velocity estimation and recording need a private copy of the producer's state.
+        const bool needProcessing = filter.isEnabled() || estimateHandVelocities;
+        std::unique_ptr<BodyTracking::BodyStateV2> rawState, previousRawState, filteredState;
+        if (needProcessing || recorder.isOpen()) {
+            rawState = std::make_unique<BodyTracking::BodyStateV2>();
+            previousRawState = std::make_unique<BodyTracking::BodyStateV2>();
+            filteredState = std::make_unique<BodyTracking::BodyStateV2>();
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "BodyStateWatcherThread_Config",
+                          TLArg((int)policy, "Policy"),
+                          TLArg(maxRate, "MaxRate"),
+                          TLArg(minGuardTime.count(), "MinGuardTimeUs"),
+                          TLArg(m_bodyStateSource->isSignaled(), "IsSignaled"),
+                          TLArg(filter.isEnabled(), "IsFiltered"),
+                          TLArg(estimateHandVelocities, "EstimateHandVelocities"),
+                          TLArg(recorder.isOpen(), "IsRecording"),
+                          TLArg(gazePredictor.has_value(), "IsGazePredicted"));
+
+        // Use a high resolution timer when available, since the guard time is often shorter than the scheduler
+        // quantum.
+        wil::unique_handle guardTimer(
+            CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+        const auto sleepUntil = [&](std::chrono::high_resolution_clock::time_point deadline) {
+            const auto duration = deadline - std::chrono::high_resolution_clock::now();
+            if (duration <= 0ns) {
+                return;
+            }
+            if (guardTimer) {
+                LARGE_INTEGER dueTime;
+                dueTime.QuadPart = -std::max(
+                    std::chrono::duration_cast<std::chrono::duration<LONGLONG, std::ratio<1, 10'000'000>>>(duration)
+                        .count(),
+                    1LL);
+                if (SetWaitableTimer(guardTimer.get(), &dueTime, 0, nullptr, nullptr, false)) {
+                    WaitForSingleObject(guardTimer.get(), INFINITE);
+                    return;
+                }
+            }
+            std::this_thread::sleep_for(duration);
+        };
+
+        std::chrono::high_resolution_clock::time_point lastWakeTime{};
+        std::chrono::high_resolution_clock::time_point guardStartTime{};
+        std::chrono::duration<double> producerPeriod{0};
+        uint64_t updateCount = 0;
+        uint64_t delayedUpdateCount = 0;
+        uint64_t unchangedUpdateCount = 0;
+        std::chrono::high_resolution_clock::duration totalPublishTime{0};
+        std::chrono::duration<double> totalLatency{0};
+        std::chrono::duration<double> maxLatency{0};
+
         while (true) {
             // Wait for the next update.
+            bool signaled;
+            std::chrono::high_resolution_clock::time_point wakeTime;
             {
                 TraceLocalActivity(wait);
                 TraceLoggingWriteStart(wait, "BodyStateWatcherThread_Wait");
-                const auto status = WaitForSingleObject(m_bodyStateEvent.get(), 100 /* ms */);
-                TraceLoggingWriteStop(wait, "BodyStateWatcherThread_Wait", TLArg(status, "Status"));
+                const auto waitStartTime = std::chrono::high_resolution_clock::now();
+                signaled = m_bodyStateSource->waitForUpdate(100ms);
+                wakeTime = std::chrono::high_resolution_clock::now();
+                TraceLoggingWriteStop(wait,
+                                      "BodyStateWatcherThread_Wait",
+                                      TLArg(signaled, "Signaled"),
+                                      TLArg(toMicroseconds(wakeTime - waitStartTime), "WaitTimeUs"));
+
+                // If the event was already signaled when we started waiting, the update may have been sitting there
+                // for as long as we were in the guard time. This is the worst-case latency we added.
+                const bool wasDelayed = signaled && wakeTime - waitStartTime < 50us &&
+                                        guardStartTime.time_since_epoch().count();
+                if (wasDelayed) {
+                    const std::chrono::duration<double> latency = wakeTime - guardStartTime;
+                    totalLatency += latency;
+                    maxLatency = std::max(maxLatency, latency);
+                    delayedUpdateCount++;
+                }
             }
 
             if (m_terminateBodyStateThread) {
                 break;
             }
 
-            // Cache the new state.
+            // Publish the new state. Readers are never blocked by this copy. Nothing is published when the producer
+            // signaled without changing anything.
             {
-                std::unique_lock lock(m_bodyStateMutex);
-                m_cachedBodyState = *m_bodyState;
+                TraceLocalActivity(publish);
+                TraceLoggingWriteStart(publish, "BodyStateWatcherThread_Publish");
+                const double updateTime = m_bodyStateSource->getUpdateTime();
+                const BodyTracking::BodyStateV2* state = &m_bodyStateSource->getState();
+
+                std::chrono::high_resolution_clock::duration filterTime{0};
+                if (rawState) {
+                    std::swap(rawState, previousRawState);
+                    *rawState = *state;
+                    state = rawState.get();
+
+                    if (recorder.isOpen()) {
+                        recorder.record(*rawState, updateTime);
+                    }
+
+                    // Only advance the filters and the estimators upon new data from the producer.
+                    if (needProcessing) {
+                        if (GetChangedBodyStateSections(*rawState, *previousRawState)) {
+                            const auto filterStartTime = std::chrono::high_resolution_clock::now();
+                            *filteredState = *rawState;
+                            if (filter.isEnabled()) {
+                                filter.apply(*filteredState, updateTime);
+                            }
+                            if (estimateHandVelocities) {
+                                velocityEstimator.apply(*filteredState, updateTime);
+                            }
+                            filterTime = std::chrono::high_resolution_clock::now() - filterStartTime;
+                        } else if (estimateHandVelocities) {
+                            // The producer may have stalled, in which case the last estimates must not be published
+                            // forever.
+                            velocityEstimator.expire(*filteredState, ovr_GetTimeInSeconds());
+                        }
+                        state = filteredState.get();
+                    }
+                }
+
+                const auto publishStartTime = std::chrono::high_resolution_clock::now();
+                const uint32_t changedSections = m_bodyStateBuffer.publish(*state, updateTime);
+                const auto publishTime = std::chrono::high_resolution_clock::now() - publishStartTime;
+                if (!changedSections) {
+                    unchangedUpdateCount++;
+                }
+                totalPublishTime += publishTime;
+                TraceLoggingWriteStop(publish,
+                                      "BodyStateWatcherThread_Publish",
+                                      TLArg(changedSections, "ChangedSections"),
+                                      TLArg(std::chrono::duration<double, std::micro>(filterTime).count(),
+                                            "FilterTimeUs"),
+                                      TLArg(std::chrono::duration<double, std::micro>(publishTime).count(),
+                                            "PublishTimeUs"),
+                                      TLArg(m_bodyStateBuffer.generation(), "Generation"),
+                                      TLArg(m_bodyStateBuffer.readRetries(), "ReadRetries"));
+
+                // Advance the gaze prediction upon new eye data.
+                if (gazePredictor && (changedSections & (1u << (uint32_t)BodyStateSection::Eyes))) {
+                    if (state->LeftEyeIsValid && state->RightEyeIsValid && state->LeftEyeConfidence > 0.5f &&
+                        state->RightEyeConfidence > 0.5f) {
+                        gazePredictor->update(updateTime,
+                                              GetGazeDirection(state->LeftEyePose, state->RightEyePose),
+                                              std::min(state->LeftEyeConfidence, state->RightEyeConfidence));
+                    } else {
+                        gazePredictor->reset();
+                    }
+
+                    std::unique_lock lock(m_gazeModelMutex);
+                    m_gazeModel = gazePredictor->getModel();
+                }
+            }
+            updateCount++;
+
+            // Estimate the update period of the producer.
+            if (signaled && lastWakeTime.time_since_epoch().count()) {
+                const std::chrono::duration<double> interval = wakeTime - lastWakeTime;
+                if (interval < 100ms) {
+                    producerPeriod = producerPeriod.count() ? producerPeriod * 0.9 + interval * 0.1 : interval;
+                }
             }
+            lastWakeTime = wakeTime;
 
-            // Avoid spurious wakeup when the event was not reset quickly-enough.
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            // Decide how long to hold off before waiting for the next update.
+            std::chrono::duration<double> guardTime = minGuardTime;
+            switch (policy) {
+            case BodyStateWatcherPolicy::RateLimited:
+                guardTime = std::max(guardTime, std::chrono::duration<double>(1.0 / maxRate));
+                break;
+            case BodyStateWatcherPolicy::Adaptive:
+                // Half the producer period leaves plenty of margin for jitter, while the next update is never
+                // delayed.
+                if (producerPeriod.count()) {
+                    guardTime = std::clamp(producerPeriod * 0.5,
+                                           std::chrono::duration<double>(minGuardTime),
+                                           std::chrono::duration<double>(MaxGuardTime));
+                } else {
+                    guardTime = MaxGuardTime;
+                }
+                break;
+            default:
+                break;
+            }
+            if (!m_bodyStateSource->isSignaled()) {
+                // Without signaling, we are polling.
+                guardTime = std::max(guardTime, std::chrono::duration<double>(1.0 / maxRate));
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "BodyStateWatcherThread_Guard",
+                              TLArg(toMicroseconds(producerPeriod), "ProducerPeriodUs"),
+                              TLArg(toMicroseconds(guardTime), "GuardTimeUs"));
+
+            guardStartTime = std::chrono::high_resolution_clock::now();
+            sleepUntil(wakeTime + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(guardTime));
+        }
+
+        TraceLoggingWriteStop(local,
+                              "BodyStateWatcherThread",
+                              TLArg(updateCount, "UpdateCount"),
+                              TLArg(delayedUpdateCount, "DelayedUpdateCount"),
+                              TLArg(unchangedUpdateCount, "UnchangedUpdateCount"),
+                              TLArg(updateCount ? std::chrono::duration<double, std::micro>(totalPublishTime).count() /
+                                                      updateCount
+                                                : 0.0,
+                                    "AveragePublishTimeUs"),
+                              TLArg(updateCount ? toMicroseconds(totalLatency / updateCount) : 0,
+                                    "AverageAddedLatencyUs"),
+                              TLArg(toMicroseconds(maxLatency), "MaxAddedLatencyUs"),
+                              TLArg(recorder.frameCount(), "RecordedFrameCount"));
+
+        if (gazePredictor && gazePredictor->getScoredSampleCount()) {
+            Log("Gaze prediction error over %llu samples (%llu in saccades): mean %.3f deg (%.3f deg without "
+                "prediction), max %.3f deg\n",
+                gazePredictor->getScoredSampleCount(),
+                gazePredictor->getSaccadeSampleCount(),
+                OVR::RadToDegree(gazePredictor->getMeanPredictionError()),
+                OVR::RadToDegree(gazePredictor->getMeanHoldError()),
+                OVR::RadToDegree(gazePredictor->getMaxPredictionError()));
         }
+    }
 
-        TraceLoggingWriteStop(local, "BodyStateWatcherThread");
+    bool OpenXrRuntime::isBodyStateStale(BodyStateSection section) const {
+        // A section that keeps the exact same content is no longer being tracked by the producer.
+        return m_bodyStateStaleTimeout > 0 &&
+               ovr_GetTimeInSeconds() - m_bodyStateBuffer.lastUpdateTime(section) > m_bodyStateStaleTimeout;
     }
 
 } // namespace virtualdesktop_openxr
@@ -128,6 +128,76 @@ namespace xr {
 
         } // namespace Pose
 
+        namespace Velocity {
+
+            // Velocity of a point rigidly attached to a body, where the point is at the given offset in the body's
+            // frame. The angular velocity is shared by the whole body, the linear velocity gains the tangential term
+            // (w x r). All velocities are expressed in the same frame as the body's pose.
+            static inline void ApplyOffset(const XrPosef& bodyPose, const XrPosef& offset, XrSpaceVelocity& velocity) {
+                if (!(velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT)) {
+                    return;
+                }
+
+                if (!(velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)) {
+                    // We cannot compute the tangential velocity for a point away from the body's origin.
+                    if (Length(offset.position) > FLT_EPSILON) {
+                        velocity.velocityFlags &= ~XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+                    }
+                    return;
+                }
+
+                const DirectX::XMVECTOR leverArm =
+                    DirectX::XMVector3Rotate(LoadXrVector3(offset.position), LoadXrQuaternion(bodyPose.orientation));
+                StoreXrVector3(&velocity.linearVelocity,
+                               DirectX::XMVectorAdd(
+                                   LoadXrVector3(velocity.linearVelocity),
+                                   DirectX::XMVector3Cross(LoadXrVector3(velocity.angularVelocity), leverArm)));
+            }
+
+            // Velocity of a body relative to a moving base, expressed in the base's frame. The poses and velocities of
+            // both the body and the base must be expressed in a common frame. This is the velocity counterpart of
+            // Pose::Multiply(pose, Pose::Invert(basePose)).
+            static inline XrSpaceVelocity Relative(const XrPosef& pose,
+                                                   const XrSpaceVelocity& velocity,
+                                                   const XrPosef& basePose,
+                                                   const XrSpaceVelocity& baseVelocity) {
+                XrSpaceVelocity result{XR_TYPE_SPACE_VELOCITY};
+
+                const DirectX::XMVECTOR baseOrientationInverse =
+                    DirectX::XMQuaternionInverse(LoadXrQuaternion(basePose.orientation));
+                const DirectX::XMVECTOR baseAngularVelocity = LoadXrVector3(baseVelocity.angularVelocity);
+
+                if ((velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) &&
+                    (baseVelocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)) {
+                    StoreXrVector3(&result.angularVelocity,
+                                   DirectX::XMVector3Rotate(
+                                       DirectX::XMVectorSubtract(LoadXrVector3(velocity.angularVelocity),
+                                                                 baseAngularVelocity),
+                                       baseOrientationInverse));
+                    result.velocityFlags |= XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+                }
+
+                // The rotation of the base drags the body along: subtract the velocity of the base frame at the body's
+                // position (w_base x (p - p_base)).
+                if ((velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) &&
+                    (baseVelocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) &&
+                    (baseVelocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)) {
+                    const DirectX::XMVECTOR leverArm =
+                        DirectX::XMVectorSubtract(LoadXrVector3(pose.position), LoadXrVector3(basePose.position));
+                    const DirectX::XMVECTOR linearVelocity = DirectX::XMVectorSubtract(
+                        DirectX::XMVectorSubtract(LoadXrVector3(velocity.linearVelocity),
+                                                  LoadXrVector3(baseVelocity.linearVelocity)),
+                        DirectX::XMVector3Cross(baseAngularVelocity, leverArm));
+                    StoreXrVector3(&result.linearVelocity,
+                                   DirectX::XMVector3Rotate(linearVelocity, baseOrientationInverse));
+                    result.velocityFlags |= XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+                }
+
+                return result;
+            }
+
+        } // namespace Velocity
+
     } // namespace math
 
     namespace detail {